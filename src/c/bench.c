@@ -0,0 +1,862 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "state.h"
+#include "move.h"
+#include "move_generation.h"
+#include "search.h"
+#include "evaluate.h"
+#include "evaluate_simd.h"
+#include "mcts.h"
+
+/**
+ * Benchmark positions, written as comma separated moves from the start position in the same
+ * format as the command line game.
+ */
+static const char *bench_positions[] = {
+        "",
+        "P N, P S",
+        "P N, P S, HF 2 3, VF 5 4",
+        "P N, P S, HF 2 3, VF 5 4, HF 6 5, HF 1 1, P N, VF 1 3",
+        "P N, P S, P N, P S, VF 3 3, HF 4 4, VF 3 5, HF 3 6, P W, P S",
+        "HF 6 3, HF 1 4, P N, P S, VF 5 2, VF 2 5, P W, P E, HF 4 0, HF 3 7",
+};
+
+#define BENCH_POSITION_COUNT (int) (sizeof(bench_positions) / sizeof(bench_positions[0]))
+
+static double get_time_ms(void) {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (double) time.tv_sec * 1000.0 + (double) time.tv_nsec / 1e6;
+}
+
+/**
+ * @brief Plays the moves of a benchmark position from the start position, exiting if one of
+ * them is invalid.
+ */
+static struct State load_bench_position(const char *moves) {
+    struct State state = new_state();
+    const char *text = moves;
+
+    while (*text != '\0') {
+        struct Move move;
+        int consumed = parse_move(text, &move);
+
+        if (consumed == 0 || !move_is_fully_legal(&state, move)) {
+            fprintf(stderr, "Invalid move in bench position \"%s\" at \"%s\".\n", moves, text);
+            exit(EXIT_FAILURE);
+        }
+
+        make_move(&state, &move);
+        text += consumed;
+        text += strspn(text, ", ");
+    }
+
+    return state;
+}
+
+/**
+ * @brief Counts the leaf nodes of the tree of fully legal moves to the given depth.
+ *
+ * Won positions have no moves, so they are only counted as leaves at depth 0.
+ */
+static uint64_t perft(struct State *state, int depth) { // NOLINT(*-no-recursion)
+    if (depth == 0) {
+        return 1;
+    }
+
+    if (player_1_win_check(*state) || player_2_win_check(*state)) {
+        return 0;
+    }
+
+    const PawnMoves pawn_moves = generate_legal_pawn_moves(state);
+    FenceMoves vertical_fence_moves, horizontal_fence_moves;
+    generate_fully_legal_fence_moves(state, &vertical_fence_moves, &horizontal_fence_moves);
+
+    if (depth == 1) {
+        return __builtin_popcount(pawn_moves) + __builtin_popcountll(vertical_fence_moves) +
+               __builtin_popcountll(horizontal_fence_moves);
+    }
+
+    struct MoveList move_list;
+    uint64_t nodes = 0;
+
+    generate_move_list(pawn_moves, vertical_fence_moves, horizontal_fence_moves, &move_list);
+
+    const int player = state->player_to_move;
+    for (int i = 0; i < move_list.count; i++) {
+        struct Move move = decode_move(move_list.moves[i].move);
+        make_player_move(state, &move, player);
+        nodes += perft(state, depth - 1);
+        unmake_player_move(state, &move, player);
+    }
+
+    return nodes;
+}
+
+/**
+ * @brief Runs perft to `depth` from the start position and every benchmark position, or from the
+ * given positions if there are any.
+ */
+static void bench_perft(int depth, const char **positions, int position_count) {
+    uint64_t total_nodes = 0;
+    double total_time = 0;
+
+    printf("Perft, depth %d\n", depth);
+    printf("%8s %14s %12s %12s\n", "position", "nodes", "time (ms)", "nodes/s");
+
+    for (int i = 0; i < position_count; i++) {
+        struct State state = load_bench_position(positions[i]);
+
+        double start = get_time_ms();
+        uint64_t nodes = perft(&state, depth);
+        double time = get_time_ms() - start;
+
+        printf("%8d %14llu %12.1f %12.0f\n", i, (unsigned long long) nodes, time, (double) nodes / (time / 1000.0));
+        total_nodes += nodes;
+        total_time += time;
+    }
+
+    printf("%8s %14llu %12.1f %12.0f\n", "total", (unsigned long long) total_nodes, total_time,
+           (double) total_nodes / (total_time / 1000.0));
+}
+
+/**
+ * @brief Prints the perft node count below every legal move of a position.
+ */
+static void bench_divide(int depth, const char *position) {
+    struct State state = load_bench_position(position);
+    struct MoveList move_list;
+    FenceMoves vertical_fence_moves, horizontal_fence_moves;
+    uint64_t total_nodes = 0;
+
+    generate_fully_legal_fence_moves(&state, &vertical_fence_moves, &horizontal_fence_moves);
+    generate_move_list(generate_legal_pawn_moves(&state), vertical_fence_moves, horizontal_fence_moves, &move_list);
+
+    for (int i = 0; i < move_list.count; i++) {
+        struct Move move = decode_move(move_list.moves[i].move);
+        char move_text[8];
+
+        make_move(&state, &move);
+        uint64_t nodes = perft(&state, depth - 1);
+        unmake_move(&state, &move);
+
+        format_move(move, move_text, sizeof(move_text));
+        printf("%-8s %llu\n", move_text, (unsigned long long) nodes);
+        total_nodes += nodes;
+    }
+
+    printf("\nMoves: %d\nNodes: %llu\n", move_list.count, (unsigned long long) total_nodes);
+}
+
+/**
+ * @brief Runs a single threaded iterative deepening search of every benchmark position.
+ *
+ * The total node count is deterministic for a given engine, so it serves as a signature that
+ * changes whenever the search or move generation changes behaviour. The stack high-water mark is
+ * the most C stack used below the root of a search. With `verbose` the search statistics of every
+ * position are printed.
+ */
+static void bench_search(int depth, bool verbose) {
+    uint64_t total_nodes = 0;
+    uint64_t stack_high_water = 0;
+    double total_time = 0;
+
+    for (int i = 0; i < BENCH_POSITION_COUNT; i++) {
+        struct State state = load_bench_position(bench_positions[i]);
+
+        double start = get_time_ms();
+        struct SearchResult result = search_position(state, (struct SearchBudget) { .max_depth = depth },
+                                                     (struct SearchOptions) {
+                                                             .aspiration_window = DEFAULT_ASPIRATION_WINDOW
+                                                     });
+        double time = get_time_ms() - start;
+        char move_text[8];
+
+        format_move(result.best_move, move_text, sizeof(move_text));
+        printf("position %d: %-8s nodes %llu, %.1f ms, stack %llu bytes\n", i, move_text,
+               (unsigned long long) result.nodes, time, (unsigned long long) result.stats.stack_high_water);
+        if (verbose) {
+            print_search_stats(&result.stats);
+            printf("\n");
+        }
+        total_nodes += result.nodes;
+        total_time += time;
+        if (result.stats.stack_high_water > stack_high_water) {
+            stack_high_water = result.stats.stack_high_water;
+        }
+    }
+
+    printf("\n===========================\n");
+    printf("Depth          : %d\n", depth);
+    printf("Total time (ms): %.0f\n", total_time);
+    printf("Nodes searched : %llu\n", (unsigned long long) total_nodes);
+    printf("Nodes/second   : %.0f\n", (double) total_nodes / (total_time / 1000.0));
+    printf("Stack (bytes)  : %llu\n", (unsigned long long) stack_high_water);
+}
+
+/**
+ * @brief Searches every benchmark position with 1, 2, 4, ... up to `max_threads` threads and
+ * reports nodes, time to depth, nodes per second and the speedup over a single thread.
+ */
+static void bench_threads(int depth, int max_threads) {
+    double single_thread_time = 0;
+
+    printf("Lazy SMP scaling, depth %d, %d positions\n", depth, BENCH_POSITION_COUNT);
+    printf("%8s %14s %12s %12s %8s\n", "threads", "nodes", "time (ms)", "nodes/s", "speedup");
+
+    for (int threads = 1; threads <= max_threads; threads *= 2) {
+        uint64_t nodes = 0;
+        double time = 0;
+
+        for (int i = 0; i < BENCH_POSITION_COUNT; i++) {
+            struct State state = load_bench_position(bench_positions[i]);
+
+            double start = get_time_ms();
+            struct SearchResult result = get_best_move_lazy_smp(state, depth, threads);
+            time += get_time_ms() - start;
+            nodes += result.nodes;
+        }
+
+        if (threads == 1) {
+            single_thread_time = time;
+        }
+
+        printf("%8d %14llu %12.1f %12.0f %8.2f\n", threads, (unsigned long long) nodes, time,
+               (double) nodes / (time / 1000.0), single_thread_time / time);
+    }
+}
+
+/**
+ * @brief Searches every benchmark position single threaded and reports the node count and how
+ * often the first move searched caused a beta cutoff, a measure of the move ordering.
+ *
+ * Cutoffs are only counted in builds with `QUORIDOR_SEARCH_STATS`.
+ */
+static void bench_ordering(int depth) {
+    uint64_t total_nodes = 0, total_cutoffs = 0, total_first_move_cutoffs = 0;
+    double total_time = 0;
+
+    printf("Move ordering, depth %d\n", depth);
+    printf("%8s %14s %12s %14s %12s\n", "position", "nodes", "cutoffs", "first move %", "time (ms)");
+
+    for (int i = 0; i < BENCH_POSITION_COUNT; i++) {
+        struct State state = load_bench_position(bench_positions[i]);
+        double start = get_time_ms();
+        struct SearchResult result = get_best_move_lazy_smp(state, depth, 1);
+        double time = get_time_ms() - start;
+
+        const struct SearchDepthStats *stats = &result.stats.total;
+
+        printf("%8d %14llu %12llu %14.1f %12.1f\n", i, (unsigned long long) result.nodes,
+               (unsigned long long) stats->beta_cutoffs,
+               stats->beta_cutoffs > 0 ? 100.0 * (double) stats->first_move_beta_cutoffs / (double) stats->beta_cutoffs : 0,
+               time);
+
+        total_nodes += result.nodes;
+        total_cutoffs += stats->beta_cutoffs;
+        total_first_move_cutoffs += stats->first_move_beta_cutoffs;
+        total_time += time;
+    }
+
+    printf("%8s %14llu %12llu %14.1f %12.1f\n", "total", (unsigned long long) total_nodes,
+           (unsigned long long) total_cutoffs,
+           total_cutoffs > 0 ? 100.0 * (double) total_first_move_cutoffs / (double) total_cutoffs : 0, total_time);
+}
+
+/**
+ * @brief Searches every benchmark position with all fences and with only the relevant fences,
+ * reporting the nodes, time and whether both searches chose the same move.
+ */
+static void bench_relevant_fences(int depth) {
+    uint64_t total_nodes[2] = { 0 };
+    double total_time[2] = { 0 };
+    int same_moves = 0;
+
+    printf("Relevant fences, depth %d\n", depth);
+    printf("%8s %14s %12s %14s %12s %6s\n", "position", "all nodes", "time (ms)", "relevant nodes", "time (ms)",
+           "same");
+
+    for (int i = 0; i < BENCH_POSITION_COUNT; i++) {
+        struct State state = load_bench_position(bench_positions[i]);
+        struct SearchResult results[2];
+        double times[2];
+
+        for (int relevant = 0; relevant < 2; relevant++) {
+            double start = get_time_ms();
+            results[relevant] = search_position(state, (struct SearchBudget) { .max_depth = depth },
+                                                (struct SearchOptions) { .relevant_fences_only = relevant });
+            times[relevant] = get_time_ms() - start;
+            total_nodes[relevant] += results[relevant].nodes;
+            total_time[relevant] += times[relevant];
+        }
+
+        const bool same_move = encode_move(results[0].best_move) == encode_move(results[1].best_move);
+        same_moves += same_move;
+
+        printf("%8d %14llu %12.1f %14llu %12.1f %6s\n", i, (unsigned long long) results[0].nodes, times[0],
+               (unsigned long long) results[1].nodes, times[1], same_move ? "yes" : "no");
+    }
+
+    printf("%8s %14llu %12.1f %14llu %12.1f %3d/%d\n", "total", (unsigned long long) total_nodes[0], total_time[0],
+           (unsigned long long) total_nodes[1], total_time[1], same_moves, BENCH_POSITION_COUNT);
+}
+
+/**
+ * @brief Searches every benchmark position with a range of aspiration window widths, reporting
+ * the nodes, time, window failures and how many positions got the same move as with a full window.
+ */
+static void bench_aspiration(int depth) {
+    static const int windows[] = { 0, 2, 4, 8, 16 };
+    const int window_count = sizeof(windows) / sizeof(windows[0]);
+    EncodedMove full_window_moves[BENCH_POSITION_COUNT];
+
+    printf("Aspiration windows, depth %d, %d positions\n", depth, BENCH_POSITION_COUNT);
+    printf("%8s %14s %12s %10s %10s %6s\n", "window", "nodes", "time (ms)", "fail high", "fail low", "same");
+
+    for (int w = 0; w < window_count; w++) {
+        uint64_t nodes = 0, fail_highs = 0, fail_lows = 0;
+        double time = 0;
+        int same_moves = 0;
+
+        for (int i = 0; i < BENCH_POSITION_COUNT; i++) {
+            struct State state = load_bench_position(bench_positions[i]);
+
+            double start = get_time_ms();
+            struct SearchResult result = search_position(state, (struct SearchBudget) { .max_depth = depth },
+                                                         (struct SearchOptions) { .aspiration_window = windows[w] });
+            time += get_time_ms() - start;
+            nodes += result.nodes;
+            fail_highs += result.stats.total.aspiration_fail_highs;
+            fail_lows += result.stats.total.aspiration_fail_lows;
+
+            if (w == 0) {
+                full_window_moves[i] = encode_move(result.best_move);
+            }
+            same_moves += encode_move(result.best_move) == full_window_moves[i];
+        }
+
+        printf("%8d %14llu %12.1f %10llu %10llu %3d/%d\n", windows[w], (unsigned long long) nodes, time,
+               (unsigned long long) fail_highs, (unsigned long long) fail_lows, same_moves, BENCH_POSITION_COUNT);
+    }
+}
+
+/**
+ * @brief Searches every benchmark position without selective search, with each technique alone
+ * and with all of them, reporting the nodes, time and how many positions got the same move as
+ * without selective search.
+ */
+static void bench_selective(int depth) {
+    static const struct {
+        const char *name;
+        struct SearchOptions options;
+    } configurations[] = {
+            { "none", { .aspiration_window = DEFAULT_ASPIRATION_WINDOW } },
+            { "lmr", { .aspiration_window = DEFAULT_ASPIRATION_WINDOW, .late_move_reductions = true } },
+            { "null", { .aspiration_window = DEFAULT_ASPIRATION_WINDOW, .null_move_pruning = true } },
+            { "futility", { .aspiration_window = DEFAULT_ASPIRATION_WINDOW, .futility_pruning = true } },
+            { "all", { .aspiration_window = DEFAULT_ASPIRATION_WINDOW, .late_move_reductions = true,
+                       .null_move_pruning = true, .futility_pruning = true } },
+    };
+    const int configuration_count = sizeof(configurations) / sizeof(configurations[0]);
+    EncodedMove full_width_moves[BENCH_POSITION_COUNT];
+
+    printf("Selective search, depth %d, %d positions\n", depth, BENCH_POSITION_COUNT);
+    printf("%8s %14s %12s %6s\n", "pruning", "nodes", "time (ms)", "same");
+
+    for (int c = 0; c < configuration_count; c++) {
+        uint64_t nodes = 0;
+        double time = 0;
+        int same_moves = 0;
+
+        for (int i = 0; i < BENCH_POSITION_COUNT; i++) {
+            struct State state = load_bench_position(bench_positions[i]);
+
+            double start = get_time_ms();
+            struct SearchResult result = search_position(state, (struct SearchBudget) { .max_depth = depth },
+                                                         configurations[c].options);
+            time += get_time_ms() - start;
+            nodes += result.nodes;
+
+            if (c == 0) {
+                full_width_moves[i] = encode_move(result.best_move);
+            }
+            same_moves += encode_move(result.best_move) == full_width_moves[i];
+        }
+
+        printf("%8s %14llu %12.1f %3d/%d\n", configurations[c].name, (unsigned long long) nodes, time, same_moves,
+               BENCH_POSITION_COUNT);
+    }
+}
+
+/**
+ * @brief Appends every position reachable in `depth` pawn moves or pseudo-legal fence moves, so
+ * that positions where a fence leaves a player without a path are included.
+ */
+static void collect_positions(struct State *state, int depth, struct State *positions, int *count) { // NOLINT(*-no-recursion)
+    positions[(*count)++] = *state;
+
+    if (depth == 0 || player_1_win_check(*state) || player_2_win_check(*state)) {
+        return;
+    }
+
+    struct MoveList move_list;
+    generate_move_list(generate_legal_pawn_moves(state), generate_pseudo_legal_vertical_fence_moves(state),
+                       generate_pseudo_legal_horizontal_fence_moves(state), &move_list);
+
+    for (int i = 0; i < move_list.count; i++) {
+        struct Move move = decode_move(move_list.moves[i].move);
+        make_move(state, &move);
+        collect_positions(state, depth - 1, positions, count);
+        unmake_move(state, &move);
+    }
+}
+
+/**
+ * @brief Checks that the vectorized path length kernel gives the same scores as the scalar
+ * reference and the distance cache, and compares their speed.
+ *
+ * The positions are every position within two moves of the benchmark positions.
+ *
+ * @return The number of positions whose scores differ.
+ */
+static int bench_evaluate(int repetitions) {
+    const int max_positions = BENCH_POSITION_COUNT * (1 + MAX_MOVE_COUNT + MAX_MOVE_COUNT * MAX_MOVE_COUNT);
+    struct State *positions = malloc(max_positions * sizeof(struct State));
+    int position_count = 0, mismatches = 0, no_path_count = 0;
+
+    if (positions == NULL) {
+        exit(1);  // malloc failed, should probably log this somehow.
+    }
+
+    for (int i = 0; i < BENCH_POSITION_COUNT; i++) {
+        struct State state = load_bench_position(bench_positions[i]);
+        collect_positions(&state, 2, positions, &position_count);
+    }
+
+    for (int i = 0; i < position_count; i++) {
+        const struct State *state = &positions[i];
+        const int reference = optimal_path_dif_heuristic(state);
+        const bool game_over = player_1_win_check(*state) || player_2_win_check(*state);
+
+        // The distance cache gives a pawn on its goal row a distance of 0 rather than no path.
+        if (dual_path_dif_heuristic(state) != reference || (!game_over && evaluate(state) != reference)) {
+            mismatches++;
+        }
+        no_path_count += reference == NO_PATH_FOUND;
+    }
+
+    printf("Evaluation kernel (%s), %d positions, %d without a path\n", dual_path_instruction_set(),
+           position_count, no_path_count);
+    printf("%10s %12s %12s\n", "kernel", "time (ms)", "ns/position");
+
+    volatile int sink = 0;
+    double times[2];
+
+    for (int kernel = 0; kernel < 2; kernel++) {
+        double start = get_time_ms();
+        for (int r = 0; r < repetitions; r++) {
+            for (int i = 0; i < position_count; i++) {
+                sink += kernel == 0 ? optimal_path_dif_heuristic(&positions[i]) : dual_path_dif_heuristic(&positions[i]);
+            }
+        }
+        times[kernel] = get_time_ms() - start;
+        printf("%10s %12.1f %12.1f\n", kernel == 0 ? "scalar" : dual_path_instruction_set(), times[kernel],
+               times[kernel] * 1e6 / ((double) repetitions * position_count));
+    }
+
+    printf("\nSpeedup   : %.2f\n", times[0] / times[1]);
+    printf("Mismatches: %d\n", mismatches);
+
+    free(positions);
+    return mismatches;
+}
+
+// Games between the engines longer than this are drawn, pawns can move back and forth forever.
+#define ENGINE_GAME_MAX_PLIES 200
+
+/**
+ * @brief Plays games between the PVS and MCTS engines with the same time per move, to compare
+ * their strength at equal time.
+ *
+ * Games start from the benchmark positions in turn, each position is played twice with the
+ * engines swapping sides.
+ */
+static void bench_engines(uint32_t time_limit_ms, int game_count) {
+    const struct SearchBudget budget = { .time_limit_ms = time_limit_ms };
+    int mcts_wins = 0, pvs_wins = 0, draws = 0;
+    uint64_t pvs_depths = 0, pvs_moves = 0, mcts_playouts = 0, mcts_moves = 0;
+
+    printf("PVS against MCTS, %u ms per move\n", time_limit_ms);
+    printf("%6s %10s %8s %8s %8s\n", "game", "MCTS side", "plies", "winner", "time (s)");
+
+    for (int game = 0; game < game_count; game++) {
+        struct State state = load_bench_position(bench_positions[game / 2 % BENCH_POSITION_COUNT]);
+        const int mcts_player = game % 2 == 0 ? 1 : 2;
+        const double start = get_time_ms();
+        int plies = 0;
+
+        while (!player_1_win_check(state) && !player_2_win_check(state) && plies < ENGINE_GAME_MAX_PLIES) {
+            struct SearchResult result;
+
+            if (state.player_to_move == mcts_player) {
+                result = get_best_move_mcts(state, budget, 1);
+                mcts_playouts += result.nodes;
+                mcts_moves++;
+            } else {
+                result = get_best_move_timed(state, budget);
+                pvs_depths += result.depth;
+                pvs_moves++;
+            }
+
+            make_move(&state, &result.best_move);
+            plies++;
+        }
+
+        const int winner = player_1_win_check(state) ? 1 : player_2_win_check(state) ? 2 : 0;
+        mcts_wins += winner != 0 && winner == mcts_player;
+        pvs_wins += winner != 0 && winner != mcts_player;
+        draws += winner == 0;
+
+        printf("%6d %10d %8d %8s %8.1f\n", game + 1, mcts_player, plies,
+               winner == 0 ? "draw" : winner == mcts_player ? "MCTS" : "PVS", (get_time_ms() - start) / 1000.0);
+    }
+
+    printf("\nMCTS wins  : %d\n", mcts_wins);
+    printf("PVS wins   : %d\n", pvs_wins);
+    printf("Draws      : %d\n", draws);
+    printf("PVS depth  : %.1f per move\n", pvs_moves > 0 ? (double) pvs_depths / (double) pvs_moves : 0);
+    printf("Playouts   : %.0f per move\n", mcts_moves > 0 ? (double) mcts_playouts / (double) mcts_moves : 0);
+}
+
+// Engine moves played from each benchmark position by `bench_ponder`.
+#define PONDER_BENCH_MOVES 6
+
+/**
+ * @brief Plays a few moves from every benchmark position, the engine pondering for `think_ms`
+ * while its opponent (the engine searching 2 plies shallower) thinks. Each reply of the engine is
+ * timed after pondering and again with a fresh search, separately for ponder hits and misses.
+ */
+static void bench_ponder(int depth, uint32_t think_ms) {
+    const struct SearchBudget budget = { .max_depth = depth };
+    const struct SearchBudget opponent_budget = { .max_depth = depth > 2 ? depth - 2 : 1 };
+    const struct SearchOptions options = { .aspiration_window = DEFAULT_ASPIRATION_WINDOW,
+                                           .late_move_reductions = true,
+                                           .null_move_pruning = true,
+                                           .futility_pruning = true };
+    double pondered_times[2] = { 0 }, fresh_times[2] = { 0 };
+    int counts[2] = { 0 }, same_moves = 0;
+
+    struct SearchEngine *engine = new_search_engine();
+
+    printf("Pondering, depth %d, %u ms of pondering per move\n", depth, think_ms);
+
+    for (int i = 0; i < BENCH_POSITION_COUNT; i++) {
+        struct State state = load_bench_position(bench_positions[i]);
+        struct SearchResult result = get_best_move_pondered(engine, state, budget);
+
+        for (int m = 0; m < PONDER_BENCH_MOVES; m++) {
+            struct State next_state = state;
+            make_move(&next_state, &result.best_move);
+            if (player_1_win_check(next_state) || player_2_win_check(next_state)) {
+                break;
+            }
+
+            // The opponent searches first, as a search starts by clearing the transposition table.
+            struct Move reply = search_position(next_state, opponent_budget, options).best_move;
+            if (!start_pondering(engine, state, result.best_move, result.ponder_move)) {
+                break;
+            }
+            ponder(engine, think_ms);
+
+            make_move(&next_state, &reply);
+            state = next_state;
+            if (player_1_win_check(state) || player_2_win_check(state)) {
+                break;
+            }
+
+            const uint64_t hits = get_ponder_stats(engine)->hits;
+            double start = get_time_ms();
+            result = get_best_move_pondered(engine, state, budget);
+            const double pondered_time = get_time_ms() - start;
+            const bool hit = get_ponder_stats(engine)->hits > hits;
+
+            start = get_time_ms();
+            const struct Move fresh_move = search_position(state, budget, options).best_move;
+            fresh_times[hit] += get_time_ms() - start;
+            pondered_times[hit] += pondered_time;
+            counts[hit]++;
+            same_moves += encode_move(fresh_move) == encode_move(result.best_move);
+        }
+    }
+
+    const struct PonderStats *stats = get_ponder_stats(engine);
+    printf("%8s %6s %16s %16s\n", "", "moves", "pondered (ms)", "fresh (ms)");
+    for (int hit = 1; hit >= 0; hit--) {
+        printf("%8s %6d %16.1f %16.1f\n", hit ? "hits" : "misses", counts[hit],
+               counts[hit] > 0 ? pondered_times[hit] / counts[hit] : 0,
+               counts[hit] > 0 ? fresh_times[hit] / counts[hit] : 0);
+    }
+    printf("Same move as a fresh search: %d/%d\n", same_moves, counts[0] + counts[1]);
+    printf("Pondered %llu nodes in %.0f ms\n", (unsigned long long) stats->nodes, stats->time_ms);
+
+    free_search_engine(engine);
+}
+
+// Plies after which `bench_game` stops a game that nobody has won.
+#define GAME_BENCH_MAX_PLIES 120
+
+/**
+ * @brief Sums the nodes of the iterations of a search up to `depth`.
+ */
+static uint64_t count_iteration_nodes(const struct SearchStats *stats, int depth) {
+    uint64_t nodes = 0;
+    for (int d = 1; d <= depth && d <= stats->depth_count; d++) {
+        nodes += stats->depths[d].nodes;
+    }
+    return nodes;
+}
+
+/**
+ * @brief Plays a game from the start position with both players searching to `depth` afresh on
+ * every move, then replays its moves with a search engine kept by each player for the whole
+ * game. Prints the time to reach the depth on every move, along with the nodes of the iterations
+ * before the last two, which a kept engine mostly answers from the transposition table.
+ */
+static void bench_game(int depth) {
+    const struct SearchBudget budget = { .max_depth = depth };
+    const struct SearchOptions options = { .aspiration_window = DEFAULT_ASPIRATION_WINDOW,
+                                           .late_move_reductions = true,
+                                           .null_move_pruning = true,
+                                           .futility_pruning = true };
+    const int early_depth = depth > 2 ? depth - 2 : 0;
+    struct Move moves[GAME_BENCH_MAX_PLIES];
+    double fresh_times[GAME_BENCH_MAX_PLIES];
+    uint64_t fresh_nodes[GAME_BENCH_MAX_PLIES], fresh_early_nodes[GAME_BENCH_MAX_PLIES];
+    int ply_count = 0;
+
+    struct State state = new_state();
+    while (ply_count < GAME_BENCH_MAX_PLIES && !player_1_win_check(state) && !player_2_win_check(state)) {
+        const double start = get_time_ms();
+        struct SearchResult result = search_position(state, budget, options);
+        fresh_times[ply_count] = get_time_ms() - start;
+        fresh_nodes[ply_count] = result.nodes;
+        fresh_early_nodes[ply_count] = count_iteration_nodes(&result.stats, early_depth);
+        moves[ply_count] = result.best_move;
+        make_move(&state, &moves[ply_count]);
+        ply_count++;
+    }
+
+    printf("Time to depth %d over a game of %d plies, searched afresh and with an engine kept per player\n",
+           depth, ply_count);
+    printf("%5s %8s %12s %12s %12s %12s %12s %6s\n", "ply", "move", "fresh (ms)", "kept (ms)", "fresh nodes",
+           "kept nodes", "kept early", "same");
+
+    struct SearchEngine *engines[2] = { new_search_engine(), new_search_engine() };
+    double fresh_time = 0, kept_time = 0;
+    uint64_t fresh_total = 0, kept_total = 0, fresh_early_total = 0, kept_early_total = 0;
+    int same_moves = 0;
+
+    state = new_state();
+    for (int ply = 0; ply < ply_count; ply++) {
+        const double start = get_time_ms();
+        struct SearchResult result = search_with_engine(engines[state.player_to_move - 1], state, budget);
+        const double time = get_time_ms() - start;
+        const uint64_t early_nodes = count_iteration_nodes(&result.stats, early_depth);
+        const bool same = encode_move(result.best_move) == encode_move(moves[ply]);
+        char move_text[8];
+
+        format_move(moves[ply], move_text, sizeof(move_text));
+        printf("%5d %8s %12.1f %12.1f %12llu %12llu %12llu %6s\n", ply + 1, move_text, fresh_times[ply], time,
+               (unsigned long long) fresh_nodes[ply], (unsigned long long) result.nodes,
+               (unsigned long long) early_nodes, same ? "yes" : "no");
+
+        fresh_time += fresh_times[ply];
+        kept_time += time;
+        fresh_total += fresh_nodes[ply];
+        kept_total += result.nodes;
+        fresh_early_total += fresh_early_nodes[ply];
+        kept_early_total += early_nodes;
+        same_moves += same;
+        make_move(&state, &moves[ply]);
+    }
+
+    printf("\n%20s %12s %12s %16s\n", "", "time (ms)", "nodes", "early nodes");
+    printf("%20s %12.0f %12llu %16llu\n", "fresh", fresh_time, (unsigned long long) fresh_total,
+           (unsigned long long) fresh_early_total);
+    printf("%20s %12.0f %12llu %16llu\n", "kept", kept_time, (unsigned long long) kept_total,
+           (unsigned long long) kept_early_total);
+    printf("Early nodes are those of the iterations to depth %d.\n", early_depth);
+    printf("Same move as the fresh search: %d/%d\n", same_moves, ply_count);
+
+    free_search_engine(engines[0]);
+    free_search_engine(engines[1]);
+}
+
+static void print_usage(const char *program) {
+    fprintf(stderr, "Usage: %s bench [depth] [-v]\n", program);
+    fprintf(stderr, "       %s perft <depth> [position]...\n", program);
+    fprintf(stderr, "       %s divide <depth> [position]\n", program);
+    fprintf(stderr, "       %s threads [depth] [max threads]\n", program);
+    fprintf(stderr, "       %s ordering [depth]\n", program);
+    fprintf(stderr, "       %s relevant [depth]\n", program);
+    fprintf(stderr, "       %s aspiration [depth]\n", program);
+    fprintf(stderr, "       %s selective [depth]\n", program);
+    fprintf(stderr, "       %s evaluate [repetitions]\n", program);
+    fprintf(stderr, "       %s engines [time ms] [games]\n", program);
+    fprintf(stderr, "       %s ponder [depth] [ponder ms]\n", program);
+    fprintf(stderr, "       %s game [depth]\n", program);
+    fprintf(stderr, "Positions are comma separated moves from the start position, e.g. \"P N, P S, HF 2 3\".\n");
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if (strcmp(argv[1], "bench") == 0) {
+        int depth = argc > 2 ? atoi(argv[2]) : 5;
+
+        if (depth <= 0 || depth > MAX_SEARCH_DEPTH) {
+            print_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+
+        bench_search(depth, argc > 3 && strcmp(argv[3], "-v") == 0);
+        return EXIT_SUCCESS;
+    }
+
+    if (strcmp(argv[1], "perft") == 0 || strcmp(argv[1], "divide") == 0) {
+        int depth = argc > 2 ? atoi(argv[2]) : 0;
+
+        if (depth <= 0) {
+            print_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+
+        if (strcmp(argv[1], "divide") == 0) {
+            bench_divide(depth, argc > 3 ? argv[3] : "");
+        } else if (argc > 3) {
+            bench_perft(depth, (const char **) argv + 3, argc - 3);
+        } else {
+            bench_perft(depth, bench_positions, BENCH_POSITION_COUNT);
+        }
+        return EXIT_SUCCESS;
+    }
+
+    if (strcmp(argv[1], "threads") == 0) {
+        int depth = argc > 2 ? atoi(argv[2]) : 5;
+        int max_threads = argc > 3 ? atoi(argv[3]) : 16;
+
+        if (depth <= 0 || max_threads <= 0 || max_threads > MAX_SEARCH_THREADS) {
+            print_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+
+        bench_threads(depth, max_threads);
+        return EXIT_SUCCESS;
+    }
+
+    if (strcmp(argv[1], "ordering") == 0) {
+        int depth = argc > 2 ? atoi(argv[2]) : 5;
+
+        if (depth <= 0 || depth > MAX_SEARCH_DEPTH) {
+            print_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+
+        bench_ordering(depth);
+        return EXIT_SUCCESS;
+    }
+
+    if (strcmp(argv[1], "relevant") == 0) {
+        int depth = argc > 2 ? atoi(argv[2]) : 5;
+
+        if (depth <= 0 || depth > MAX_SEARCH_DEPTH) {
+            print_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+
+        bench_relevant_fences(depth);
+        return EXIT_SUCCESS;
+    }
+
+    if (strcmp(argv[1], "aspiration") == 0) {
+        int depth = argc > 2 ? atoi(argv[2]) : 5;
+
+        if (depth <= 0 || depth > MAX_SEARCH_DEPTH) {
+            print_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+
+        bench_aspiration(depth);
+        return EXIT_SUCCESS;
+    }
+
+    if (strcmp(argv[1], "selective") == 0) {
+        int depth = argc > 2 ? atoi(argv[2]) : 5;
+
+        if (depth <= 0 || depth > MAX_SEARCH_DEPTH) {
+            print_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+
+        bench_selective(depth);
+        return EXIT_SUCCESS;
+    }
+
+    if (strcmp(argv[1], "evaluate") == 0) {
+        int repetitions = argc > 2 ? atoi(argv[2]) : 20;
+
+        if (repetitions <= 0) {
+            print_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+
+        return bench_evaluate(repetitions) == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    if (strcmp(argv[1], "ponder") == 0) {
+        int depth = argc > 2 ? atoi(argv[2]) : 7;
+        int think_ms = argc > 3 ? atoi(argv[3]) : 500;
+
+        if (depth <= 0 || depth > MAX_SEARCH_DEPTH || think_ms <= 0) {
+            print_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+
+        bench_ponder(depth, think_ms);
+        return EXIT_SUCCESS;
+    }
+
+    if (strcmp(argv[1], "game") == 0) {
+        int depth = argc > 2 ? atoi(argv[2]) : 6;
+
+        if (depth <= 0 || depth > MAX_SEARCH_DEPTH) {
+            print_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+
+        bench_game(depth);
+        return EXIT_SUCCESS;
+    }
+
+    if (strcmp(argv[1], "engines") == 0) {
+        int time_limit_ms = argc > 2 ? atoi(argv[2]) : 100;
+        int game_count = argc > 3 ? atoi(argv[3]) : 2 * BENCH_POSITION_COUNT;
+
+        if (time_limit_ms <= 0 || game_count <= 0) {
+            print_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+
+        bench_engines(time_limit_ms, game_count);
+        return EXIT_SUCCESS;
+    }
+
+    print_usage(argv[0]);
+    return EXIT_FAILURE;
+}
@@ -1,4 +1,5 @@
 #include "bitboards.h"
+#include "state.h"
 
 // 11x11 bit mask border, Surrounds the 9x9 game board
 static const __uint128_t BORDER =
@@ -63,4 +64,43 @@ void generate_bitboards(const struct State *state, struct Bitboards *bb) {
     bb->right_fences = right_fences;
     bb->down_fences = down_fences;
     bb->left_fences = left_fences;
-}
\ No newline at end of file
+}
+
+/**
+ * Bitboard square above and to the left of the fence, i.e. the square the fence's top left corner
+ * touches. The 11x11 board has a 1 square border, hence the offset of 12.
+ */
+#define fence_top_left_square(fence_index) \
+    square128(12 + ((fence_index) / FENCE_BIT_BOARD_WIDTH) * 11 + (fence_index) % FENCE_BIT_BOARD_WIDTH)
+
+void add_horizontal_fence_to_bitboards(struct Bitboards *bb, int fence_index) {
+    __uint128_t up_squares = fence_top_left_square(fence_index);
+    up_squares |= bitboard_right(up_squares);
+
+    bb->up_fences |= up_squares;
+    bb->down_fences |= bitboard_down(up_squares);
+}
+
+void remove_horizontal_fence_from_bitboards(struct Bitboards *bb, int fence_index) {
+    __uint128_t up_squares = fence_top_left_square(fence_index);
+    up_squares |= bitboard_right(up_squares);
+
+    bb->up_fences &= ~up_squares;
+    bb->down_fences &= ~bitboard_down(up_squares);
+}
+
+void add_vertical_fence_to_bitboards(struct Bitboards *bb, int fence_index) {
+    __uint128_t left_squares = fence_top_left_square(fence_index);
+    left_squares |= bitboard_down(left_squares);
+
+    bb->left_fences |= left_squares;
+    bb->right_fences |= bitboard_right(left_squares);
+}
+
+void remove_vertical_fence_from_bitboards(struct Bitboards *bb, int fence_index) {
+    __uint128_t left_squares = fence_top_left_square(fence_index);
+    left_squares |= bitboard_down(left_squares);
+
+    bb->left_fences &= ~left_squares;
+    bb->right_fences &= ~bitboard_right(left_squares);
+}
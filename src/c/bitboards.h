@@ -2,7 +2,8 @@
 #define BITBOARDS_H
 
 #include <stdint.h>
-#include "state.h"
+
+struct State;
 
 #define bitboard_up(board) ((board) >> 11)
 #define bitboard_down(board) ((board) << 11)
@@ -16,6 +17,9 @@
  * This struct holds four 128-bit bitboards that represent the presence of fences in a
  * Quoridor board. Each field encodes which squares are blocked when moving in that
  * respective direction, i.e. `up_fences` blocks upwards movement.
+ *
+ * A copy is kept in every `State` and updated by the fence make/unmake functions, so these
+ * only need to be generated from scratch when a state is built without them.
  */
 struct Bitboards {
     __uint128_t up_fences;
@@ -35,4 +39,38 @@ struct Bitboards {
  */
 void generate_bitboards(const struct State *state, struct Bitboards *bb);
 
+/**
+ * @brief Adds the blocked edges of a single horizontal fence to the bitboards.
+ *
+ * A horizontal fence blocks upwards movement into the two squares above it and downwards
+ * movement into the two squares below it.
+ *
+ * @param bb Pointer to the Bitboards structure to update.
+ * @param fence_index Index of the fence on the 8x8 fence board.
+ */
+void add_horizontal_fence_to_bitboards(struct Bitboards *bb, int fence_index);
+
+/**
+ * @brief Removes the blocked edges of a single horizontal fence from the bitboards.
+ *
+ * Fences never overlap, so the cleared bits cannot belong to another fence or the border.
+ */
+void remove_horizontal_fence_from_bitboards(struct Bitboards *bb, int fence_index);
+
+/**
+ * @brief Adds the blocked edges of a single vertical fence to the bitboards.
+ *
+ * A vertical fence blocks rightwards movement into the two squares to its right and leftwards
+ * movement into the two squares to its left.
+ *
+ * @param bb Pointer to the Bitboards structure to update.
+ * @param fence_index Index of the fence on the 8x8 fence board.
+ */
+void add_vertical_fence_to_bitboards(struct Bitboards *bb, int fence_index);
+
+/**
+ * @brief Removes the blocked edges of a single vertical fence from the bitboards.
+ */
+void remove_vertical_fence_from_bitboards(struct Bitboards *bb, int fence_index);
+
 #endif // BITBOARDS_H
\ No newline at end of file
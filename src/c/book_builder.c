@@ -0,0 +1,336 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "state.h"
+#include "move.h"
+#include "move_generation.h"
+#include "search.h"
+#include "evaluate.h"
+#include "opening_book.h"
+
+/**
+ * @struct BookBuilder
+ * @brief The entries of a book being built, in no particular order until it is written.
+ */
+struct BookBuilder {
+    struct OpeningBookEntry *entries;
+    size_t count;
+    size_t capacity;
+};
+
+static void add_book_entry(struct BookBuilder *builder, uint64_t key, struct Move move, uint32_t weight) {
+    if (builder->count == builder->capacity) {
+        builder->capacity = builder->capacity > 0 ? builder->capacity * 2 : 1024;
+        builder->entries = realloc(builder->entries, builder->capacity * sizeof(struct OpeningBookEntry));
+
+        if (builder->entries == NULL) {
+            exit(1);  // malloc failed, should probably log this somehow.
+        }
+    }
+
+    builder->entries[builder->count++] = (struct OpeningBookEntry) {
+            .key = key,
+            .weight = weight < UINT16_MAX ? weight : UINT16_MAX,
+            .move = encode_move(move),
+    };
+}
+
+static bool book_contains_position(const struct BookBuilder *builder, uint64_t key) {
+    for (size_t i = 0; i < builder->count; i++) {
+        if (builder->entries[i].key == key) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static int compare_by_key_and_move(const void *a, const void *b) {
+    const struct OpeningBookEntry *entry_a = a, *entry_b = b;
+
+    if (entry_a->key != entry_b->key) {
+        return entry_a->key < entry_b->key ? -1 : 1;
+    }
+    return (int) entry_a->move - (int) entry_b->move;
+}
+
+static int compare_by_key_and_weight(const void *a, const void *b) {
+    const struct OpeningBookEntry *entry_a = a, *entry_b = b;
+
+    if (entry_a->key != entry_b->key) {
+        return entry_a->key < entry_b->key ? -1 : 1;
+    }
+    if (entry_a->weight != entry_b->weight) {
+        return (int) entry_b->weight - (int) entry_a->weight;
+    }
+    return (int) entry_a->move - (int) entry_b->move;
+}
+
+/**
+ * @brief Merges the entries of the same move of the same position, adding up their weights.
+ */
+static void merge_book_entries(struct BookBuilder *builder) {
+    qsort(builder->entries, builder->count, sizeof(struct OpeningBookEntry), compare_by_key_and_move);
+
+    size_t merged = 0;
+    for (size_t i = 0; i < builder->count; i++) {
+        struct OpeningBookEntry *last = merged > 0 ? &builder->entries[merged - 1] : NULL;
+
+        if (last != NULL && last->key == builder->entries[i].key && last->move == builder->entries[i].move) {
+            const uint32_t weight = (uint32_t) last->weight + builder->entries[i].weight;
+            last->weight = weight < UINT16_MAX ? weight : UINT16_MAX;
+        } else {
+            builder->entries[merged++] = builder->entries[i];
+        }
+    }
+    builder->count = merged;
+}
+
+/**
+ * @brief Writes the entries of a book to a file, sorted in the order the probe expects.
+ *
+ * @return True if the book was written.
+ */
+static bool write_book(struct BookBuilder *builder, const char *path) {
+    qsort(builder->entries, builder->count, sizeof(struct OpeningBookEntry), compare_by_key_and_weight);
+
+    struct OpeningBookHeader header = {
+            .version = OPENING_BOOK_VERSION,
+            .entry_count = builder->count,
+            .start_key = new_state().hash,
+    };
+    memcpy(header.magic, OPENING_BOOK_MAGIC, sizeof(header.magic));
+
+    FILE *file = fopen(path, "wb");
+    if (file == NULL) {
+        return false;
+    }
+
+    const bool written = fwrite(&header, sizeof(header), 1, file) == 1 &&
+                         fwrite(builder->entries, sizeof(struct OpeningBookEntry), builder->count, file) ==
+                         builder->count;
+    return fclose(file) == 0 && written;
+}
+
+/**
+ * @brief Scores a move with a search of the position after it, from the point of view of the
+ * player making the move.
+ */
+static int score_book_move(struct State *state, struct Move move, int depth) {
+    make_move(state, &move);
+
+    int score;
+    if (player_1_win_check(*state) || player_2_win_check(*state)) {
+        score = WINNING_SCORE;
+    } else {
+        score = -search_position(*state, (struct SearchBudget) { .max_depth = depth - 1 },
+                                 (struct SearchOptions) { 0 }).best_move.score;
+    }
+
+    unmake_move(state, &move);
+    return score;
+}
+
+/**
+ * @brief Adds the best moves of a position to the book, found by searching every legal move, and
+ * continues with the positions after them.
+ *
+ * Moves within `margin` of the best score are kept, at most `max_moves` of them, with a weight
+ * that decreases with their distance from the best score.
+ */
+static void build_book_from_search(struct BookBuilder *builder, struct State *state, int depth, int plies, // NOLINT(*-no-recursion)
+                                   int margin, int max_moves) {
+    if (plies == 0 || player_1_win_check(*state) || player_2_win_check(*state) ||
+        book_contains_position(builder, state->hash)) {
+        return;
+    }
+
+    EncodedMove moves[MAX_MOVE_COUNT];
+    int scores[MAX_MOVE_COUNT];
+    const int move_count = generate_all_legal_moves(state, moves);
+    int best_score = INT32_MIN;
+
+    for (int i = 0; i < move_count; i++) {
+        scores[i] = score_book_move(state, decode_move(moves[i]), depth);
+        best_score = scores[i] > best_score ? scores[i] : best_score;
+    }
+
+    // Selection sort of the kept moves, best first.
+    struct Move kept_moves[OPENING_BOOK_MAX_MOVES];
+    int kept_count = 0;
+
+    while (kept_count < max_moves) {
+        int best_index = -1;
+
+        for (int i = 0; i < move_count; i++) {
+            if (scores[i] >= best_score - margin && (best_index < 0 || scores[i] > scores[best_index])) {
+                best_index = i;
+            }
+        }
+        if (best_index < 0) {
+            break;
+        }
+
+        kept_moves[kept_count] = decode_move(moves[best_index]);
+        add_book_entry(builder, state->hash, kept_moves[kept_count], 1 + margin - (best_score - scores[best_index]));
+        scores[best_index] = INT32_MIN;
+        kept_count++;
+    }
+
+    printf("Position %016llx: %d of %d moves kept\n", (unsigned long long) state->hash, kept_count, move_count);
+
+    for (int i = 0; i < kept_count; i++) {
+        make_move(state, &kept_moves[i]);
+        build_book_from_search(builder, state, depth, plies - 1, margin, max_moves);
+        unmake_move(state, &kept_moves[i]);
+    }
+}
+
+/**
+ * @brief Adds the first moves of recorded games to the book, weighted by how often each move was
+ * played in each position.
+ *
+ * Games are read one per line, as comma separated moves from the start position in the same
+ * format as the command line game. A game is ignored from its first invalid move onwards.
+ *
+ * @return The number of games read, or -1 if the file cannot be read.
+ */
+static int build_book_from_games(struct BookBuilder *builder, const char *path, int plies) {
+    FILE *file = fopen(path, "r");
+    if (file == NULL) {
+        return -1;
+    }
+
+    char line[4096];
+    int game_count = 0;
+
+    while (fgets(line, sizeof(line), file) != NULL) {
+        struct State state = new_state();
+        const char *text = line + strspn(line, ", \t");
+
+        for (int ply = 0; ply < plies && *text != '\0' && *text != '\n' && *text != '\r'; ply++) {
+            struct Move move;
+            const int consumed = parse_move(text, &move);
+
+            if (consumed == 0 || player_1_win_check(state) || player_2_win_check(state) ||
+                !move_is_fully_legal(&state, move)) {
+                fprintf(stderr, "Invalid move in game %d at \"%.*s\", the rest of the game is ignored.\n",
+                        game_count + 1, (int) strcspn(text, ",\r\n"), text);
+                break;
+            }
+
+            add_book_entry(builder, state.hash, move, 1);
+            make_move(&state, &move);
+            text += consumed;
+            text += strspn(text, ", \t");
+        }
+        game_count++;
+    }
+
+    fclose(file);
+    return game_count;
+}
+
+/**
+ * @brief Writes a book file as a C source file, to be compiled into builds that cannot map files.
+ *
+ * @return True if the source file was written.
+ */
+static bool export_book(const char *book_path, const char *source_path) {
+    FILE *book = fopen(book_path, "rb");
+    if (book == NULL) {
+        return false;
+    }
+
+    FILE *source = fopen(source_path, "w");
+    if (source == NULL) {
+        fclose(book);
+        return false;
+    }
+
+    fprintf(source, "// Generated by `quoridor_book export %s`, do not edit.\n", book_path);
+    fprintf(source, "#include <stddef.h>\n\n");
+    fprintf(source, "_Alignas(8) const unsigned char opening_book_data[] = {");
+
+    size_t size = 0;
+    int byte;
+    while ((byte = fgetc(book)) != EOF) {
+        fprintf(source, "%s0x%02x,", size % 16 == 0 ? "\n        " : " ", byte);
+        size++;
+    }
+
+    fprintf(source, "\n};\n\nconst size_t opening_book_data_size = %zu;\n", size);
+
+    fclose(book);
+    return fclose(source) == 0;
+}
+
+static void print_usage(const char *program) {
+    fprintf(stderr, "Usage: %s search <output> [depth] [plies] [max moves] [margin]\n", program);
+    fprintf(stderr, "       %s games <output> <games> [plies]\n", program);
+    fprintf(stderr, "       %s export <book> <output.c>\n", program);
+    fprintf(stderr, "Games are read one per line, as comma separated moves, e.g. \"P N, P S, HF 2 3\".\n");
+}
+
+int main(int argc, char **argv) {
+    if (argc < 3) {
+        print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    struct BookBuilder builder = { 0 };
+
+    if (strcmp(argv[1], "search") == 0) {
+        const int depth = argc > 3 ? atoi(argv[3]) : 4;
+        const int plies = argc > 4 ? atoi(argv[4]) : 4;
+        const int max_moves = argc > 5 ? atoi(argv[5]) : 3;
+        const int margin = argc > 6 ? atoi(argv[6]) : 2;
+
+        if (depth < 2 || depth > MAX_SEARCH_DEPTH || plies <= 0 || max_moves <= 0 ||
+            max_moves > OPENING_BOOK_MAX_MOVES || margin < 0) {
+            print_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+
+        struct State state = new_state();
+        build_book_from_search(&builder, &state, depth, plies, margin, max_moves);
+    } else if (strcmp(argv[1], "games") == 0) {
+        const int plies = argc > 4 ? atoi(argv[4]) : 8;
+
+        if (argc < 4 || plies <= 0) {
+            print_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+
+        const int game_count = build_book_from_games(&builder, argv[3], plies);
+        if (game_count < 0) {
+            fprintf(stderr, "Cannot read games from %s.\n", argv[3]);
+            return EXIT_FAILURE;
+        }
+        printf("%d games read\n", game_count);
+        merge_book_entries(&builder);
+    } else if (strcmp(argv[1], "export") == 0) {
+        if (argc < 4) {
+            print_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+
+        if (!export_book(argv[2], argv[3])) {
+            fprintf(stderr, "Cannot export %s to %s.\n", argv[2], argv[3]);
+            return EXIT_FAILURE;
+        }
+        return EXIT_SUCCESS;
+    } else {
+        print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if (!write_book(&builder, argv[2])) {
+        fprintf(stderr, "Cannot write the book to %s.\n", argv[2]);
+        return EXIT_FAILURE;
+    }
+    printf("%zu entries written to %s\n", builder.count, argv[2]);
+
+    free(builder.entries);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,200 @@
+#include <stdlib.h>
+#include "endgame.h"
+#include "move_generation.h"
+
+#define SQUARE_COUNT (BOARD_SIZE * BOARD_SIZE)
+
+// A pawn has at most 3 steps and 2 diagonal jumps, or 4 steps/straight jumps.
+#define MAX_ENDGAME_MOVE_COUNT 5
+
+// Higher than the number of plies of any endgame, used to rank outcomes.
+#define ENDGAME_OUTCOME_RANGE (1 << 14)
+
+/**
+ * @struct EndgameSolver
+ * @brief Scratch space of `solve_endgame`, the move graph of every position and the search queue.
+ */
+struct EndgameSolver {
+    uint16_t successors[ENDGAME_POSITION_COUNT][MAX_ENDGAME_MOVE_COUNT];
+    uint8_t remaining_moves[ENDGAME_POSITION_COUNT];  // Moves that have not been proven to lose.
+    uint32_t predecessor_offsets[ENDGAME_POSITION_COUNT + 1];
+    uint16_t predecessors[ENDGAME_POSITION_COUNT * MAX_ENDGAME_MOVE_COUNT];
+    uint16_t queue[ENDGAME_POSITION_COUNT];
+};
+
+static _Thread_local struct EndgameTable endgame_cache[ENDGAME_CACHE_SIZE];
+static _Thread_local int endgame_cache_count = 0;
+static _Thread_local int endgame_cache_next = 0;
+
+/**
+ * @brief Ranks an outcome from the point of view of the player to move: wins before draws before
+ * losses, faster wins and slower losses first.
+ */
+static inline int rank_endgame_outcome(int outcome) {
+    if (outcome == ENDGAME_DRAW) {
+        return 0;
+    }
+    return outcome > 0 ? ENDGAME_OUTCOME_RANGE - outcome : -ENDGAME_OUTCOME_RANGE - outcome;
+}
+
+/**
+ * @brief Finds the position reached by a pawn move of the player to move.
+ */
+static inline int endgame_successor_index(const struct State *state, int pawn_move_index) {
+    int player_1_square = state->player_1_row * BOARD_SIZE + state->player_1_col;
+    int player_2_square = state->player_2_row * BOARD_SIZE + state->player_2_col;
+    const int offset = pawn_move_row_offsets[pawn_move_index] * BOARD_SIZE + pawn_move_col_offsets[pawn_move_index];
+
+    if (state->player_to_move == 1) {
+        player_1_square += offset;
+    } else {
+        player_2_square += offset;
+    }
+
+    return endgame_position_index(3 - state->player_to_move, player_1_square, player_2_square);
+}
+
+void solve_endgame(const struct State *state, struct EndgameTable *table) {
+    struct EndgameSolver *solver = malloc(sizeof(struct EndgameSolver));
+    if (solver == NULL) {
+        exit(1);  // malloc failed, should probably log this somehow.
+    }
+
+    // Pawn moves only depend on the fence bitboards and the pawns, which are set for each position.
+    struct State scratch = *state;
+    int queue_length = 0;
+
+    table->vertical_fences = state->vertical_fences;
+    table->horizontal_fences = state->horizontal_fences;
+
+    for (int i = 0; i <= ENDGAME_POSITION_COUNT; i++) {
+        solver->predecessor_offsets[i] = 0;
+    }
+
+    for (int i = 0; i < ENDGAME_POSITION_COUNT; i++) {
+        const int player_1_square = i / SQUARE_COUNT % SQUARE_COUNT;
+        const int player_2_square = i % SQUARE_COUNT;
+
+        table->outcomes[i] = ENDGAME_DRAW;
+        solver->remaining_moves[i] = 0;
+
+        if (player_1_square == player_2_square) {
+            continue;
+        }
+
+        scratch.player_to_move = i / (SQUARE_COUNT * SQUARE_COUNT) + 1;
+        scratch.player_1_row = player_1_square / BOARD_SIZE;
+        scratch.player_1_col = player_1_square % BOARD_SIZE;
+        scratch.player_2_row = player_2_square / BOARD_SIZE;
+        scratch.player_2_col = player_2_square % BOARD_SIZE;
+
+        if (player_1_win_check(scratch) || player_2_win_check(scratch)) {
+            table->outcomes[i] = 0;
+            solver->queue[queue_length++] = i;
+            continue;
+        }
+
+        for (PawnMoves moves = generate_legal_pawn_moves(&scratch); moves != 0; moves &= moves - 1) {
+            const int successor = endgame_successor_index(&scratch, __builtin_ctz(moves));
+
+            solver->successors[i][solver->remaining_moves[i]++] = successor;
+            solver->predecessor_offsets[successor + 1]++;
+        }
+    }
+
+    // The predecessors of each position are stored contiguously, in the order of the positions.
+    for (int i = 0; i < ENDGAME_POSITION_COUNT; i++) {
+        solver->predecessor_offsets[i + 1] += solver->predecessor_offsets[i];
+    }
+    for (int i = 0; i < ENDGAME_POSITION_COUNT; i++) {
+        for (int m = 0; m < solver->remaining_moves[i]; m++) {
+            const int successor = solver->successors[i][m];
+            solver->predecessors[solver->predecessor_offsets[successor]++] = i;
+        }
+    }
+    // Filling moved each offset to the start of the next position's predecessors.
+    for (int i = ENDGAME_POSITION_COUNT; i > 0; i--) {
+        solver->predecessor_offsets[i] = solver->predecessor_offsets[i - 1];
+    }
+    solver->predecessor_offsets[0] = 0;
+
+    // Positions are resolved in increasing number of plies. A position is won as soon as one of
+    // its moves reaches a lost position, and lost when the last of its moves reaches a won one.
+    for (int head = 0; head < queue_length; head++) {
+        const int position = solver->queue[head];
+        const int outcome = table->outcomes[position];
+
+        for (uint32_t p = solver->predecessor_offsets[position]; p < solver->predecessor_offsets[position + 1]; p++) {
+            const int predecessor = solver->predecessors[p];
+
+            if (table->outcomes[predecessor] != ENDGAME_DRAW) {
+                continue;
+            }
+
+            if (outcome <= 0) {
+                table->outcomes[predecessor] = 1 - outcome;
+                solver->queue[queue_length++] = predecessor;
+            } else if (--solver->remaining_moves[predecessor] == 0) {
+                table->outcomes[predecessor] = -(outcome + 1);
+                solver->queue[queue_length++] = predecessor;
+            }
+        }
+    }
+
+    free(solver);
+}
+
+/**
+ * @return The solution of the fences of a state in the cache, or NULL.
+ */
+static const struct EndgameTable *find_endgame_table(const struct State *state) {
+    for (int i = 0; i < endgame_cache_count; i++) {
+        if (endgame_cache[i].vertical_fences == state->vertical_fences &&
+            endgame_cache[i].horizontal_fences == state->horizontal_fences) {
+            return &endgame_cache[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @return The solution of the fences of a state, solving them if they are not in the cache.
+ */
+static const struct EndgameTable *get_endgame_table(const struct State *state) {
+    const struct EndgameTable *cached = find_endgame_table(state);
+    if (cached != NULL) {
+        return cached;
+    }
+
+    struct EndgameTable *table = &endgame_cache[endgame_cache_next];
+    endgame_cache_next = (endgame_cache_next + 1) % ENDGAME_CACHE_SIZE;
+    if (endgame_cache_count < ENDGAME_CACHE_SIZE) {
+        endgame_cache_count++;
+    }
+
+    solve_endgame(state, table);
+    return table;
+}
+
+bool is_endgame_solved(const struct State *state) {
+    return find_endgame_table(state) != NULL;
+}
+
+int probe_endgame(const struct State *state, struct Move *best_move) {
+    const struct EndgameTable *table = get_endgame_table(state);
+    int best_rank = INT32_MIN;
+
+    for (PawnMoves moves = generate_legal_pawn_moves(state); moves != 0; moves &= moves - 1) {
+        const int pawn_move_index = __builtin_ctz(moves);
+        const int rank = -rank_endgame_outcome(table->outcomes[endgame_successor_index(state, pawn_move_index)]);
+
+        if (rank > best_rank) {
+            best_rank = rank;
+            *best_move = (struct Move) { .move.pawnMove = 1 << pawn_move_index, .moveType = Pawn };
+        }
+    }
+
+    return table->outcomes[endgame_position_index(state->player_to_move,
+                                                  state->player_1_row * BOARD_SIZE + state->player_1_col,
+                                                  state->player_2_row * BOARD_SIZE + state->player_2_col)];
+}
@@ -0,0 +1,72 @@
+#ifndef QUORIDOR_ENDGAME_H
+#define QUORIDOR_ENDGAME_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "state.h"
+#include "move.h"
+
+#define ENDGAME_POSITION_COUNT (2 * BOARD_SIZE * BOARD_SIZE * BOARD_SIZE * BOARD_SIZE)
+
+// Outcome of positions that neither player can force a win from.
+#define ENDGAME_DRAW INT16_MIN
+
+// Number of fence configurations whose solutions are kept by each thread.
+#define ENDGAME_CACHE_SIZE 4
+
+#define is_fenceless_endgame(state) ((state).player_1_fence_count == 0 && (state).player_2_fence_count == 0)
+
+/**
+ * @struct EndgameTable
+ * @brief The exact outcome of every pawn placement on a fixed set of fences, once neither player
+ * has a fence left.
+ *
+ * Positions are indexed by `endgame_position_index`. The outcome of a position is the number of
+ * plies until the game ends with optimal play, negated if the player to move loses, or
+ * `ENDGAME_DRAW`. A position where the opponent has just reached their goal row is lost in 0 plies.
+ */
+struct EndgameTable {
+    uint64_t vertical_fences;
+    uint64_t horizontal_fences;
+    int16_t outcomes[ENDGAME_POSITION_COUNT];
+};
+
+static inline int endgame_position_index(int player_to_move, int player_1_square, int player_2_square) {
+    return ((player_to_move - 1) * BOARD_SIZE * BOARD_SIZE + player_1_square) * BOARD_SIZE * BOARD_SIZE +
+           player_2_square;
+}
+
+/**
+ * @brief Solves every pawn placement on the fences of a state.
+ *
+ * Without fences left to place, the game is a pawn race in a fixed maze, with at most 13122
+ * positions. They are solved by retrograde analysis: starting from the positions where a player
+ * has reached their goal row, a position is won if a move reaches a lost position, and lost once
+ * all its moves reach won positions. Positions that are never resolved are draws, neither player
+ * can force a win from them.
+ *
+ * @param state The game state, only the fences are used.
+ * @param table Pointer to the table to fill.
+ */
+void solve_endgame(const struct State *state, struct EndgameTable *table);
+
+/**
+ * @return True if the fences of a state are in the calling thread's cache, so that probing it
+ *         does not solve them.
+ */
+bool is_endgame_solved(const struct State *state);
+
+/**
+ * @brief Looks up the exact outcome of a position where neither player has a fence left.
+ *
+ * The fence configuration is solved with `solve_endgame` the first time it is probed, the calling
+ * thread keeps the solutions of the last `ENDGAME_CACHE_SIZE` configurations.
+ *
+ * @param state The game state, both fence counts must be 0 and neither player may have won.
+ * @param best_move Pointer to where an optimal move is stored: the fastest win, or the slowest
+ *                  loss.
+ * @return The outcome of the position, as in `struct EndgameTable`.
+ */
+int probe_endgame(const struct State *state, struct Move *best_move);
+
+#endif //QUORIDOR_ENDGAME_H
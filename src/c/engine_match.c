@@ -0,0 +1,135 @@
+#include <string.h>
+#include "engine_match.h"
+#include "move_generation.h"
+#include "mcts.h"
+
+void print_engine_config_usage(FILE *file) {
+    fprintf(file, "Engines:\n");
+    fprintf(file, "  pvs[:depth=<d>,time=<ms>,nodes=<n>,relevant=<0|1>,aspiration=<w>,lmr=<0|1>,null=<0|1>,\n");
+    fprintf(file, "      futility=<0|1>]\n");
+    fprintf(file, "  mcts[:time=<ms>,nodes=<playouts>]\n");
+}
+
+bool parse_engine_config(const char *specification, struct EngineConfig *config) {
+    *config = (struct EngineConfig) { .name = specification };
+
+    const size_t type_length = strcspn(specification, ":");
+    if (type_length == 3 && strncmp(specification, "pvs", 3) == 0) {
+        config->type = EnginePvs;
+        config->budget.max_depth = 4;
+        config->options.aspiration_window = DEFAULT_ASPIRATION_WINDOW;
+    } else if (type_length == 4 && strncmp(specification, "mcts", 4) == 0) {
+        config->type = EngineMcts;
+    } else {
+        return false;
+    }
+
+    const char *text = specification + type_length;
+    while (*text != '\0') {
+        char key[32];
+        long value;
+        int consumed;
+
+        text++;  // Skips the ':' or ','.
+        if (sscanf(text, "%31[a-z]=%ld%n", key, &value, &consumed) != 2 || value < 0 ||
+            (text[consumed] != '\0' && text[consumed] != ',')) {
+            return false;
+        }
+        text += consumed;
+
+        if (strcmp(key, "time") == 0) {
+            config->budget.time_limit_ms = value;
+        } else if (strcmp(key, "nodes") == 0) {
+            config->budget.node_limit = value;
+        } else if (config->type == EnginePvs && strcmp(key, "depth") == 0 && value <= MAX_SEARCH_DEPTH) {
+            config->budget.max_depth = (int) value;
+        } else if (config->type == EnginePvs && strcmp(key, "relevant") == 0) {
+            config->options.relevant_fences_only = value != 0;
+        } else if (config->type == EnginePvs && strcmp(key, "aspiration") == 0 && value <= UINT8_MAX) {
+            config->options.aspiration_window = (int) value;
+        } else if (config->type == EnginePvs && strcmp(key, "lmr") == 0) {
+            config->options.late_move_reductions = value != 0;
+        } else if (config->type == EnginePvs && strcmp(key, "null") == 0) {
+            config->options.null_move_pruning = value != 0;
+        } else if (config->type == EnginePvs && strcmp(key, "futility") == 0) {
+            config->options.futility_pruning = value != 0;
+        } else {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+struct GameRecordPlayer engine_config_to_record_player(const struct EngineConfig *config) {
+    const struct SearchOptions *options = &config->options;
+
+    return (struct GameRecordPlayer) {
+            .engine = config->type == EngineMcts ? GameRecordMcts : GameRecordPvs,
+            .max_depth = config->budget.max_depth,
+            .options = (options->relevant_fences_only ? GAME_RECORD_RELEVANT_FENCES_ONLY : 0) |
+                       (options->late_move_reductions ? GAME_RECORD_LATE_MOVE_REDUCTIONS : 0) |
+                       (options->null_move_pruning ? GAME_RECORD_NULL_MOVE_PRUNING : 0) |
+                       (options->futility_pruning ? GAME_RECORD_FUTILITY_PRUNING : 0),
+            .aspiration_window = options->aspiration_window,
+            .time_limit_ms = config->budget.time_limit_ms,
+            .node_limit = config->budget.node_limit,
+    };
+}
+
+struct Move choose_engine_move(const struct EngineConfig *config, const struct State *state) {
+    switch (config->type) {
+        case EngineMcts:
+            return get_best_move_mcts(*state, config->budget, 1).best_move;
+        case EnginePvs:
+        default:
+            return search_position(*state, config->budget, config->options).best_move;
+    }
+}
+
+int play_game(const struct EngineConfig *player_1, const struct EngineConfig *player_2, struct State state,
+              struct GameRecord *record) {
+    for (int ply = 0; ply < MATCH_MAX_PLIES; ply++) {
+        if (player_1_win_check(state) || player_2_win_check(state)) {
+            break;
+        }
+
+        struct Move move = choose_engine_move(state.player_to_move == 1 ? player_1 : player_2, &state);
+        make_move(&state, &move);
+
+        if (record != NULL) {
+            record->moves[record->header.move_count++] = encode_move(move);
+        }
+    }
+
+    const int winner = player_1_win_check(state) ? 1 : player_2_win_check(state) ? 2 : 0;
+    if (record != NULL) {
+        record->header.winner = winner;
+    }
+    return winner;
+}
+
+uint64_t next_random(uint64_t *random_state) {
+    *random_state ^= *random_state << 13;
+    *random_state ^= *random_state >> 7;
+    *random_state ^= *random_state << 17;
+    return *random_state;
+}
+
+struct State generate_opening(int plies, uint64_t *random_state, EncodedMove *moves) {
+    struct State state = new_state();
+    EncodedMove legal_moves[MAX_MOVE_COUNT];
+
+    for (int ply = 0; ply < plies; ply++) {
+        const int move_count = generate_all_legal_moves(&state, legal_moves);
+        const EncodedMove encoded_move = legal_moves[next_random(random_state) % move_count];
+        struct Move move = decode_move(encoded_move);
+        make_move(&state, &move);
+
+        if (moves != NULL) {
+            moves[ply] = encoded_move;
+        }
+    }
+
+    return state;
+}
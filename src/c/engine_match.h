@@ -0,0 +1,67 @@
+#ifndef QUORIDOR_ENGINE_MATCH_H
+#define QUORIDOR_ENGINE_MATCH_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "state.h"
+#include "move.h"
+#include "search.h"
+#include "game_record.h"
+
+// Games longer than this are drawn, pawns can move back and forth forever.
+#define MATCH_MAX_PLIES 200
+
+enum EngineType {
+    EnginePvs,
+    EngineMcts,
+};
+
+/**
+ * @struct EngineConfig
+ * @brief An engine and its settings, parsed from a specification like "pvs:depth=4,time=100".
+ */
+struct EngineConfig {
+    const char *name;  // The specification.
+    enum EngineType type;
+    struct SearchBudget budget;
+    struct SearchOptions options;
+};
+
+/**
+ * @brief Prints the syntax of engine specifications, for the usage of the programs taking them.
+ */
+void print_engine_config_usage(FILE *file);
+
+/**
+ * @return True if the engine specification is valid.
+ */
+bool parse_engine_config(const char *specification, struct EngineConfig *config);
+
+/**
+ * @return The engine and its settings as they are stored in a game record.
+ */
+struct GameRecordPlayer engine_config_to_record_player(const struct EngineConfig *config);
+
+struct Move choose_engine_move(const struct EngineConfig *config, const struct State *state);
+
+/**
+ * @brief Plays a game between two engines from a position, drawn after `MATCH_MAX_PLIES`.
+ *
+ * @param record The record the engines' moves are appended to, and whose winner is set, or NULL.
+ *               Its moves must be the ones that lead to `state`.
+ * @return The player who won, or 0 for a draw.
+ */
+int play_game(const struct EngineConfig *player_1, const struct EngineConfig *player_2, struct State state,
+              struct GameRecord *record);
+
+uint64_t next_random(uint64_t *random_state);
+
+/**
+ * @brief Generates an opening of random legal moves from the start position.
+ *
+ * @param moves Pointer to where the `plies` moves are stored, or NULL.
+ */
+struct State generate_opening(int plies, uint64_t *random_state, EncodedMove *moves);
+
+#endif //QUORIDOR_ENGINE_MATCH_H
@@ -1,6 +1,44 @@
 #include <assert.h>
+#include <string.h>
+#include <stdatomic.h>
 #include "evaluate.h"
 #include "bitboards.h"
+#include "evaluate_simd.h"
+
+#define PLAYER_1_GOAL_ROW_MASK ((__uint128_t) 0b111111111 << 12)
+#define PLAYER_2_GOAL_ROW_MASK ((__uint128_t) 0b111111111 << 100)
+
+/**
+ * @struct DistanceCacheEntry
+ * @brief Goal distances of a single fence configuration, padded to 3 cache lines.
+ *
+ * The cache is shared by all search threads. Each entry is guarded by a sequence lock: writers
+ * make `sequence` odd while they update the entry, and readers retry as a miss if the sequence
+ * was odd or changed while they were reading. A `sequence` of 0 marks an empty entry.
+ */
+struct DistanceCacheEntry {
+    _Atomic uint32_t sequence;
+    uint64_t vertical_fences;
+    uint64_t horizontal_fences;
+    struct GoalDistances distances;
+} __attribute__((aligned(64)));
+
+_Static_assert(sizeof(struct DistanceCacheEntry) == 192, "Distance cache entries must fill 3 cache lines.");
+_Static_assert(DISTANCE_CACHE_SIZE == 1 << DISTANCE_CACHE_INDEX_BITS, "Distance cache index must match its size.");
+
+static struct DistanceCacheEntry distance_cache[DISTANCE_CACHE_SIZE];
+static _Thread_local struct DistanceCacheStats distance_cache_stats;
+
+/**
+ * Maps an index of the 11x11 bitboard to the index of the square on the 9x9 board.
+ * Border squares are never reached by a flood fill, so their value is never read.
+ */
+static const uint8_t bitboard_to_square[128] = {
+#define ROW(r) 0, r * 9 + 0, r * 9 + 1, r * 9 + 2, r * 9 + 3, r * 9 + 4, r * 9 + 5, r * 9 + 6, r * 9 + 7, r * 9 + 8, 0
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        ROW(0), ROW(1), ROW(2), ROW(3), ROW(4), ROW(5), ROW(6), ROW(7), ROW(8),
+#undef ROW
+};
 
 /**
  * @brief Calculates the shortest path length from a player's position to their goal row.
@@ -16,7 +54,7 @@
  * - The shortest path length as an integer.
  * - `NO_PATH_FOUND` if there no possible path to the goal.
  */
-int do_optimal_path_length_loop(struct Bitboards *bb, uint8_t player_row, uint8_t player_col, __uint128_t goal_row_mask) {
+int do_optimal_path_length_loop(const struct Bitboards *bb, uint8_t player_row, uint8_t player_col, __uint128_t goal_row_mask) {
 
     __uint128_t player_mask = square128(12 + player_row * 11 + player_col);
     __uint128_t previous_board, previous_goal_mask;
@@ -64,26 +102,26 @@ int do_optimal_path_length_loop(struct Bitboards *bb, uint8_t player_row, uint8_
  * This function initializes player-specific parameters and uses
  * `do_optimal_path_length_loop` to perform the calculation.
  *
- * @param state The game state.
+ * @param state Pointer to the game state.
  * @param player The player identifier (1 or 2).
  * @param bb Struct of bitmasks representing fences blocking movement in each direction.
  * @return int
  * - The shortest path length as an integer.
  * - `NO_PATH_FOUND` if no valid path exists.
  */
-int optimal_path_length_bi(struct State state, uint8_t player, struct Bitboards *bb) {
+int optimal_path_length_bi(const struct State *state, uint8_t player, const struct Bitboards *bb) {
     uint8_t player_row, player_col;
     __uint128_t goal_row_mask;
     switch (player) {
         case 1:
-            player_row = state.player_1_row;
-            player_col = state.player_1_col;
-            goal_row_mask = (__uint128_t) 0b111111111 << 12;
+            player_row = state->player_1_row;
+            player_col = state->player_1_col;
+            goal_row_mask = PLAYER_1_GOAL_ROW_MASK;
             break;
         case 2:
-            player_row = state.player_2_row;
-            player_col = state.player_2_col;
-            goal_row_mask = (__uint128_t) 0b111111111 << 100;
+            player_row = state->player_2_row;
+            player_col = state->player_2_col;
+            goal_row_mask = PLAYER_2_GOAL_ROW_MASK;
             break;
         default:
             assert(false && "Illegal player value: %d");
@@ -96,30 +134,238 @@ int optimal_path_length_bi(struct State state, uint8_t player, struct Bitboards
  * @brief Evaluates the heuristic value of the current game state based on player path differences.
  *
  * Computes the optimal path lengths for both players and returns the difference. Distances are
- * multiplied by 2 to allow us to account for whose turn it is.
+ * multiplied by 2 to allow us to account for whose turn it is. The fence bitboards are read from
+ * the state rather than being regenerated.
  *
- * @param state The game state.
+ * @param state Pointer to the game state.
  * @return int
  * - Heuristic based on how many moves sooner the current player will reach their goal assuming no
  *   fences are played.
  * - `-NO_PATH_FOUND` if the board state is invalid.
  */
-int optimal_path_dif_heuristic(struct State state) {
+int optimal_path_dif_heuristic(const struct State *state) {
 
-    struct Bitboards bb;
-    generate_bitboards(&state, &bb);
-
-    const int p1_path_length = optimal_path_length_bi(state, 1, &bb);
-    const int p2_path_length = optimal_path_length_bi(state, 2, &bb);
+    const int p1_path_length = optimal_path_length_bi(state, 1, &state->bitboards);
+    const int p2_path_length = optimal_path_length_bi(state, 2, &state->bitboards);
 
     if (p1_path_length == NO_PATH_FOUND || p2_path_length == NO_PATH_FOUND) {
         return NO_PATH_FOUND;
     }
 
-    assert(((state.player_to_move == 1 ? 2 : -2) * (p2_path_length - p1_path_length) + 1) != 0 && "path dif heuristic cannot be zero");
-    return (state.player_to_move == 1 ? 2 : -2) * (p2_path_length - p1_path_length) + 1;
+    assert(((state->player_to_move == 1 ? 2 : -2) * (p2_path_length - p1_path_length) + 1) != 0 && "path dif heuristic cannot be zero");
+    return (state->player_to_move == 1 ? 2 : -2) * (p2_path_length - p1_path_length) + 1;
 }
 
-int evaluate(struct State state) {
-    return optimal_path_dif_heuristic(state);
+int get_shortest_path_edges(const struct State *state, int player, struct ShortestPathEdges *edges) {
+    const struct Bitboards *bb = &state->bitboards;
+    const __uint128_t goal_row_mask = player == 1 ? PLAYER_1_GOAL_ROW_MASK : PLAYER_2_GOAL_ROW_MASK;
+    const uint8_t row = player == 1 ? state->player_1_row : state->player_2_row;
+    const uint8_t col = player == 1 ? state->player_1_col : state->player_2_col;
+
+    // layers[i] holds the squares at distance i from the pawn.
+    __uint128_t layers[BOARD_SIZE * BOARD_SIZE];
+    __uint128_t frontier = square128(12 + row * 11 + col);
+    __uint128_t visited = frontier;
+    int path_length = 0;
+
+    *edges = (struct ShortestPathEdges) { 0 };
+    layers[0] = frontier;
+
+    while (!(frontier & goal_row_mask)) {
+        __uint128_t board_up    = bitboard_up(frontier) & ~bb->up_fences;
+        __uint128_t board_down  = bitboard_down(frontier) & ~bb->down_fences;
+        __uint128_t board_left  = bitboard_left(frontier) & ~bb->left_fences;
+        __uint128_t board_right = bitboard_right(frontier) & ~bb->right_fences;
+
+        frontier = (board_up | board_down | board_left | board_right) & ~visited;
+
+        if (frontier == 0) {
+            return NO_PATH_FOUND;
+        }
+
+        visited |= frontier;
+        layers[++path_length] = frontier;
+    }
+
+    // Walk back from the reached goal squares, keeping the squares of each layer that have a step
+    // into a shortest path square of the next layer.
+    __uint128_t on_path = frontier & goal_row_mask;
+
+    for (int i = path_length; i > 0; i--) {
+        __uint128_t entered_up    = bitboard_up(layers[i - 1]) & ~bb->up_fences & on_path;
+        __uint128_t entered_down  = bitboard_down(layers[i - 1]) & ~bb->down_fences & on_path;
+        __uint128_t entered_left  = bitboard_left(layers[i - 1]) & ~bb->left_fences & on_path;
+        __uint128_t entered_right = bitboard_right(layers[i - 1]) & ~bb->right_fences & on_path;
+
+        edges->up |= entered_up;
+        edges->down |= entered_down;
+        edges->left |= entered_left;
+        edges->right |= entered_right;
+
+        on_path = bitboard_down(entered_up) | bitboard_up(entered_down) |
+                  bitboard_right(entered_left) | bitboard_left(entered_right);
+    }
+
+    return path_length;
+}
+
+/**
+ * @brief Fills in the distance from every square to the goal row using a flood fill.
+ *
+ * Unlike `do_optimal_path_length_loop` this expands from the goal row only and runs until the
+ * whole reachable board has been covered, so the result can be reused for any pawn position.
+ *
+ * @param bb Struct of bitmasks representing fences blocking movement in each direction.
+ * @param goal_row_mask Bitmask identifying the goal row.
+ * @param distances Array of `BOARD_SIZE * BOARD_SIZE` distances to fill in.
+ */
+static void do_goal_distance_flood_fill(const struct Bitboards *bb, __uint128_t goal_row_mask, uint8_t *distances) {
+    memset(distances, DISTANCE_UNREACHABLE, BOARD_SIZE * BOARD_SIZE);
+
+    __uint128_t visited = goal_row_mask;
+    __uint128_t frontier = goal_row_mask;
+    uint8_t distance = 0;
+
+    while (frontier != 0) {
+        for (uint64_t bits = (uint64_t) frontier; bits != 0; bits &= bits - 1) {
+            distances[bitboard_to_square[__builtin_ctzll(bits)]] = distance;
+        }
+        for (uint64_t bits = (uint64_t) (frontier >> 64); bits != 0; bits &= bits - 1) {
+            distances[bitboard_to_square[64 + __builtin_ctzll(bits)]] = distance;
+        }
+
+        __uint128_t board_up    = bitboard_up(frontier) & ~bb->up_fences;
+        __uint128_t board_down  = bitboard_down(frontier) & ~bb->down_fences;
+        __uint128_t board_left  = bitboard_left(frontier) & ~bb->left_fences;
+        __uint128_t board_right = bitboard_right(frontier) & ~bb->right_fences;
+
+        frontier = (board_up | board_down | board_left | board_right) & ~visited;
+        visited |= frontier;
+        distance++;
+    }
+}
+
+static inline struct DistanceCacheEntry *get_distance_cache_entry(const struct State *state) {
+    const uint64_t index = (state->vertical_fences * 0x9E3779B97F4A7C15ULL ^
+                            state->horizontal_fences * 0xC2B2AE3D27D4EB4FULL) >> (64 - DISTANCE_CACHE_INDEX_BITS);
+    return &distance_cache[index];
+}
+
+/**
+ * @brief Starts reading a distance cache entry.
+ *
+ * @return The sequence number to pass to `end_distance_cache_read`, or 0 if the entry does not
+ *         hold the fences of `state` (or is being written).
+ */
+static inline uint32_t begin_distance_cache_read(const struct DistanceCacheEntry *entry, const struct State *state) {
+    const uint32_t sequence = atomic_load_explicit(&entry->sequence, memory_order_acquire);
+
+    if (sequence == 0 || sequence & 1 ||
+        entry->vertical_fences != state->vertical_fences || entry->horizontal_fences != state->horizontal_fences) {
+        return 0;
+    }
+
+    return sequence;
+}
+
+/**
+ * @return True if the entry was not written to since `begin_distance_cache_read`.
+ */
+static inline bool end_distance_cache_read(const struct DistanceCacheEntry *entry, uint32_t sequence) {
+    atomic_thread_fence(memory_order_acquire);
+    return atomic_load_explicit(&entry->sequence, memory_order_relaxed) == sequence;
+}
+
+/**
+ * @brief Computes the goal distances of a state and stores them in the distance cache.
+ *
+ * If another thread is writing the entry at the same time the distances are still computed,
+ * but not stored.
+ *
+ * @param entry The cache entry for the state's fences.
+ * @param state The game state.
+ * @param distances Pointer to the struct the computed distances are written to.
+ */
+static void fill_distance_cache_entry(struct DistanceCacheEntry *entry, const struct State *state,
+                                      struct GoalDistances *distances) {
+    distance_cache_stats.misses++;
+
+    do_goal_distance_flood_fill(&state->bitboards, PLAYER_1_GOAL_ROW_MASK, distances->to_player_1_goal);
+    do_goal_distance_flood_fill(&state->bitboards, PLAYER_2_GOAL_ROW_MASK, distances->to_player_2_goal);
+
+    uint32_t sequence = atomic_load_explicit(&entry->sequence, memory_order_relaxed);
+    if (sequence & 1 || !atomic_compare_exchange_strong_explicit(&entry->sequence, &sequence, sequence + 1,
+                                                                 memory_order_acquire, memory_order_relaxed)) {
+        return;
+    }
+    atomic_thread_fence(memory_order_release);
+
+    entry->vertical_fences = state->vertical_fences;
+    entry->horizontal_fences = state->horizontal_fences;
+    entry->distances = *distances;
+
+    atomic_store_explicit(&entry->sequence, sequence + 2, memory_order_release);
+}
+
+void get_goal_distances(const struct State *state, struct GoalDistances *distances) {
+    struct DistanceCacheEntry *entry = get_distance_cache_entry(state);
+    const uint32_t sequence = begin_distance_cache_read(entry, state);
+
+    if (sequence != 0) {
+        *distances = entry->distances;
+        if (end_distance_cache_read(entry, sequence)) {
+            distance_cache_stats.hits++;
+            return;
+        }
+    }
+
+    fill_distance_cache_entry(entry, state, distances);
+}
+
+struct DistanceCacheStats get_distance_cache_stats() {
+    return distance_cache_stats;
+}
+
+void reset_distance_cache_stats() {
+    distance_cache_stats = (struct DistanceCacheStats) { 0 };
+}
+
+/**
+ * Same heuristic as `optimal_path_dif_heuristic`, but the path lengths are read from the distance
+ * cache, or computed by `dual_path_dif_heuristic` on a miss. `optimal_path_dif_heuristic` is kept
+ * as the reference implementation.
+ */
+int evaluate(const struct State *state) {
+    const int p1_square = state->player_1_row * BOARD_SIZE + state->player_1_col;
+    const int p2_square = state->player_2_row * BOARD_SIZE + state->player_2_col;
+    uint8_t p1_path_length, p2_path_length;
+
+    struct DistanceCacheEntry *entry = get_distance_cache_entry(state);
+    const uint32_t sequence = begin_distance_cache_read(entry, state);
+
+    if (sequence != 0) {
+        p1_path_length = entry->distances.to_player_1_goal[p1_square];
+        p2_path_length = entry->distances.to_player_2_goal[p2_square];
+    }
+
+    if (sequence != 0 && end_distance_cache_read(entry, sequence)) {
+        distance_cache_stats.hits++;
+    } else if (!player_1_win_check(*state) && !player_2_win_check(*state)) {
+        // Most misses are leaves whose fences are never seen again, so only the two path lengths
+        // are computed and the entry is left to `get_goal_distances`. A pawn on its goal row has a
+        // distance of 0 here, but `NO_PATH_FOUND` in the kernel, so those still fill the entry.
+        distance_cache_stats.misses++;
+        return dual_path_dif_heuristic(state);
+    } else {
+        struct GoalDistances distances;
+        fill_distance_cache_entry(entry, state, &distances);
+        p1_path_length = distances.to_player_1_goal[p1_square];
+        p2_path_length = distances.to_player_2_goal[p2_square];
+    }
+
+    if (p1_path_length == DISTANCE_UNREACHABLE || p2_path_length == DISTANCE_UNREACHABLE) {
+        return NO_PATH_FOUND;
+    }
+
+    return (state->player_to_move == 1 ? 2 : -2) * (p2_path_length - p1_path_length) + 1;
 }
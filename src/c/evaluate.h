@@ -5,14 +5,114 @@
 
 #define WINNING_SCORE 1000
 
+// Scores of positions that are won or lost within the search, rather than evaluated.
+#define is_winning_score(score) ((score) > WINNING_SCORE / 2 || (score) < -WINNING_SCORE / 2)
+
+#define DISTANCE_UNREACHABLE UINT8_MAX
+
+#define DISTANCE_CACHE_INDEX_BITS 14
+#define DISTANCE_CACHE_SIZE (1 << DISTANCE_CACHE_INDEX_BITS)  // 3 MiB with 192 byte entries
+
+/**
+ * @struct GoalDistances
+ * @brief Distance from every square of the board to each goal row.
+ *
+ * Squares are indexed by `row * BOARD_SIZE + col`. Distances ignore the pawns, so they only
+ * depend on the fences. Squares that cannot reach a goal row are `DISTANCE_UNREACHABLE`.
+ */
+struct GoalDistances {
+    uint8_t to_player_1_goal[BOARD_SIZE * BOARD_SIZE];
+    uint8_t to_player_2_goal[BOARD_SIZE * BOARD_SIZE];
+};
+
+/**
+ * @struct ShortestPathEdges
+ * @brief The union of the edges of all shortest paths of a player to their goal row.
+ *
+ * Uses the 11x11 layout of `struct Bitboards`. Each bitboard marks the destination squares of
+ * the shortest path steps taken in that direction, i.e. `up` marks the squares entered by moving
+ * up along a shortest path.
+ */
+struct ShortestPathEdges {
+    __uint128_t up;
+    __uint128_t right;
+    __uint128_t down;
+    __uint128_t left;
+};
+
+/**
+ * @struct DistanceCacheStats
+ * @brief Hit and miss counters of the distance cache.
+ *
+ * The cache is shared by all threads, but each thread counts its own hits and misses.
+ */
+struct DistanceCacheStats {
+    uint64_t hits;
+    uint64_t misses;
+};
+
 /**
  * @brief Evaluates the current game state using a heuristic function.
  *
- * For now this just wraps `optimal_path_dif_heuristic`.
+ * For now this is the path difference heuristic of `optimal_path_dif_heuristic`, with the path
+ * lengths looked up in the distance cache. On a miss they are computed with
+ * `dual_optimal_path_lengths` rather than filling in the cache entry.
  *
- * @param state The current game state.
+ * @param state Pointer to the current game state.
  * @return int A heuristic value representing how favorable the state is to the current player.
  */
-int evaluate(struct State state);
+int evaluate(const struct State *state);
+
+/**
+ * @brief Computes the shortest path length of a player with a bidirectional search from the pawn
+ * and the goal row.
+ *
+ * This is the scalar reference for `dual_optimal_path_lengths`.
+ *
+ * @return The path length, or `NO_PATH_FOUND` if there is no path or the pawn is on its goal row.
+ */
+int optimal_path_length_bi(const struct State *state, uint8_t player, const struct Bitboards *bb);
+
+/**
+ * @brief The path difference heuristic computed with `optimal_path_length_bi`, the scalar
+ * reference of `evaluate` and `dual_path_dif_heuristic`.
+ */
+int optimal_path_dif_heuristic(const struct State *state);
+
+/**
+ * @brief Gets the goal distances for the fence configuration of a state.
+ *
+ * The distances are looked up in the distance cache, and computed with a full flood fill from
+ * both goal rows (then stored in the cache) if the fence configuration has not been seen before.
+ *
+ * @param state The game state, only the fences are used.
+ * @param distances Pointer to the struct the distances are copied into.
+ */
+void get_goal_distances(const struct State *state, struct GoalDistances *distances);
+
+/**
+ * @brief Finds the edges of every shortest path from a player's pawn to their goal row.
+ *
+ * A fence changes the player's path length if and only if it cuts all of their shortest paths,
+ * so fences that cut none of these edges leave the path length unchanged. Pawns are ignored, as
+ * in the evaluation.
+ *
+ * @param state The game state.
+ * @param player The player (1 or 2).
+ * @param edges Pointer to the struct the edges are stored in.
+ * @return The shortest path length, or `NO_PATH_FOUND` if there is no path or the pawn is already
+ *         on its goal row (then no edges are stored).
+ */
+int get_shortest_path_edges(const struct State *state, int player, struct ShortestPathEdges *edges);
+
+/**
+ * @return The calling thread's hit and miss counters of the distance cache since the last reset.
+ */
+struct DistanceCacheStats get_distance_cache_stats();
+
+/**
+ * @brief Resets the calling thread's hit and miss counters of the distance cache.
+ */
+void reset_distance_cache_stats();
 
 #endif //QUORIDOR_EVALUATE_H
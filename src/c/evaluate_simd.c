@@ -0,0 +1,294 @@
+#include <stdbool.h>
+#include "evaluate_simd.h"
+#include "evaluate.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__wasm_simd128__)
+#include <wasm_simd128.h>
+#endif
+
+#define PLAYER_1_GOAL_ROW_MASK ((__uint128_t) 0b111111111 << 12)
+#define PLAYER_2_GOAL_ROW_MASK ((__uint128_t) 0b111111111 << 100)
+
+/*
+ * All kernels run the bidirectional search of `do_optimal_path_length_loop` for both players in
+ * lockstep. Each iteration expands the pawn and goal frontiers of both players together, which
+ * are independent of each other, and then checks them in the order of the scalar loop:
+ *
+ *  1. The new pawn frontier meets the old goal frontier: the path length is `length + 1`.
+ *  2. Either new frontier did not grow: there is no path.
+ *  3. The new pawn frontier meets the new goal frontier: the path length is `length + 2`.
+ *
+ * The new pawn frontier can only meet the old goal frontier if it meets the new one, so the
+ * checks are skipped in the common case where no frontier met or stopped growing. A player whose
+ * length is known keeps being expanded along with the other one, but is no longer checked.
+ */
+
+#if defined(__AVX2__)
+
+// One register holds the same side of both players' searches, player 1 in the low 128 bit lane.
+// Byte shifts of AVX2 registers stay within their 128 bit lane, so each lane is shifted as a
+// separate `__uint128_t`.
+static inline __m256i shift_left(__m256i board, int bits) {
+    return _mm256_or_si256(_mm256_slli_epi64(board, bits), _mm256_srli_epi64(_mm256_slli_si256(board, 8), 64 - bits));
+}
+
+static inline __m256i shift_right(__m256i board, int bits) {
+    return _mm256_or_si256(_mm256_srli_epi64(board, bits), _mm256_slli_epi64(_mm256_srli_si256(board, 8), 64 - bits));
+}
+
+static inline __m256i broadcast_bitboard(const __uint128_t *board) {
+    return _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *) board));
+}
+
+static inline __m256i expand(__m256i frontier, __m256i up_fences, __m256i down_fences, __m256i left_fences,
+                             __m256i right_fences) {
+    __m256i board_up    = _mm256_andnot_si256(up_fences, shift_right(frontier, 11));
+    __m256i board_down  = _mm256_andnot_si256(down_fences, shift_left(frontier, 11));
+    __m256i board_left  = _mm256_andnot_si256(left_fences, shift_right(frontier, 1));
+    __m256i board_right = _mm256_andnot_si256(right_fences, shift_left(frontier, 1));
+
+    return _mm256_or_si256(_mm256_or_si256(frontier, _mm256_or_si256(board_up, board_down)),
+                           _mm256_or_si256(board_left, board_right));
+}
+
+/**
+ * @return A mask with bit i set if the 128 bit lanes i of `a` and `b` are equal.
+ */
+static inline int lanes_equal(__m256i a, __m256i b) {
+    const int equal_words = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(a, b)));
+    return ((equal_words & 0b0011) == 0b0011) | ((equal_words & 0b1100) == 0b1100) << 1;
+}
+
+static inline int lanes_intersect(__m256i a, __m256i b) {
+    return ~lanes_equal(_mm256_and_si256(a, b), _mm256_setzero_si256()) & 0b11;
+}
+
+void dual_optimal_path_lengths(const struct State *state, int *player_1_length, int *player_2_length) {
+    const struct Bitboards *bb = &state->bitboards;
+    const __m256i up_fences = broadcast_bitboard(&bb->up_fences);
+    const __m256i down_fences = broadcast_bitboard(&bb->down_fences);
+    const __m256i left_fences = broadcast_bitboard(&bb->left_fences);
+    const __m256i right_fences = broadcast_bitboard(&bb->right_fences);
+
+    const __uint128_t boards[4] = {
+            square128(12 + state->player_1_row * 11 + state->player_1_col),
+            square128(12 + state->player_2_row * 11 + state->player_2_col),
+            PLAYER_1_GOAL_ROW_MASK,
+            PLAYER_2_GOAL_ROW_MASK,
+    };
+    __m256i pawns = _mm256_loadu_si256((const __m256i *) &boards[0]);
+    __m256i goals = _mm256_loadu_si256((const __m256i *) &boards[2]);
+
+    int lengths[2] = { NO_PATH_FOUND, NO_PATH_FOUND };
+    int path_length = 0;
+
+    // A pawn that starts on its goal row has a length of 0, the same as `NO_PATH_FOUND`.
+    int done = lanes_intersect(pawns, goals);
+
+    while (done != 0b11) {
+        const __m256i next_pawns = expand(pawns, up_fences, down_fences, left_fences, right_fences);
+        const __m256i next_goals = expand(goals, up_fences, down_fences, left_fences, right_fences);
+
+        const __m256i met = _mm256_and_si256(next_pawns, next_goals);
+        const int stalled = lanes_equal(next_pawns, pawns) | lanes_equal(next_goals, goals);
+
+        if (!_mm256_testz_si256(met, met) || stalled) {
+            const int met_goals = lanes_intersect(next_pawns, goals);
+            const int met_next_goals = lanes_intersect(next_pawns, next_goals);
+
+            for (int player = 0; player < 2; player++) {
+                const int lane = 1 << player;
+
+                if (done & lane) {
+                    continue;
+                }
+                if (met_goals & lane) {
+                    lengths[player] = path_length + 1;
+                } else if (stalled & lane) {
+                    lengths[player] = NO_PATH_FOUND;
+                } else if (met_next_goals & lane) {
+                    lengths[player] = path_length + 2;
+                } else {
+                    continue;
+                }
+                done |= lane;
+            }
+        }
+
+        pawns = next_pawns;
+        goals = next_goals;
+        path_length += 2;
+    }
+
+    *player_1_length = lengths[0];
+    *player_2_length = lengths[1];
+}
+
+const char *dual_path_instruction_set() {
+    return "AVX2";
+}
+
+#elif defined(__SSE2__) || defined(__wasm_simd128__)
+
+// A register holds a single frontier, so the four frontiers are four independent registers.
+#if defined(__SSE2__)
+
+typedef __m128i vector_t;
+
+#define vector_load(board) _mm_loadu_si128((const __m128i *) (board))
+#define vector_or(a, b) _mm_or_si128(a, b)
+#define vector_and(a, b) _mm_and_si128(a, b)
+#define vector_and_not(a, not_b) _mm_andnot_si128(not_b, a)
+#define vector_any(a) (_mm_movemask_epi8(_mm_cmpeq_epi8(a, _mm_setzero_si128())) != 0xFFFF)
+#define vector_equal(a, b) (_mm_movemask_epi8(_mm_cmpeq_epi8(a, b)) == 0xFFFF)
+
+static inline vector_t shift_left(vector_t board, int bits) {
+    return _mm_or_si128(_mm_slli_epi64(board, bits), _mm_srli_epi64(_mm_slli_si128(board, 8), 64 - bits));
+}
+
+static inline vector_t shift_right(vector_t board, int bits) {
+    return _mm_or_si128(_mm_srli_epi64(board, bits), _mm_slli_epi64(_mm_srli_si128(board, 8), 64 - bits));
+}
+
+#define INSTRUCTION_SET "SSE2"
+
+#else
+
+typedef v128_t vector_t;
+
+#define vector_load(board) wasm_v128_load(board)
+#define vector_or(a, b) wasm_v128_or(a, b)
+#define vector_and(a, b) wasm_v128_and(a, b)
+#define vector_and_not(a, not_b) wasm_v128_andnot(a, not_b)
+#define vector_any(a) wasm_v128_any_true(a)
+#define vector_equal(a, b) (!wasm_v128_any_true(wasm_v128_xor(a, b)))
+
+static inline vector_t shift_left(vector_t board, int bits) {
+    // Moves the low 64 bits into the high 64 bits, the same as `_mm_slli_si128(board, 8)`.
+    const vector_t low_to_high = wasm_i8x16_shuffle(board, wasm_i64x2_const(0, 0),
+                                                    16, 17, 18, 19, 20, 21, 22, 23, 0, 1, 2, 3, 4, 5, 6, 7);
+    return wasm_v128_or(wasm_i64x2_shl(board, bits), wasm_u64x2_shr(low_to_high, 64 - bits));
+}
+
+static inline vector_t shift_right(vector_t board, int bits) {
+    const vector_t high_to_low = wasm_i8x16_shuffle(board, wasm_i64x2_const(0, 0),
+                                                    8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23);
+    return wasm_v128_or(wasm_u64x2_shr(board, bits), wasm_i64x2_shl(high_to_low, 64 - bits));
+}
+
+#define INSTRUCTION_SET "SIMD128"
+
+#endif
+
+/**
+ * @struct VectorFences
+ * @brief The fence bitboards of `struct Bitboards`, loaded into vector registers.
+ */
+struct VectorFences {
+    vector_t up;
+    vector_t down;
+    vector_t left;
+    vector_t right;
+};
+
+static inline vector_t expand(vector_t frontier, const struct VectorFences *fences) {
+    vector_t board_up    = vector_and_not(shift_right(frontier, 11), fences->up);
+    vector_t board_down  = vector_and_not(shift_left(frontier, 11), fences->down);
+    vector_t board_left  = vector_and_not(shift_right(frontier, 1), fences->left);
+    vector_t board_right = vector_and_not(shift_left(frontier, 1), fences->right);
+
+    return vector_or(vector_or(frontier, vector_or(board_up, board_down)), vector_or(board_left, board_right));
+}
+
+void dual_optimal_path_lengths(const struct State *state, int *player_1_length, int *player_2_length) {
+    const struct Bitboards *bb = &state->bitboards;
+    const struct VectorFences fences = {
+            .up = vector_load(&bb->up_fences),
+            .down = vector_load(&bb->down_fences),
+            .left = vector_load(&bb->left_fences),
+            .right = vector_load(&bb->right_fences),
+    };
+
+    const __uint128_t boards[4] = {
+            square128(12 + state->player_1_row * 11 + state->player_1_col),
+            square128(12 + state->player_2_row * 11 + state->player_2_col),
+            PLAYER_1_GOAL_ROW_MASK,
+            PLAYER_2_GOAL_ROW_MASK,
+    };
+    vector_t pawns[2] = { vector_load(&boards[0]), vector_load(&boards[1]) };
+    vector_t goals[2] = { vector_load(&boards[2]), vector_load(&boards[3]) };
+
+    int lengths[2] = { NO_PATH_FOUND, NO_PATH_FOUND };
+    int path_length = 0;
+
+    // A pawn that starts on its goal row has a length of 0, the same as `NO_PATH_FOUND`.
+    bool done[2] = { vector_any(vector_and(pawns[0], goals[0])), vector_any(vector_and(pawns[1], goals[1])) };
+
+    while (!done[0] || !done[1]) {
+        const vector_t next_pawns[2] = { expand(pawns[0], &fences), expand(pawns[1], &fences) };
+        const vector_t next_goals[2] = { expand(goals[0], &fences), expand(goals[1], &fences) };
+
+        const vector_t met = vector_or(vector_and(next_pawns[0], next_goals[0]), vector_and(next_pawns[1], next_goals[1]));
+
+        if (vector_any(met) || vector_equal(next_pawns[0], pawns[0]) || vector_equal(next_goals[0], goals[0]) ||
+            vector_equal(next_pawns[1], pawns[1]) || vector_equal(next_goals[1], goals[1])) {
+            for (int player = 0; player < 2; player++) {
+                if (done[player]) {
+                    continue;
+                }
+                if (vector_any(vector_and(next_pawns[player], goals[player]))) {
+                    lengths[player] = path_length + 1;
+                } else if (vector_equal(next_pawns[player], pawns[player]) ||
+                           vector_equal(next_goals[player], goals[player])) {
+                    lengths[player] = NO_PATH_FOUND;
+                } else if (vector_any(vector_and(next_pawns[player], next_goals[player]))) {
+                    lengths[player] = path_length + 2;
+                } else {
+                    continue;
+                }
+                done[player] = true;
+            }
+        }
+
+        pawns[0] = next_pawns[0];
+        pawns[1] = next_pawns[1];
+        goals[0] = next_goals[0];
+        goals[1] = next_goals[1];
+        path_length += 2;
+    }
+
+    *player_1_length = lengths[0];
+    *player_2_length = lengths[1];
+}
+
+const char *dual_path_instruction_set() {
+    return INSTRUCTION_SET;
+}
+
+#else
+
+void dual_optimal_path_lengths(const struct State *state, int *player_1_length, int *player_2_length) {
+    *player_1_length = optimal_path_length_bi(state, 1, &state->bitboards);
+    *player_2_length = optimal_path_length_bi(state, 2, &state->bitboards);
+}
+
+const char *dual_path_instruction_set() {
+    return "scalar";
+}
+
+#endif
+
+int dual_path_dif_heuristic(const struct State *state) {
+    int p1_path_length, p2_path_length;
+    dual_optimal_path_lengths(state, &p1_path_length, &p2_path_length);
+
+    if (p1_path_length == NO_PATH_FOUND || p2_path_length == NO_PATH_FOUND) {
+        return NO_PATH_FOUND;
+    }
+
+    return (state->player_to_move == 1 ? 2 : -2) * (p2_path_length - p1_path_length) + 1;
+}
@@ -0,0 +1,31 @@
+#ifndef QUORIDOR_EVALUATE_SIMD_H
+#define QUORIDOR_EVALUATE_SIMD_H
+
+#include "state.h"
+
+/**
+ * @brief Computes the shortest path lengths of both players at once.
+ *
+ * The four frontiers of the two bidirectional searches (each player's pawn side and goal side)
+ * are expanded together in vector lanes: AVX2 or SSE2 on x86-64 and SIMD128 in WebAssembly
+ * builds. Without any of these the scalar `optimal_path_length_bi` is used. The results are the
+ * same as `optimal_path_length_bi` for each player.
+ *
+ * @param state The game state.
+ * @param player_1_length Set to player 1's path length, or `NO_PATH_FOUND`.
+ * @param player_2_length Set to player 2's path length, or `NO_PATH_FOUND`.
+ */
+void dual_optimal_path_lengths(const struct State *state, int *player_1_length, int *player_2_length);
+
+/**
+ * @brief Same heuristic as `optimal_path_dif_heuristic`, with both path lengths computed by
+ * `dual_optimal_path_lengths`.
+ */
+int dual_path_dif_heuristic(const struct State *state);
+
+/**
+ * @return The name of the instruction set used by `dual_optimal_path_lengths` in this build.
+ */
+const char *dual_path_instruction_set();
+
+#endif //QUORIDOR_EVALUATE_SIMD_H
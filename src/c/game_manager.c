@@ -2,23 +2,115 @@
 #include <string.h>
 #include <stdbool.h>
 #include <assert.h>
+#include <pthread.h>
 
 #include "game_manager.h"
 #include "move_generation.h"
 #include "search.h"
+#include "mcts.h"
 #include "state.h"
 #include "move.h"
 
+// Playouts of the MCTS engine per difficulty level.
+#define MCTS_PLAYOUTS_PER_DIFFICULTY 10000
+
 enum PlayerType {
     Human,
     AI,
 };
 
+enum Engine {
+    PVS,
+    MCTS,
+};
+
 struct Player {
     enum PlayerType type;
-    int difficulty;
+    enum Engine engine;
+    int difficulty;          // Search depth for PVS, tens of thousands of playouts for MCTS.
+    uint32_t time_limit_ms;  // 0 for no time limit.
 };
 
+// The PVS engine ponders while a human is thinking about their move.
+static pthread_t ponder_thread;
+static struct SearchEngine *pondering_engine = NULL;  // Of the ponder thread, NULL if there is none.
+
+static void *run_ponder_thread(void *arg) {
+    struct SearchEngine *engine = arg;
+    while (ponder(engine, 0)) {}
+    return NULL;
+}
+
+/**
+ * @brief Ponders on a background thread, on the reply predicted by the engine's search that chose
+ * `move`. Without thread support the engine does not ponder.
+ */
+static void start_ponder_thread(struct SearchEngine *engine, struct State state, struct Move move,
+                                struct Move predicted_reply) {
+    if (!start_pondering(engine, state, move, predicted_reply)) {
+        return;
+    }
+    if (pthread_create(&ponder_thread, NULL, run_ponder_thread, engine) != 0) {
+        stop_pondering(engine);
+        return;
+    }
+    pondering_engine = engine;
+}
+
+/**
+ * @brief Stops the ponder thread, if any, keeping its search for `get_best_move_pondered`.
+ */
+static void stop_ponder_thread() {
+    if (pondering_engine == NULL) {
+        return;
+    }
+    stop_pondering(pondering_engine);
+    pthread_join(ponder_thread, NULL);
+    pondering_engine = NULL;
+}
+
+enum Engine get_ai_engine() {
+    while (true) {
+        printf("Select AI engine (P = principal variation search, M = Monte Carlo tree search): ");
+
+        char line[64];
+        char choice = '\0';
+        if (!fgets(line, sizeof(line), stdin)) {
+            fprintf(stderr, "Error reading input. Try again.\n");
+            continue;
+        }
+
+        if (sscanf(line, " %c", &choice) == 1 && (choice == 'P' || choice == 'p')) {
+            return PVS;
+        }
+        if (choice == 'M' || choice == 'm') {
+            return MCTS;
+        }
+
+        printf("Invalid input. Try again.\n");
+    }
+}
+
+
+uint32_t get_ai_time_limit() {
+    while (true) {
+        printf("Enter AI time limit per move in milliseconds (0 for no limit): ");
+
+        char line[64];
+        if (!fgets(line, sizeof(line), stdin)) {
+            fprintf(stderr, "Error reading input. Try again.\n");
+            continue;
+        }
+
+        int time_limit_ms;
+        if (sscanf(line, "%d", &time_limit_ms) != 1 || time_limit_ms < 0) {
+            printf("Invalid time limit. Try again.\n");
+            continue;
+        }
+
+        return time_limit_ms;
+    }
+}
 
 struct Player get_player_info(int player_number) {
     while (true) {
@@ -42,6 +134,8 @@ struct Player get_player_info(int player_number) {
         }
 
         if (choice == 'A' || choice == 'a') {
+            const enum Engine engine = get_ai_engine();
+
             while (true) {
                 printf("Enter AI difficulty (1 to 6): ");
 
@@ -61,7 +155,8 @@ struct Player get_player_info(int player_number) {
                     continue;
                 }
 
-                return (struct Player) { .type = AI, .difficulty = difficulty };
+                return (struct Player) { .type = AI, .engine = engine, .difficulty = difficulty,
+                                         .time_limit_ms = get_ai_time_limit() };
             }
         }
 
@@ -116,7 +211,7 @@ struct Move get_move_from_user(struct State *state) {
                 continue;
             }
 
-            PawnMoves legal_pawn_moves = generate_legal_pawn_moves(*state);
+            PawnMoves legal_pawn_moves = generate_legal_pawn_moves(state);
             if ((legal_pawn_moves & pawn_move) == 0) {
                 printf("That pawn move is not valid. Try again.\n");
                 continue;
@@ -186,6 +281,9 @@ struct Move get_move_from_user(struct State *state) {
                 continue;
             }
 
+            // The hint search shares the transposition table with the engines, it must not run while pondering.
+            stop_ponder_thread();
+
             printf("AI is thinking... ");
             fflush(stdout);  // This could take a moment
 
@@ -202,12 +300,18 @@ struct Move get_move_from_user(struct State *state) {
  *  - Creates a new State.
  *  - Loops until either player wins.
  *  - For Human: prompts for move from stdin.
- *  - For AI: calls get_best_move_iterative_deepening(...)
+ *  - For AI: calls get_best_move_pondered(...) or get_best_move_mcts(...), limited by the AI's
+ *    difficulty and time limit. Each PVS player has its own engine for the whole game, which
+ *    ponders while a human opponent is thinking.
  */
 void run_game() {
     struct Player p1 = get_player_info(1);
     struct Player p2 = get_player_info(2);
 
+    struct SearchEngine *engines[2] = {
+            p1.type == AI && p1.engine == PVS ? new_search_engine() : NULL,
+            p2.type == AI && p2.engine == PVS ? new_search_engine() : NULL,
+    };
     struct State state = new_state();
 
     int winningPlayer = 0;
@@ -231,15 +335,41 @@ void run_game() {
         switch (current_player.type) {
             case Human:
                 move = get_move_from_user(&state);
+                stop_ponder_thread();
                 break;
-            case AI:
+            case AI: {
                 printf("AI is thinking... ");
                 fflush(stdout);  // This could take a moment
-                move = get_best_move_iterative_deepening(state, current_player.difficulty);
-                printf("AI chose move: ");
+                if (current_player.engine == MCTS) {
+                    struct SearchResult result = get_best_move_mcts(state, (struct SearchBudget) {
+                            .node_limit = (uint64_t) current_player.difficulty * MCTS_PLAYOUTS_PER_DIFFICULTY,
+                            .time_limit_ms = current_player.time_limit_ms,
+                    }, 1);
+                    move = result.best_move;
+                    printf("AI chose move (%llu playouts in %.0f ms): ", (unsigned long long) result.nodes,
+                           result.stats.total.time_ms);
+                    print_move(move);
+                    printf("\n");
+                    break;
+                }
+
+                struct SearchEngine *engine = engines[state.player_to_move - 1];
+                struct SearchResult result = get_best_move_pondered(engine, state, (struct SearchBudget) {
+                        .max_depth = current_player.difficulty,
+                        .time_limit_ms = current_player.time_limit_ms,
+                });
+                move = result.best_move;
+                printf("AI chose move (depth %d): ", result.depth);
                 print_move(move);
                 printf("\n");
+                print_search_stats(&result.stats);
+
+                struct Player opponent = state.player_to_move == 1 ? p2 : p1;
+                if (opponent.type == Human) {
+                    start_ponder_thread(engine, state, move, result.ponder_move);
+                }
                 break;
+            }
             default:
                 assert(false && "Invalid Player.type value");
         }
@@ -247,6 +377,9 @@ void run_game() {
         make_move(&state, &move);
     }
 
+    free_search_engine(engines[0]);
+    free_search_engine(engines[1]);
+
     printf("\n====================\n");
     printf("   Player %d wins!\n", winningPlayer);
     printf("====================\n");
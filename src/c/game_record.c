@@ -0,0 +1,82 @@
+#include <stddef.h>
+#include <string.h>
+#include "game_record.h"
+
+_Static_assert(sizeof(struct GameRecordFileHeader) == 16, "Game record file header layout is part of the file format.");
+_Static_assert(sizeof(struct GameRecordHeader) == 40, "Game record header layout is part of the file format.");
+_Static_assert(offsetof(struct GameRecord, moves) == sizeof(struct GameRecordHeader),
+               "The moves of a record are written straight after its header.");
+
+/**
+ * @return True if the file starts with a valid file header, leaving it positioned after the header.
+ */
+static bool read_game_record_file_header(FILE *file) {
+    struct GameRecordFileHeader header;
+
+    return fread(&header, sizeof(header), 1, file) == 1 &&
+           memcmp(header.magic, GAME_RECORD_MAGIC, sizeof(header.magic)) == 0 &&
+           header.version == GAME_RECORD_VERSION;
+}
+
+FILE *open_game_records(const char *path, bool append) {
+    FILE *file = fopen(path, append ? "a+b" : "rb");
+    if (file == NULL) {
+        return NULL;
+    }
+
+    // Must be set before the first read or write.
+    setvbuf(file, NULL, _IOFBF, GAME_RECORD_BUFFER_SIZE);
+
+    bool valid;
+    if (append && fseek(file, 0, SEEK_END) == 0 && ftell(file) == 0) {
+        struct GameRecordFileHeader header = { .version = GAME_RECORD_VERSION };
+        memcpy(header.magic, GAME_RECORD_MAGIC, sizeof(header.magic));
+        valid = fwrite(&header, sizeof(header), 1, file) == 1;
+    } else {
+        valid = fseek(file, 0, SEEK_SET) == 0 && read_game_record_file_header(file);
+    }
+
+    // Switching from reading to appending needs a seek in between.
+    if (!valid || (append && fseek(file, 0, SEEK_END) != 0)) {
+        fclose(file);
+        return NULL;
+    }
+
+    return file;
+}
+
+bool write_game_record(FILE *file, const struct GameRecord *record) {
+    return fwrite(record, game_record_size(record), 1, file) == 1;
+}
+
+int read_game_record(FILE *file, struct GameRecord *record) {
+    const size_t header_read = fread(&record->header, 1, sizeof(record->header), file);
+
+    if (header_read == 0 && feof(file)) {
+        return 0;
+    }
+    if (header_read != sizeof(record->header) || record->header.move_count > GAME_RECORD_MAX_MOVES ||
+        record->header.opening_moves > record->header.move_count || record->header.winner > 2) {
+        return -1;
+    }
+
+    return fread(record->moves, 1, record->header.move_count, file) == record->header.move_count ? 1 : -1;
+}
+
+bool replay_game_record(const struct GameRecord *record, struct State *state) {
+    *state = new_state();
+
+    for (int i = 0; i < record->header.move_count; i++) {
+        if (record->moves[i] >= ENCODED_MOVE_COUNT || player_1_win_check(*state) || player_2_win_check(*state)) {
+            return false;
+        }
+
+        struct Move move = decode_move(record->moves[i]);
+        if (move.moveType == None || !move_is_fully_legal(state, move)) {
+            return false;
+        }
+        make_move(state, &move);
+    }
+
+    return true;
+}
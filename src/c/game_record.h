@@ -0,0 +1,126 @@
+#ifndef QUORIDOR_GAME_RECORD_H
+#define QUORIDOR_GAME_RECORD_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include "state.h"
+#include "move.h"
+
+#define GAME_RECORD_MAGIC "QGAME\r\n\032"
+#define GAME_RECORD_VERSION 1
+
+// Longest game a record holds.
+#define GAME_RECORD_MAX_MOVES 1024
+
+// Size of the stdio buffer of the files opened by `open_game_records`.
+#define GAME_RECORD_BUFFER_SIZE (1 << 20)
+
+/**
+ * @struct GameRecordFileHeader
+ * @brief The start of a game record file, followed by any number of records.
+ *
+ * Like opening books, record files use the byte order of the engine (little endian on x86-64 and
+ * in WASM).
+ */
+struct GameRecordFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+};
+
+enum GameRecordEngine {
+    GameRecordUnknown,  // E.g. a human player.
+    GameRecordPvs,
+    GameRecordMcts,
+};
+
+// Search options of a `GameRecordPlayer`.
+#define GAME_RECORD_RELEVANT_FENCES_ONLY  0b00000001
+#define GAME_RECORD_LATE_MOVE_REDUCTIONS  0b00000010
+#define GAME_RECORD_NULL_MOVE_PRUNING     0b00000100
+#define GAME_RECORD_FUTILITY_PRUNING      0b00001000
+
+/**
+ * @struct GameRecordPlayer
+ * @brief The engine that played one side of a game, and its settings.
+ */
+struct GameRecordPlayer {
+    uint8_t engine;              // An `enum GameRecordEngine`.
+    uint8_t max_depth;
+    uint8_t options;             // `GAME_RECORD_*` option flags.
+    uint8_t aspiration_window;
+    uint32_t time_limit_ms;
+    uint64_t node_limit;
+};
+
+/**
+ * @struct GameRecordHeader
+ * @brief The start of a record, followed by `move_count` moves.
+ */
+struct GameRecordHeader {
+    uint16_t move_count;
+    uint8_t opening_moves;  // The first moves, played at random rather than chosen by the engines.
+    uint8_t winner;         // 1 or 2, or 0 if the game was drawn by its length.
+    uint32_t reserved;
+    struct GameRecordPlayer players[2];
+};
+
+/**
+ * @struct GameRecord
+ * @brief A game played from the start position.
+ *
+ * A record is stored as its header followed by one `EncodedMove` byte per move: the pawn
+ * direction, or the fence orientation and square. Only the first `game_record_size` bytes of the
+ * struct are written.
+ */
+struct GameRecord {
+    struct GameRecordHeader header;
+    EncodedMove moves[GAME_RECORD_MAX_MOVES];
+};
+
+/**
+ * @return The number of bytes a record takes in a file.
+ */
+static inline size_t game_record_size(const struct GameRecord *record) {
+    return sizeof(struct GameRecordHeader) + record->header.move_count;
+}
+
+/**
+ * @brief Opens a game record file with a large stdio buffer.
+ *
+ * A file opened for appending is created with a file header if it is empty, otherwise its header
+ * is checked. A file opened for reading is positioned at its first record.
+ *
+ * @param path Path of the file.
+ * @param append True to append records to the file, false to read them.
+ * @return The file, or NULL if it cannot be opened or is not a game record file.
+ */
+FILE *open_game_records(const char *path, bool append);
+
+/**
+ * @brief Appends a record to a file, see `open_game_records`.
+ *
+ * @return True if the record was written, the stdio buffer is not flushed.
+ */
+bool write_game_record(FILE *file, const struct GameRecord *record);
+
+/**
+ * @brief Reads the next record of a file, see `open_game_records`.
+ *
+ * @param file The file, positioned at a record.
+ * @param record Pointer to where the record is stored.
+ * @return 1 if a record was read, 0 at the end of the file, -1 if the record is truncated or invalid.
+ */
+int read_game_record(FILE *file, struct GameRecord *record);
+
+/**
+ * @brief Plays the moves of a record from the start position, checking that each is legal.
+ *
+ * @param record The record.
+ * @param state Pointer to where the final state is stored, or the state before the first illegal move.
+ * @return True if every move was legal and the game did not go on after a win.
+ */
+bool replay_game_record(const struct GameRecord *record, struct State *state);
+
+#endif //QUORIDOR_GAME_RECORD_H
@@ -0,0 +1,102 @@
+#include <stddef.h>
+#include <stdlib.h>
+
+#include "game_session.h"
+
+// The layout of the view is read by WasmUtils.ts.
+_Static_assert(offsetof(struct GameSessionView, player_1_row) == 16, "GameSessionView layout must match WasmUtils.ts.");
+_Static_assert(offsetof(struct GameSessionView, winner) == 23, "GameSessionView layout must match WasmUtils.ts.");
+_Static_assert(offsetof(struct GameSessionView, move_index) == 24, "GameSessionView layout must match WasmUtils.ts.");
+_Static_assert(offsetof(struct GameSessionView, move_count) == 28, "GameSessionView layout must match WasmUtils.ts.");
+
+/**
+ * @brief Rewrites the view of a session from its current state.
+ */
+static void update_game_session_view(struct GameSession *session) {
+    const struct State *state = &session->state;
+    struct GameSessionView *view = &session->view;
+
+    view->vertical_fences = state->vertical_fences;
+    view->horizontal_fences = state->horizontal_fences;
+    view->player_1_row = state->player_1_row;
+    view->player_1_col = state->player_1_col;
+    view->player_2_row = state->player_2_row;
+    view->player_2_col = state->player_2_col;
+    view->player_1_fence_count = state->player_1_fence_count;
+    view->player_2_fence_count = state->player_2_fence_count;
+    view->player_to_move = state->player_to_move;
+    view->winner = player_1_win_check(*state) ? 1 : player_2_win_check(*state) ? 2 : 0;
+}
+
+struct GameSession *new_game_session() {
+    struct GameSession *session = malloc(sizeof(struct GameSession));
+
+    if (session == NULL) {
+        exit(1);  // malloc failed, should probably log this somehow.
+    }
+
+    reset_game_session(session);
+    return session;
+}
+
+void reset_game_session(struct GameSession *session) {
+    session->state = new_state();
+    session->view.move_index = 0;
+    session->view.move_count = 0;
+    update_game_session_view(session);
+}
+
+bool game_session_make_move(struct GameSession *session, const EncodedMove move) {
+    struct GameSessionView *view = &session->view;
+
+    if (move >= ENCODED_MOVE_COUNT || view->winner != 0 || view->move_index >= GAME_SESSION_MAX_MOVES) {
+        return false;
+    }
+
+    struct Move decoded_move = decode_move(move);
+
+    if (decoded_move.moveType == None || !move_is_fully_legal(&session->state, decoded_move)) {
+        return false;
+    }
+
+    make_move(&session->state, &decoded_move);
+    session->moves[view->move_index] = move;
+    view->move_index++;
+    view->move_count = view->move_index;
+    update_game_session_view(session);
+    return true;
+}
+
+bool game_session_unmake_move(struct GameSession *session) {
+    return game_session_go_to_move(session, session->view.move_index - 1);
+}
+
+bool game_session_go_to_move(struct GameSession *session, const int move_index) {
+    struct GameSessionView *view = &session->view;
+
+    if (move_index < 0 || move_index > view->move_count) {
+        return false;
+    }
+
+    while (view->move_index < move_index) {
+        struct Move move = decode_move(session->moves[view->move_index]);
+        make_move(&session->state, &move);
+        view->move_index++;
+    }
+    while (view->move_index > move_index) {
+        view->move_index--;
+        struct Move move = decode_move(session->moves[view->move_index]);
+        unmake_move(&session->state, &move);
+    }
+
+    update_game_session_view(session);
+    return true;
+}
+
+const struct GameSessionView *get_game_session_view(const struct GameSession *session) {
+    return &session->view;
+}
+
+const struct State *get_game_session_state(const struct GameSession *session) {
+    return &session->state;
+}
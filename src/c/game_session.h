@@ -0,0 +1,99 @@
+#ifndef QUORIDOR_GAME_SESSION_H
+#define QUORIDOR_GAME_SESSION_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "state.h"
+#include "move.h"
+
+#define GAME_SESSION_MAX_MOVES 1024
+
+/**
+ * @struct GameSessionView
+ * @brief The current position of a session, laid out for reading from JavaScript without any
+ * conversion.
+ *
+ * The view is rewritten after every change to the session, so it always matches the move at
+ * `move_index`. The layout is read by WasmUtils.ts.
+ */
+struct GameSessionView {
+    uint64_t vertical_fences;
+    uint64_t horizontal_fences;
+    uint8_t player_1_row;
+    uint8_t player_1_col;
+    uint8_t player_2_row;
+    uint8_t player_2_col;
+    uint8_t player_1_fence_count;
+    uint8_t player_2_fence_count;
+    uint8_t player_to_move;
+    uint8_t winner;      // 0 while the game is not over.
+    int32_t move_index;  // Number of moves of the history that have been made.
+    int32_t move_count;  // Number of moves in the history.
+};
+
+/**
+ * @struct GameSession
+ * @brief A game along with its move history, kept in place so that moves can be made, taken back
+ * and replayed without copying the state in and out of the engine.
+ *
+ * Moves after `move_index` are kept until a different move is made, so that a game can be stepped
+ * back and forth through. Legal moves are not generated when the session changes, they are only
+ * generated on request with `generate_all_legal_moves`.
+ */
+struct GameSession {
+    struct GameSessionView view;
+    struct State state;
+    EncodedMove moves[GAME_SESSION_MAX_MOVES];
+};
+
+/**
+ * @brief Allocates a session holding a new game, exits if the allocation fails.
+ */
+struct GameSession *new_game_session();
+
+/**
+ * @brief Starts a new game in a session, clearing its history.
+ */
+void reset_game_session(struct GameSession *session);
+
+/**
+ * @brief Makes a move in the current position of a session.
+ *
+ * The moves of the history after the current position are replaced by the move.
+ *
+ * @param session The session.
+ * @param move The move, encoded as by `encode_move`.
+ *
+ * @return True if the move was made, false if it is not legal, the game is over or the history is full.
+ */
+bool game_session_make_move(struct GameSession *session, EncodedMove move);
+
+/**
+ * @brief Takes back the last move made in a session, the history is kept.
+ *
+ * @return True if a move was taken back, false if the session is at the start of the game.
+ */
+bool game_session_unmake_move(struct GameSession *session);
+
+/**
+ * @brief Moves a session to the position after the given number of moves of its history, by
+ * making or taking back moves in place.
+ *
+ * @param session The session.
+ * @param move_index The number of moves, from 0 (the start of the game) to the length of the history.
+ *
+ * @return True if the session moved to the position, false if `move_index` is out of range.
+ */
+bool game_session_go_to_move(struct GameSession *session, int move_index);
+
+/**
+ * @return The view of the current position of a session.
+ */
+const struct GameSessionView *get_game_session_view(const struct GameSession *session);
+
+/**
+ * @return The current state of a session, e.g. to search it.
+ */
+const struct State *get_game_session_state(const struct GameSession *session);
+
+#endif //QUORIDOR_GAME_SESSION_H
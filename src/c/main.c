@@ -1,8 +1,16 @@
 #include <stdio.h>
+#include <stdlib.h>
 #include <stdbool.h>
 #include "game_manager.h"
+#include "opening_book.h"
 
-int main(void) {
+int main(int argc, char **argv) {
+
+    // The AI plays from an opening book if one is given.
+    if (argc > 1 && !load_opening_book(argv[1])) {
+        fprintf(stderr, "Cannot load the opening book %s.\n", argv[1]);
+        return EXIT_FAILURE;
+    }
 
     while (true) {
         run_game();
@@ -0,0 +1,357 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "state.h"
+#include "move.h"
+#include "engine_match.h"
+
+#define MATCH_MAX_OPENINGS 4096
+#define MATCH_MAX_WORKERS 256
+
+// Number of games between two progress reports.
+#define MATCH_REPORT_INTERVAL 20
+
+/**
+ * @struct MatchScore
+ * @brief Results of the first engine.
+ */
+struct MatchScore {
+    int wins;
+    int losses;
+    int draws;
+};
+
+/**
+ * @struct Sprt
+ * @brief A sequential probability ratio test of H0: elo = elo0 against H1: elo = elo1.
+ */
+struct Sprt {
+    bool enabled;
+    double elo0;
+    double elo1;
+    double alpha;
+    double beta;
+};
+
+static void print_usage(const char *program) {
+    fprintf(stderr, "Usage: %s --engine1 <engine> --engine2 <engine> [options]\n", program);
+    print_engine_config_usage(stderr);
+    fprintf(stderr, "Options:\n");
+    fprintf(stderr, "  --games <n>                  Games to play, rounded up to pairs (default 1000).\n");
+    fprintf(stderr, "  --concurrency <n>            Games played at once (default: one per core).\n");
+    fprintf(stderr, "  --openings <file>            Opening positions, one per line as comma separated moves.\n");
+    fprintf(stderr, "  --random-plies <n>           Random moves of generated openings (default 4).\n");
+    fprintf(stderr, "  --seed <n>                   Seed of the opening order and generated openings.\n");
+    fprintf(stderr, "  --sprt <elo0> <elo1> [<alpha> <beta>]\n");
+    fprintf(stderr, "                               Stop once the test of elo0 against elo1 is decided\n");
+    fprintf(stderr, "                               (default alpha and beta 0.05).\n");
+    fprintf(stderr, "Each opening is played twice, with the engines swapping sides.\n");
+}
+
+/**
+ * @brief Plays the moves of an opening from the start position.
+ *
+ * @return False if one of the moves is invalid.
+ */
+static bool load_opening(const char *moves, struct State *state) {
+    const char *text = moves + strspn(moves, ", \t");
+    *state = new_state();
+
+    while (*text != '\0' && *text != '\n' && *text != '\r') {
+        struct Move move;
+        const int consumed = parse_move(text, &move);
+
+        if (consumed == 0 || player_1_win_check(*state) || player_2_win_check(*state) ||
+            !move_is_fully_legal(state, move)) {
+            return false;
+        }
+
+        make_move(state, &move);
+        text += consumed;
+        text += strspn(text, ", \t");
+    }
+
+    return true;
+}
+
+/**
+ * @brief Reads the openings of a file, skipping empty lines.
+ *
+ * @return The number of openings read, or -1 if the file cannot be read or has an invalid opening.
+ */
+static int read_openings(const char *path, struct State *openings) {
+    FILE *file = fopen(path, "r");
+    if (file == NULL) {
+        return -1;
+    }
+
+    char line[4096];
+    int count = 0, line_number = 0;
+
+    while (count < MATCH_MAX_OPENINGS && fgets(line, sizeof(line), file) != NULL) {
+        line_number++;
+
+        if (line[strspn(line, " \t\r\n")] == '\0') {
+            continue;
+        }
+        if (!load_opening(line, &openings[count])) {
+            fprintf(stderr, "Invalid opening on line %d of %s.\n", line_number, path);
+            fclose(file);
+            return -1;
+        }
+        count++;
+    }
+
+    fclose(file);
+    return count;
+}
+
+/**
+ * @return The Elo difference giving an expected score. Scores of 0 or 1 have an infinite
+ *         difference, they are clamped to keep the output finite.
+ */
+static double score_to_elo(double score) {
+    const double clamped = fmin(fmax(score, 1e-3), 1 - 1e-3);
+    return -400 * log10(1 / clamped - 1);
+}
+
+/**
+ * @brief Computes the Elo difference of a score and its 95% confidence interval.
+ *
+ * @param score The results.
+ * @param elo Pointer to where the Elo difference is stored.
+ * @param error Pointer to where the half width of the interval is stored.
+ */
+static void compute_elo(const struct MatchScore *score, double *elo, double *error) {
+    const double games = score->wins + score->losses + score->draws;
+    const double mean = (score->wins + 0.5 * score->draws) / games;
+    const double variance = (score->wins * (1 - mean) * (1 - mean) + score->draws * (0.5 - mean) * (0.5 - mean) +
+                             score->losses * mean * mean) / games;
+    const double deviation = sqrt(variance / games);
+
+    *elo = score_to_elo(mean);
+    *error = (score_to_elo(mean + 1.96 * deviation) - score_to_elo(mean - 1.96 * deviation)) / 2;
+}
+
+/**
+ * @brief Computes the log-likelihood ratio of an SPRT, with the normal approximation of the score
+ * distribution.
+ */
+static double compute_sprt_llr(const struct MatchScore *score, const struct Sprt *sprt) {
+    const double games = score->wins + score->losses + score->draws;
+    const double mean = (score->wins + 0.5 * score->draws) / games;
+    const double variance = (score->wins * (1 - mean) * (1 - mean) + score->draws * (0.5 - mean) * (0.5 - mean) +
+                             score->losses * mean * mean) / games;
+
+    if (variance <= 0) {
+        return 0;
+    }
+
+    const double score0 = 1 / (1 + pow(10, -sprt->elo0 / 400));
+    const double score1 = 1 / (1 + pow(10, -sprt->elo1 / 400));
+
+    return (score1 - score0) * (2 * mean - score0 - score1) / (2 * variance / games);
+}
+
+static void print_progress(const struct MatchScore *score, const struct Sprt *sprt) {
+    double elo, error;
+    compute_elo(score, &elo, &error);
+
+    printf("Games %d: +%d -%d =%d, Elo %.1f +/- %.1f", score->wins + score->losses + score->draws, score->wins,
+           score->losses, score->draws, elo, error);
+    if (sprt->enabled) {
+        printf(", LLR %.2f [%.2f, %.2f]", compute_sprt_llr(score, sprt), log(sprt->beta / (1 - sprt->alpha)),
+               log((1 - sprt->beta) / sprt->alpha));
+    }
+    printf("\n");
+    fflush(stdout);
+}
+
+/**
+ * @brief Plays every `stride`-th game of the match from `first_game` on, writing one line per game
+ * to `output`: the game index and the result of the first engine (1, 0.5 or 0, written as 2, 1 or 0).
+ */
+static void run_worker(const struct EngineConfig *engines, const struct State *openings, int opening_count,
+                       const int *opening_order, int game_count, int first_game, int stride, int output) {
+    for (int game = first_game; game < game_count; game += stride) {
+        // Games come in pairs from the same opening, the first engine plays player 1 in the first one.
+        const int first_engine_player = game % 2 == 0 ? 1 : 2;
+        const struct State opening = openings[opening_order[game / 2 % opening_count]];
+        const int winner = first_engine_player == 1 ? play_game(&engines[0], &engines[1], opening, NULL)
+                                                    : play_game(&engines[1], &engines[0], opening, NULL);
+
+        char line[32];
+        const int length = snprintf(line, sizeof(line), "%d %d\n", game,
+                                    winner == 0 ? 1 : winner == first_engine_player ? 2 : 0);
+        if (write(output, line, length) != length) {
+            exit(EXIT_FAILURE);
+        }
+    }
+}
+
+int main(int argc, char **argv) {
+    struct EngineConfig engines[2];
+    bool engine_set[2] = { false, false };
+    struct Sprt sprt = { .alpha = 0.05, .beta = 0.05 };
+    const char *openings_path = NULL;
+    long game_count = 1000, concurrency = sysconf(_SC_NPROCESSORS_ONLN), random_plies = 4, seed = 1;
+
+    for (int i = 1; i < argc; i++) {
+        const bool has_value = i + 1 < argc;
+
+        if ((strcmp(argv[i], "--engine1") == 0 || strcmp(argv[i], "--engine2") == 0) && has_value) {
+            const int engine = argv[i][8] - '1';
+            engine_set[engine] = parse_engine_config(argv[++i], &engines[engine]);
+            if (!engine_set[engine]) {
+                fprintf(stderr, "Invalid engine \"%s\".\n", argv[i]);
+                return EXIT_FAILURE;
+            }
+        } else if (strcmp(argv[i], "--games") == 0 && has_value) {
+            game_count = atol(argv[++i]);
+        } else if (strcmp(argv[i], "--concurrency") == 0 && has_value) {
+            concurrency = atol(argv[++i]);
+        } else if (strcmp(argv[i], "--openings") == 0 && has_value) {
+            openings_path = argv[++i];
+        } else if (strcmp(argv[i], "--random-plies") == 0 && has_value) {
+            random_plies = atol(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && has_value) {
+            seed = atol(argv[++i]);
+        } else if (strcmp(argv[i], "--sprt") == 0 && i + 2 < argc) {
+            sprt.enabled = true;
+            sprt.elo0 = atof(argv[++i]);
+            sprt.elo1 = atof(argv[++i]);
+            if (i + 2 < argc && argv[i + 1][0] != '-') {
+                sprt.alpha = atof(argv[++i]);
+                sprt.beta = atof(argv[++i]);
+            }
+        } else {
+            print_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (!engine_set[0] || !engine_set[1] || game_count <= 0 || concurrency <= 0 || random_plies < 0 ||
+        (sprt.enabled && (sprt.elo1 <= sprt.elo0 || sprt.alpha <= 0 || sprt.alpha >= 1 || sprt.beta <= 0 ||
+                          sprt.beta >= 1))) {
+        print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    game_count += game_count % 2;
+    concurrency = concurrency < game_count ? concurrency : game_count;
+    concurrency = concurrency < MATCH_MAX_WORKERS ? concurrency : MATCH_MAX_WORKERS;
+
+    struct State *openings = malloc(sizeof(struct State) * MATCH_MAX_OPENINGS);
+    int *opening_order = malloc(sizeof(int) * MATCH_MAX_OPENINGS);
+    if (openings == NULL || opening_order == NULL) {
+        exit(1);  // malloc failed, should probably log this somehow.
+    }
+
+    uint64_t random_state = 0x9E3779B97F4A7C15ULL * (uint64_t) (seed + 1);
+    int opening_count;
+
+    if (openings_path != NULL) {
+        opening_count = read_openings(openings_path, openings);
+        if (opening_count <= 0) {
+            fprintf(stderr, "No openings read from %s.\n", openings_path);
+            return EXIT_FAILURE;
+        }
+    } else {
+        opening_count = game_count / 2 < MATCH_MAX_OPENINGS ? (int) (game_count / 2) : MATCH_MAX_OPENINGS;
+        for (int i = 0; i < opening_count; i++) {
+            openings[i] = generate_opening(random_plies, &random_state, NULL);
+        }
+    }
+
+    // The openings are played in a random order, so that a short match does not only play the first ones.
+    for (int i = 0; i < opening_count; i++) {
+        opening_order[i] = i;
+    }
+    for (int i = opening_count - 1; i > 0; i--) {
+        const int j = (int) (next_random(&random_state) % (i + 1));
+        const int swap = opening_order[i];
+        opening_order[i] = opening_order[j];
+        opening_order[j] = swap;
+    }
+
+    printf("%s against %s, %ld games, %d openings, %ld at once\n", engines[0].name, engines[1].name, game_count,
+           opening_count, concurrency);
+    fflush(stdout);
+
+    // Games are played in worker processes rather than threads, as the transposition table and
+    // other engine state are global.
+    int results[2];
+    pid_t workers[MATCH_MAX_WORKERS];
+    if (pipe(results) != 0) {
+        perror("pipe");
+        return EXIT_FAILURE;
+    }
+
+    for (int i = 0; i < concurrency; i++) {
+        workers[i] = fork();
+
+        if (workers[i] < 0) {
+            perror("fork");
+            return EXIT_FAILURE;
+        }
+        if (workers[i] == 0) {
+            close(results[0]);
+            run_worker(engines, openings, opening_count, opening_order, (int) game_count, i, (int) concurrency,
+                       results[1]);
+            _exit(EXIT_SUCCESS);
+        }
+    }
+    close(results[1]);
+
+    // Lines of at most PIPE_BUF bytes are written atomically, so the workers' lines do not interleave.
+    FILE *input = fdopen(results[0], "r");
+    struct MatchScore score = { 0 };
+    int game, result;
+    const char *verdict = NULL;
+
+    while (verdict == NULL && fscanf(input, "%d %d", &game, &result) == 2) {
+        score.wins += result == 2;
+        score.draws += result == 1;
+        score.losses += result == 0;
+
+        const int played = score.wins + score.losses + score.draws;
+        if (played % MATCH_REPORT_INTERVAL == 0) {
+            print_progress(&score, &sprt);
+        }
+
+        if (sprt.enabled) {
+            const double llr = compute_sprt_llr(&score, &sprt);
+
+            if (llr >= log((1 - sprt.beta) / sprt.alpha)) {
+                verdict = "H1 accepted";
+            } else if (llr <= log(sprt.beta / (1 - sprt.alpha))) {
+                verdict = "H0 accepted";
+            }
+        }
+    }
+
+    if (verdict != NULL) {
+        for (int i = 0; i < concurrency; i++) {
+            kill(workers[i], SIGTERM);
+        }
+    }
+    for (int i = 0; i < concurrency; i++) {
+        waitpid(workers[i], NULL, 0);
+    }
+    fclose(input);
+
+    printf("\nFinal: ");
+    print_progress(&score, &sprt);
+    if (sprt.enabled) {
+        printf("SPRT (elo0 %.1f, elo1 %.1f): %s\n", sprt.elo0, sprt.elo1, verdict != NULL ? verdict : "inconclusive");
+    }
+
+    free(openings);
+    free(opening_order);
+    return EXIT_SUCCESS;
+}
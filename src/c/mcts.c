@@ -0,0 +1,520 @@
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "mcts.h"
+#include "move_generation.h"
+#include "evaluate.h"
+#include "endgame.h"
+#include "opening_book.h"
+
+// Results are stored in fixed point, so that they can be added atomically.
+#define MCTS_VALUE_SCALE (1 << 16)
+
+#define MCTS_EXPLORATION 1.4f
+#define MCTS_VIRTUAL_LOSS 1
+
+// A leaf is expanded once it has been visited this many times, the root before the first playout.
+#define MCTS_EXPAND_VISITS 2
+
+// Visits from which a fenceless endgame in the tree is solved, solving new fences costs as much as
+// tens of playouts. Rollouts only use fences already solved.
+#define MCTS_ENDGAME_SOLVE_VISITS 64
+
+// Fences cutting a shortest path of the opponent kept as children of a node, at most.
+#define MCTS_MAX_FENCE_CHILDREN 32
+
+// Prior weight of pawn moves towards the goal, relative to the other moves.
+#define MCTS_ADVANCE_PRIOR_WEIGHT 4.0f
+
+#define MCTS_ROLLOUT_PLIES 6
+
+// Rollout moves try a fence with a chance of 1 in this, if the player has any left.
+#define MCTS_ROLLOUT_FENCE_CHANCE 4
+
+// Rollout pawn moves are random with a chance of 1 in this, otherwise towards the goal.
+#define MCTS_ROLLOUT_RANDOM_PAWN_CHANCE 8
+
+// Path difference score (see `evaluate`) at which a position counts as three quarters won.
+#define MCTS_EVALUATION_SCALE 8.0f
+
+// Playouts between two checks of the clock by each thread.
+#define MCTS_CLOCK_CHECK_INTERVAL 64
+
+enum MctsExpansion {
+    MctsLeaf,
+    MctsExpanding,
+    MctsExpanded,
+};
+
+/**
+ * @struct MctsTree
+ * @brief The search tree and budget shared by the threads of a search.
+ */
+struct MctsTree {
+    struct MctsNode *nodes;
+    _Atomic uint32_t node_count;
+    struct State root_state;
+    atomic_bool stop;
+    _Atomic uint64_t started_playouts;
+    _Atomic uint64_t completed_playouts;
+    _Atomic int max_depth;
+    uint64_t playout_limit;
+    double deadline_ms;
+};
+
+/**
+ * @struct MctsThread
+ * @brief A thread running playouts, the main thread has one too.
+ */
+struct MctsThread {
+    pthread_t thread;
+    struct MctsTree *tree;
+    uint64_t random_state;
+};
+
+static double get_time_ms(void) {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (double) time.tv_sec * 1000.0 + (double) time.tv_nsec / 1e6;
+}
+
+static inline uint64_t next_random(uint64_t *random_state) {
+    *random_state ^= *random_state << 13;
+    *random_state ^= *random_state >> 7;
+    *random_state ^= *random_state << 17;
+    return *random_state;
+}
+
+/**
+ * @return The result of the player to move in a fenceless endgame, 1 for a win, -1 for a loss.
+ */
+static float endgame_result(const struct State *state) {
+    struct Move ignored_move;
+    const int outcome = probe_endgame(state, &ignored_move);
+
+    return outcome == ENDGAME_DRAW ? 0.0f : outcome > 0 ? 1.0f : -1.0f;
+}
+
+/**
+ * @brief Picks the bit of a mask with the given rank, counting from the lowest set bit.
+ */
+static inline int select_set_bit(uint64_t bits, int rank) {
+    for (int i = 0; i < rank; i++) {
+        bits &= bits - 1;
+    }
+    return __builtin_ctzll(bits);
+}
+
+/**
+ * @brief Chooses the move of a rollout.
+ *
+ * Sometimes tries a random fence on the opponent's shortest path, which is only played if it is
+ * legal. The legality check rarely needs a path search, see `move_is_fully_legal`. Otherwise the
+ * pawn moves down the distance field towards its goal, or at random.
+ */
+static struct Move choose_rollout_move(struct State *state, uint64_t *random_state) {
+    const int player = state->player_to_move;
+    const int fence_count = player == 1 ? state->player_1_fence_count : state->player_2_fence_count;
+
+    if (fence_count > 0 && next_random(random_state) % MCTS_ROLLOUT_FENCE_CHANCE == 0) {
+        FenceMoves vertical_fences, horizontal_fences;
+        find_fences_cutting_shortest_paths(state, 3 - player, &vertical_fences, &horizontal_fences);
+        vertical_fences &= generate_pseudo_legal_vertical_fence_moves(state);
+        horizontal_fences &= generate_pseudo_legal_horizontal_fence_moves(state);
+
+        const int vertical_count = __builtin_popcountll(vertical_fences);
+        const int count = vertical_count + __builtin_popcountll(horizontal_fences);
+
+        if (count > 0) {
+            const int rank = (int) (next_random(random_state) % count);
+            const struct Move move = rank < vertical_count
+                                     ? (struct Move) { .moveType = VerticalFence,
+                                                       .move.fenceMove = square64(select_set_bit(vertical_fences, rank)) }
+                                     : (struct Move) { .moveType = HorizontalFence,
+                                                       .move.fenceMove = square64(select_set_bit(horizontal_fences,
+                                                                                                 rank - vertical_count)) };
+
+            if (move_is_fully_legal(state, move)) {
+                return move;
+            }
+        }
+    }
+
+    const PawnMoves pawn_moves = generate_legal_pawn_moves(state);
+
+    if (next_random(random_state) % MCTS_ROLLOUT_RANDOM_PAWN_CHANCE == 0) {
+        const int rank = (int) (next_random(random_state) % __builtin_popcount(pawn_moves));
+        return (struct Move) { .moveType = Pawn, .move.pawnMove = 1 << select_set_bit(pawn_moves, rank) };
+    }
+
+    struct GoalDistances distances;
+    get_goal_distances(state, &distances);
+    const uint8_t *own_distances = player == 1 ? distances.to_player_1_goal : distances.to_player_2_goal;
+    const int row = player == 1 ? state->player_1_row : state->player_2_row;
+    const int col = player == 1 ? state->player_1_col : state->player_2_col;
+
+    // Ties between the closest moves are broken at random, by the order they are scanned in.
+    const int first = (int) (next_random(random_state) % PAWN_MOVE_TYPE_COUNT);
+    int best_move_index = -1, best_distance = INT32_MAX;
+
+    for (int i = 0; i < PAWN_MOVE_TYPE_COUNT; i++) {
+        const int move_index = (first + i) % PAWN_MOVE_TYPE_COUNT;
+
+        if (!(pawn_moves & (1 << move_index))) {
+            continue;
+        }
+
+        const int distance = own_distances[(row + pawn_move_row_offsets[move_index]) * BOARD_SIZE + col +
+                                           pawn_move_col_offsets[move_index]];
+        if (distance < best_distance) {
+            best_distance = distance;
+            best_move_index = move_index;
+        }
+    }
+
+    return (struct Move) { .moveType = Pawn, .move.pawnMove = 1 << best_move_index };
+}
+
+/**
+ * @brief Plays a short rollout from a leaf and scores the position it ends in.
+ *
+ * @return The result for the player to move at the leaf, from -1 (lost) to 1 (won).
+ */
+static float run_rollout(struct State state, uint64_t *random_state) {
+    const int player = state.player_to_move;
+
+    for (int ply = 0;; ply++) {
+        if (player_1_win_check(state) || player_2_win_check(state)) {
+            // The player who just moved has won.
+            return state.player_to_move == player ? -1.0f : 1.0f;
+        }
+
+        float result;
+        if (is_fenceless_endgame(state) && is_endgame_solved(&state)) {
+            result = endgame_result(&state);
+        } else if (ply == MCTS_ROLLOUT_PLIES) {
+            result = tanhf((float) evaluate(&state) / MCTS_EVALUATION_SCALE);
+        } else {
+            struct Move move = choose_rollout_move(&state, random_state);
+            make_move(&state, &move);
+            continue;
+        }
+
+        return state.player_to_move == player ? result : -result;
+    }
+}
+
+/**
+ * @brief Sorts fences by how much they lengthen the opponent's shortest path, most first, so that
+ * a node with more than `MCTS_MAX_FENCE_CHILDREN` of them keeps the strongest ones.
+ *
+ * @param state The state the fences are played in, the fences must be fully legal.
+ * @param fences The fences, sorted in place. Fences lengthening the path as much keep their order.
+ * @param fence_count Number of fences.
+ */
+static void sort_fences_by_path_lengthening(const struct State *state, EncodedMove *fences, int fence_count) {
+    const int opponent = 3 - state->player_to_move;
+    int path_lengths[2 * FENCE_BIT_BOARD_WIDTH * FENCE_BIT_BOARD_WIDTH];
+    struct State child = *state;
+
+    for (int i = 0; i < fence_count; i++) {
+        struct Move move = decode_move(fences[i]);
+        make_move(&child, &move);
+        path_lengths[i] = optimal_path_length_bi(&child, opponent, &child.bitboards);
+        unmake_move(&child, &move);
+    }
+
+    // Insertion sort, there are at most a hundred or so fences and only a few nodes need it.
+    for (int i = 1; i < fence_count; i++) {
+        const EncodedMove fence = fences[i];
+        const int path_length = path_lengths[i];
+        int j = i;
+
+        for (; j > 0 && path_lengths[j - 1] < path_length; j--) {
+            fences[j] = fences[j - 1];
+            path_lengths[j] = path_lengths[j - 1];
+        }
+        fences[j] = fence;
+        path_lengths[j] = path_length;
+    }
+}
+
+/**
+ * @brief Creates the children of a node.
+ *
+ * Fences are limited to `MCTS_MAX_FENCE_CHILDREN` cutting a shortest path of the opponent, those
+ * lengthening it the most when there are more.
+ *
+ * @return False if the arena is full, the node is then left as a leaf.
+ */
+static bool expand_node(struct MctsTree *tree, struct MctsNode *node, const struct State *state) {
+    const int player = state->player_to_move;
+    const PawnMoves pawn_moves = generate_legal_pawn_moves(state);
+    FenceMoves vertical_fences = 0, horizontal_fences = 0;
+
+    if ((player == 1 ? state->player_1_fence_count : state->player_2_fence_count) > 0) {
+        FenceMoves path_vertical_fences, path_horizontal_fences;
+        find_fences_cutting_shortest_paths(state, 3 - player, &path_vertical_fences, &path_horizontal_fences);
+        generate_fully_legal_fence_moves(state, &vertical_fences, &horizontal_fences);
+        vertical_fences &= path_vertical_fences;
+        horizontal_fences &= path_horizontal_fences;
+    }
+
+    EncodedMove fences[2 * FENCE_BIT_BOARD_WIDTH * FENCE_BIT_BOARD_WIDTH];
+    int fence_count = 0;
+    for (FenceMoves bits = vertical_fences; bits != 0; bits &= bits - 1) {
+        fences[fence_count++] = ENCODED_VERTICAL_FENCE_OFFSET + __builtin_ctzll(bits);
+    }
+    for (FenceMoves bits = horizontal_fences; bits != 0; bits &= bits - 1) {
+        fences[fence_count++] = ENCODED_HORIZONTAL_FENCE_OFFSET + __builtin_ctzll(bits);
+    }
+    if (fence_count > MCTS_MAX_FENCE_CHILDREN) {
+        sort_fences_by_path_lengthening(state, fences, fence_count);
+        fence_count = MCTS_MAX_FENCE_CHILDREN;
+    }
+
+    const int pawn_count = __builtin_popcount(pawn_moves);
+
+    const uint32_t first_child = atomic_fetch_add(&tree->node_count, pawn_count + fence_count);
+    if (first_child + pawn_count + fence_count > MCTS_ARENA_SIZE) {
+        return false;
+    }
+
+    struct GoalDistances distances;
+    get_goal_distances(state, &distances);
+    const uint8_t *own_distances = player == 1 ? distances.to_player_1_goal : distances.to_player_2_goal;
+    const int row = player == 1 ? state->player_1_row : state->player_2_row;
+    const int col = player == 1 ? state->player_1_col : state->player_2_col;
+
+    struct MctsNode *child = &tree->nodes[first_child];
+    float total_weight = 0;
+
+    for (PawnMoves bits = pawn_moves; bits != 0; bits &= bits - 1, child++) {
+        const int move_index = __builtin_ctz(bits);
+        const int distance = own_distances[(row + pawn_move_row_offsets[move_index]) * BOARD_SIZE + col +
+                                           pawn_move_col_offsets[move_index]];
+
+        *child = (struct MctsNode) {
+                .move = ENCODED_PAWN_MOVE_OFFSET + move_index,
+                .prior = distance < own_distances[row * BOARD_SIZE + col] ? MCTS_ADVANCE_PRIOR_WEIGHT : 1.0f,
+        };
+        total_weight += child->prior;
+    }
+
+    for (int i = 0; i < fence_count; i++) {
+        *child++ = (struct MctsNode) { .move = fences[i], .prior = 1.0f };
+    }
+    total_weight += (float) fence_count;
+
+    for (int i = 0; i < pawn_count + fence_count; i++) {
+        tree->nodes[first_child + i].prior /= total_weight;
+    }
+
+    node->first_child = first_child;
+    node->child_count = pawn_count + fence_count;
+    atomic_store_explicit(&node->expansion, MctsExpanded, memory_order_release);
+    return true;
+}
+
+/**
+ * @brief Selects the child of a node with the highest PUCT score.
+ */
+static uint32_t select_child(const struct MctsTree *tree, const struct MctsNode *node) {
+    const int parent_visits = atomic_load_explicit(&node->visits, memory_order_relaxed);
+    const float exploration = MCTS_EXPLORATION * sqrtf((float) (parent_visits > 1 ? parent_visits : 1));
+    uint32_t best_child = node->first_child;
+    float best_score = -INFINITY;
+
+    for (uint32_t i = node->first_child; i < node->first_child + node->child_count; i++) {
+        const struct MctsNode *child = &tree->nodes[i];
+        const int visits = atomic_load_explicit(&child->visits, memory_order_relaxed);
+        const int64_t value = atomic_load_explicit(&child->value, memory_order_relaxed);
+
+        // Unvisited moves are assumed to be even.
+        const float mean = visits > 0 ? (float) value / ((float) MCTS_VALUE_SCALE * (float) visits) : 0.0f;
+        const float score = mean + exploration * child->prior / (float) (1 + visits);
+
+        if (score > best_score) {
+            best_score = score;
+            best_child = i;
+        }
+    }
+
+    return best_child;
+}
+
+static inline void add_virtual_loss(struct MctsNode *node) {
+    atomic_fetch_add_explicit(&node->visits, MCTS_VIRTUAL_LOSS, memory_order_relaxed);
+    atomic_fetch_sub_explicit(&node->value, (int64_t) MCTS_VIRTUAL_LOSS * MCTS_VALUE_SCALE, memory_order_relaxed);
+}
+
+/**
+ * @brief Runs a playout: selects a path down the tree, expands or evaluates its leaf and adds the
+ * result to the nodes of the path, replacing their virtual losses.
+ */
+static void run_playout(struct MctsTree *tree, uint64_t *random_state) {
+    struct State state = tree->root_state;
+    uint32_t path[MCTS_MAX_DEPTH + 1];
+    int depth = 0;
+    float result;
+
+    path[0] = 0;
+    add_virtual_loss(&tree->nodes[0]);
+
+    while (true) {
+        struct MctsNode *node = &tree->nodes[path[depth]];
+
+        if (player_1_win_check(state) || player_2_win_check(state)) {
+            result = -1.0f;
+            break;
+        }
+        if (is_fenceless_endgame(state) &&
+            (atomic_load_explicit(&node->visits, memory_order_relaxed) >= MCTS_ENDGAME_SOLVE_VISITS ||
+             is_endgame_solved(&state))) {
+            result = endgame_result(&state);
+            break;
+        }
+
+        uint8_t expansion = atomic_load_explicit(&node->expansion, memory_order_acquire);
+
+        if (expansion == MctsLeaf && depth < MCTS_MAX_DEPTH &&
+            atomic_load_explicit(&node->visits, memory_order_relaxed) >= MCTS_EXPAND_VISITS &&
+            atomic_compare_exchange_strong(&node->expansion, &expansion, MctsExpanding)) {
+            if (expand_node(tree, node, &state)) {
+                expansion = MctsExpanded;
+            } else {
+                atomic_store(&node->expansion, MctsLeaf);
+            }
+        }
+
+        // Nodes being expanded by another thread are evaluated as leaves.
+        if (expansion != MctsExpanded) {
+            result = run_rollout(state, random_state);
+            break;
+        }
+
+        const uint32_t child = select_child(tree, node);
+        struct Move move = decode_move(tree->nodes[child].move);
+        add_virtual_loss(&tree->nodes[child]);
+        make_move(&state, &move);
+        path[++depth] = child;
+    }
+
+    // The value of a node is for the player who moved into it, the result is for the player to
+    // move at the leaf.
+    for (int i = depth; i >= 0; i--) {
+        result = -result;
+        struct MctsNode *node = &tree->nodes[path[i]];
+        const int64_t value = (int64_t) (result * MCTS_VALUE_SCALE) + (int64_t) MCTS_VIRTUAL_LOSS * MCTS_VALUE_SCALE;
+
+        atomic_fetch_add_explicit(&node->value, value, memory_order_relaxed);
+        atomic_fetch_sub_explicit(&node->visits, MCTS_VIRTUAL_LOSS - 1, memory_order_relaxed);
+    }
+
+    int max_depth = atomic_load_explicit(&tree->max_depth, memory_order_relaxed);
+    while (depth > max_depth && !atomic_compare_exchange_weak(&tree->max_depth, &max_depth, depth)) {
+    }
+}
+
+static void *run_playouts(void *arg) {
+    struct MctsThread *thread = arg;
+    struct MctsTree *tree = thread->tree;
+
+    for (uint64_t i = 1; !atomic_load_explicit(&tree->stop, memory_order_relaxed); i++) {
+        if (atomic_fetch_add(&tree->started_playouts, 1) >= tree->playout_limit ||
+            (i % MCTS_CLOCK_CHECK_INTERVAL == 0 && get_time_ms() >= tree->deadline_ms)) {
+            atomic_store(&tree->stop, true);
+            break;
+        }
+
+        run_playout(tree, &thread->random_state);
+        atomic_fetch_add_explicit(&tree->completed_playouts, 1, memory_order_relaxed);
+    }
+
+    return NULL;
+}
+
+struct SearchResult get_best_move_mcts(struct State state, const struct SearchBudget budget, int thread_count) {
+    const double start_ms = get_time_ms();
+    struct SearchResult result = { 0 };
+
+    recompute_derived_state(&state);
+    if (probe_opening_book(&state, &result.best_move)) {
+        return result;
+    }
+    if (is_fenceless_endgame(state)) {
+        const int outcome = probe_endgame(&state, &result.best_move);
+        result.best_move.score = outcome == ENDGAME_DRAW ? 0 : outcome > 0 ? MCTS_SCORE_SCALE : -MCTS_SCORE_SCALE;
+        return result;
+    }
+
+    thread_count = thread_count < 1 ? 1 : thread_count > MAX_SEARCH_THREADS ? MAX_SEARCH_THREADS : thread_count;
+
+    struct MctsTree *tree = malloc(sizeof(struct MctsTree));
+    struct MctsThread *threads = malloc(sizeof(struct MctsThread) * thread_count);
+    if (tree == NULL || threads == NULL) {
+        exit(1);  // malloc failed, should probably log this somehow.
+    }
+
+    *tree = (struct MctsTree) {
+            .nodes = malloc(sizeof(struct MctsNode) * MCTS_ARENA_SIZE),
+            .node_count = 1,
+            .root_state = state,
+            .playout_limit = budget.node_limit > 0 ? budget.node_limit
+                             : budget.time_limit_ms > 0 ? UINT64_MAX
+                             : MCTS_DEFAULT_PLAYOUTS,
+            .deadline_ms = budget.time_limit_ms > 0 ? start_ms + budget.time_limit_ms : INFINITY,
+    };
+    if (tree->nodes == NULL) {
+        exit(1);  // malloc failed, should probably log this somehow.
+    }
+    // The root is expanded before the threads start, so that they do not evaluate it as a leaf.
+    tree->nodes[0] = (struct MctsNode) { .prior = 1.0f, .expansion = MctsExpanding };
+    expand_node(tree, &tree->nodes[0], &state);
+
+    // Each thread has its own random sequence, the same in every search.
+    for (int i = 0; i < thread_count; i++) {
+        threads[i] = (struct MctsThread) { .tree = tree, .random_state = 0x9E3779B97F4A7C15ULL * (i + 1) };
+    }
+
+    // Thread creation fails in builds without thread support (e.g. WASM), the main thread then
+    // runs the playouts alone.
+    int helper_count = 0;
+    while (helper_count < thread_count - 1 &&
+           pthread_create(&threads[helper_count + 1].thread, NULL, run_playouts, &threads[helper_count + 1]) == 0) {
+        helper_count++;
+    }
+
+    run_playouts(&threads[0]);
+
+    for (int i = 1; i <= helper_count; i++) {
+        pthread_join(threads[i].thread, NULL);
+    }
+
+    // The most visited move is the most reliable, its mean result is its score.
+    const struct MctsNode *root = &tree->nodes[0];
+    const struct MctsNode *best_child = &tree->nodes[root->first_child];
+
+    for (uint32_t i = root->first_child; i < root->first_child + root->child_count; i++) {
+        if (tree->nodes[i].visits > best_child->visits) {
+            best_child = &tree->nodes[i];
+        }
+    }
+
+    result.best_move = decode_move(best_child->move);
+    result.best_move.score = best_child->visits > 0
+                             ? (int) lroundf(MCTS_SCORE_SCALE * (float) best_child->value /
+                                             ((float) MCTS_VALUE_SCALE * (float) best_child->visits))
+                             : 0;
+    result.depth = tree->max_depth;
+    result.nodes = tree->completed_playouts;
+    result.stats.total.nodes = result.nodes;
+    result.stats.total.time_ms = get_time_ms() - start_ms;
+
+    free(tree->nodes);
+    free(tree);
+    free(threads);
+    return result;
+}
@@ -0,0 +1,71 @@
+#ifndef QUORIDOR_MCTS_H
+#define QUORIDOR_MCTS_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+#include "state.h"
+#include "move.h"
+#include "search.h"
+
+// Number of nodes of the tree, allocated for each search. A playout only adds nodes when it
+// expands a leaf, the search goes on without expanding once the arena is full.
+#ifdef __EMSCRIPTEN__
+#define MCTS_ARENA_SIZE (1 << 18)  // 6 MiB with 24 byte nodes
+#else
+#define MCTS_ARENA_SIZE (1 << 20)  // 24 MiB with 24 byte nodes
+#endif
+
+// Playouts of a search without a time or node limit.
+#define MCTS_DEFAULT_PLAYOUTS 20000
+
+// Deepest path from the root a playout follows before evaluating, pawns can move back and forth.
+#define MCTS_MAX_DEPTH 128
+
+// Scale of the score of the best move: the mean playout result, from -100 (every playout lost)
+// to 100 (every playout won).
+#define MCTS_SCORE_SCALE 100
+
+/**
+ * @struct MctsNode
+ * @brief A node of the search tree, reached by `move` from its parent.
+ *
+ * The children of a node are contiguous in the arena. Visits and values are updated by all
+ * threads without locking, a playout in progress counts as a lost visit of every node on its path
+ * (a virtual loss) so that other threads are steered towards other moves.
+ */
+struct MctsNode {
+    _Atomic int64_t value;       // Sum of the playout results for the player making `move`, fixed point.
+    _Atomic int32_t visits;      // Including the virtual losses of playouts in progress.
+    uint32_t first_child;        // Index of the first child in the arena, once expanded.
+    float prior;                 // Probability of `move` among its siblings, used to guide the selection.
+    EncodedMove move;
+    uint8_t child_count;
+    _Atomic uint8_t expansion;   // An `enum MctsExpansion`.
+};
+
+/**
+ * @brief Chooses a move with Monte Carlo tree search, using PUCT to select moves.
+ *
+ * Each playout descends the tree from the root, choosing the child with the best sum of its mean
+ * result and an exploration bonus proportional to its prior. A leaf is expanded on its second
+ * visit, with priors favouring pawn moves towards the goal. Fences are limited to those cutting a
+ * shortest path of the opponent. The leaf is then evaluated by a short rollout of
+ * distance-guided pawn moves and fences on the opponent's shortest path, and the path
+ * difference at its end. Positions without fences left are scored exactly by the endgame solver,
+ * once they have been visited often enough to be worth solving.
+ *
+ * Playouts are run by `thread_count` threads sharing the tree (only the calling thread in builds
+ * without thread support). Positions in the opening book and fenceless endgames are not
+ * searched.
+ *
+ * @param state The current game state.
+ * @param budget The time and playout (`node_limit`) limits, the depth is ignored. Without either
+ *               limit the search runs `MCTS_DEFAULT_PLAYOUTS` playouts.
+ * @param thread_count Number of threads, at most `MAX_SEARCH_THREADS`.
+ *
+ * @return The most visited move, along with the playouts run and the deepest node they reached.
+ *         The score of the move is scaled by `MCTS_SCORE_SCALE`.
+ */
+struct SearchResult get_best_move_mcts(struct State state, struct SearchBudget budget, int thread_count);
+
+#endif //QUORIDOR_MCTS_H
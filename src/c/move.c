@@ -1,8 +1,11 @@
 #include <stdio.h>
+#include <string.h>
 #include <assert.h>
 #include "move.h"
 #include "state.h"
 
+const int8_t pawn_move_row_offsets[PAWN_MOVE_TYPE_COUNT] = { -1, 0, 1, 0, -2, 0, 2, 0, -1, -1, 1, 1 };
+const int8_t pawn_move_col_offsets[PAWN_MOVE_TYPE_COUNT] = { 0, 1, 0, -1, 0, 2, 0, -2, 1, -1, 1, -1 };
 
 FenceMove create_fence_move(int row, int col) {
     assert(0 <= row && row < FENCE_BIT_BOARD_WIDTH);
@@ -10,6 +13,83 @@ FenceMove create_fence_move(int row, int col) {
     return square64(row * FENCE_BIT_BOARD_WIDTH + col);
 }
 
+EncodedMove encode_move(struct Move move) {
+    switch (move.moveType) {
+        case VerticalFence:
+            return ENCODED_VERTICAL_FENCE_OFFSET + __builtin_ctzll(move.move.fenceMove);
+        case HorizontalFence:
+            return ENCODED_HORIZONTAL_FENCE_OFFSET + __builtin_ctzll(move.move.fenceMove);
+        case Pawn:
+            return ENCODED_PAWN_MOVE_OFFSET + __builtin_ctz(move.move.pawnMove);
+        case None:
+        default:
+            return 0;
+    }
+}
+
+struct Move decode_move(EncodedMove encoded_move) {
+    if (encoded_move >= ENCODED_HORIZONTAL_FENCE_OFFSET) {
+        return (struct Move) { .moveType = HorizontalFence,
+                               .move.fenceMove = square64(encoded_move - ENCODED_HORIZONTAL_FENCE_OFFSET) };
+    }
+    if (encoded_move >= ENCODED_VERTICAL_FENCE_OFFSET) {
+        return (struct Move) { .moveType = VerticalFence,
+                               .move.fenceMove = square64(encoded_move - ENCODED_VERTICAL_FENCE_OFFSET) };
+    }
+    if (encoded_move >= ENCODED_PAWN_MOVE_OFFSET) {
+        return (struct Move) { .moveType = Pawn, .move.pawnMove = 1 << (encoded_move - ENCODED_PAWN_MOVE_OFFSET) };
+    }
+    return (struct Move) { .moveType = None };
+}
+
+// Direction names of the pawn moves, indexed by the bit index of the `PawnMove`.
+static const char *pawn_move_directions[] = { "N", "E", "S", "W", "NN", "EE", "SS", "WW", "NE", "NW", "SE", "SW" };
+
+int parse_move(const char *text, struct Move *move) {
+    char direction[3];
+    int row, col;
+    int consumed = 0;
+
+    if (sscanf(text, " P %2[NESW]%n", direction, &consumed) == 1) {
+        for (int i = 0; i < (int) (sizeof(pawn_move_directions) / sizeof(pawn_move_directions[0])); i++) {
+            if (strcmp(direction, pawn_move_directions[i]) == 0) {
+                *move = (struct Move) { .moveType = Pawn, .move.pawnMove = 1 << i };
+                return consumed;
+            }
+        }
+        return 0;
+    }
+
+    enum MoveType fence_type;
+    if (sscanf(text, " HF %d %d%n", &row, &col, &consumed) == 2) {
+        fence_type = HorizontalFence;
+    } else if (sscanf(text, " VF %d %d%n", &row, &col, &consumed) == 2) {
+        fence_type = VerticalFence;
+    } else {
+        return 0;
+    }
+
+    if (row < 0 || row >= FENCE_BIT_BOARD_WIDTH || col < 0 || col >= FENCE_BIT_BOARD_WIDTH) {
+        return 0;
+    }
+
+    *move = (struct Move) { .moveType = fence_type, .move.fenceMove = create_fence_move(row, col) };
+    return consumed;
+}
+
+void format_move(struct Move move, char *text, size_t size) {
+    assert(move.moveType != None);
+
+    if (move.moveType == Pawn) {
+        snprintf(text, size, "P %s", pawn_move_directions[__builtin_ctz(move.move.pawnMove)]);
+        return;
+    }
+
+    const int fence_index = __builtin_ctzll(move.move.fenceMove);
+    snprintf(text, size, "%s %d %d", move.moveType == HorizontalFence ? "HF" : "VF",
+             fence_index / FENCE_BIT_BOARD_WIDTH, fence_index % FENCE_BIT_BOARD_WIDTH);
+}
+
 char* move_type_to_string(enum MoveType move_type) {
     switch(move_type) {
         case None:              return "None";
@@ -1,6 +1,7 @@
 #ifndef QUORIDOR_MOVE_H
 #define QUORIDOR_MOVE_H
 
+#include <stddef.h>
 #include <stdint.h>
 #include <stdbool.h>
 
@@ -35,6 +36,12 @@ enum PawnMoveTypes {
     SouthWest   = 0b100000000000
 };
 
+#define PAWN_MOVE_TYPE_COUNT 12
+
+// Row and column offsets of each pawn move, indexed by the bit index of the `PawnMove`.
+extern const int8_t pawn_move_row_offsets[PAWN_MOVE_TYPE_COUNT];
+extern const int8_t pawn_move_col_offsets[PAWN_MOVE_TYPE_COUNT];
+
 struct Move {
     union {
         PawnMove pawnMove;
@@ -44,8 +51,46 @@ struct Move {
     int score;
 };
 
+/**
+ * A move packed into a single byte, used where moves are stored in bulk.
+ *  - 0 is `None`.
+ *  - 1 to 12 are pawn moves, `1 + log2(PawnMove)`.
+ *  - 16 to 79 are vertical fences, `16 + fence index`.
+ *  - 80 to 143 are horizontal fences, `80 + fence index`.
+ */
+typedef uint8_t EncodedMove;
+
+#define ENCODED_PAWN_MOVE_OFFSET 1
+#define ENCODED_VERTICAL_FENCE_OFFSET 16
+#define ENCODED_HORIZONTAL_FENCE_OFFSET 80
+#define ENCODED_MOVE_COUNT 144
+
 FenceMove create_fence_move(int row, int col);
 
+EncodedMove encode_move(struct Move move);
+
+struct Move decode_move(EncodedMove encoded_move);
+
+/**
+ * @brief Parses a move written as in the command line game: "P <direction>", "HF <row> <col>" or
+ * "VF <row> <col>". The move is not checked for legality.
+ *
+ * @param text The move text, parsing stops after the move.
+ * @param move Pointer to where the parsed move is stored.
+ *
+ * @return The number of characters consumed, or 0 if the text is not a valid move.
+ */
+int parse_move(const char *text, struct Move *move);
+
+/**
+ * @brief Writes a move in the format read by `parse_move`.
+ *
+ * @param move The move, must not be `None`.
+ * @param text Buffer the move is written to, 8 characters are always enough.
+ * @param size Size of the buffer.
+ */
+void format_move(struct Move move, char *text, size_t size);
+
 char *move_type_to_string(enum MoveType move_type);
 
 char *pawn_move_type_to_string(enum PawnMoveTypes pawn_move_type);
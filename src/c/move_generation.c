@@ -4,64 +4,50 @@
 #include "bitboards.h"
 #include "evaluate.h"
 
-FenceMoves generate_pseudo_legal_vertical_fence_moves(struct State state) {
-    if (state.player_to_move == 1 && state.player_1_fence_count > 0 ||
-        state.player_to_move == 2 && state.player_2_fence_count > 0) {
+FenceMoves generate_pseudo_legal_vertical_fence_moves(const struct State *state) {
+    if (state->player_to_move == 1 && state->player_1_fence_count > 0 ||
+        state->player_to_move == 2 && state->player_2_fence_count > 0) {
 
-        return ~(state.vertical_fences | state.vertical_fences << FENCE_BIT_BOARD_WIDTH |
-                 state.vertical_fences >> FENCE_BIT_BOARD_WIDTH | state.horizontal_fences);
+        return ~(state->vertical_fences | state->vertical_fences << FENCE_BIT_BOARD_WIDTH |
+                 state->vertical_fences >> FENCE_BIT_BOARD_WIDTH | state->horizontal_fences);
     }
 
     return 0;
 }
 
 
-FenceMoves generate_pseudo_legal_horizontal_fence_moves(struct State state) {
-    if (state.player_to_move == 1 && state.player_1_fence_count > 0 ||
-        state.player_to_move == 2 && state.player_2_fence_count > 0) {
+FenceMoves generate_pseudo_legal_horizontal_fence_moves(const struct State *state) {
+    if (state->player_to_move == 1 && state->player_1_fence_count > 0 ||
+        state->player_to_move == 2 && state->player_2_fence_count > 0) {
 
-        return ~(state.horizontal_fences | (state.horizontal_fences & ~RIGHT_FENCE_MASK) << 1 |
-                 (state.horizontal_fences & ~LEFT_FENCE_MASK) >> 1 | state.vertical_fences);
+        return ~(state->horizontal_fences | (state->horizontal_fences & ~RIGHT_FENCE_MASK) << 1 |
+                 (state->horizontal_fences & ~LEFT_FENCE_MASK) >> 1 | state->vertical_fences);
     }
 
     return 0;
 }
 
-PawnMoves generate_legal_pawn_moves(struct State state) {
-    uint8_t player_row, player_col, opponent_row, opponent_col;
-    switch (state.player_to_move) {
-        case 1:
-            player_row = state.player_1_row;
-            player_col = state.player_1_col;
-            opponent_row = state.player_2_row;
-            opponent_col = state.player_2_col;
-            break;
-        case 2:
-            player_row = state.player_2_row;
-            player_col = state.player_2_col;
-            opponent_row = state.player_1_row;
-            opponent_col = state.player_1_col;
-            break;
-        default:
-            assert(false && "generate_legal_pawn_moves: Illegal state.player_to_move value.");
-    }
+PawnMoves generate_legal_pawn_moves(const struct State *state) {
+    assert((state->player_to_move == 1 || state->player_to_move == 2) &&
+           "generate_legal_pawn_moves: Illegal state.player_to_move value.");
+    const struct PawnSquare player = state->pawns[state->player_to_move - 1];
+    const struct PawnSquare opponent = state->pawns[2 - state->player_to_move];
 
     PawnMoves pawnMoves = 0;
-    __uint128_t player_board = square128(12 + player_row * 11 + player_col);
-    __uint128_t opponent_board = square128(12 + opponent_row * 11 + opponent_col);
+    __uint128_t player_board = square128(12 + player.row * 11 + player.col);
+    __uint128_t opponent_board = square128(12 + opponent.row * 11 + opponent.col);
 
-    struct Bitboards bb;
-    generate_bitboards(&state, &bb);
+    const struct Bitboards *bb = &state->bitboards;
 
-    if (bitboard_up(player_board) & ~bb.up_fences) {
+    if (bitboard_up(player_board) & ~bb->up_fences) {
         if (bitboard_up(player_board) & opponent_board) {
-            if (bitboard_up(opponent_board) & ~bb.up_fences) {
+            if (bitboard_up(opponent_board) & ~bb->up_fences) {
                 pawnMoves |= NorthNorth;
             } else {
-                if (bitboard_left(opponent_board) & ~bb.left_fences) {
+                if (bitboard_left(opponent_board) & ~bb->left_fences) {
                     pawnMoves |= NorthWest;
                 }
-                if (bitboard_right(opponent_board) & ~bb.right_fences) {
+                if (bitboard_right(opponent_board) & ~bb->right_fences) {
                     pawnMoves |= NorthEast;
                 }
             }
@@ -70,15 +56,15 @@ PawnMoves generate_legal_pawn_moves(struct State state) {
         }
     }
 
-    if (bitboard_right(player_board) & ~bb.right_fences) {
+    if (bitboard_right(player_board) & ~bb->right_fences) {
         if (bitboard_right(player_board) & opponent_board) {
-            if (bitboard_right(opponent_board) & ~bb.right_fences) {
+            if (bitboard_right(opponent_board) & ~bb->right_fences) {
                 pawnMoves |= EastEast;
             } else {
-                if (bitboard_up(opponent_board) & ~bb.up_fences) {
+                if (bitboard_up(opponent_board) & ~bb->up_fences) {
                     pawnMoves |= NorthEast;
                 }
-                if (bitboard_down(opponent_board) & ~bb.down_fences) {
+                if (bitboard_down(opponent_board) & ~bb->down_fences) {
                     pawnMoves |= SouthEast;
                 }
             }
@@ -87,15 +73,15 @@ PawnMoves generate_legal_pawn_moves(struct State state) {
         }
     }
 
-    if (bitboard_left(player_board) & ~bb.left_fences) {
+    if (bitboard_left(player_board) & ~bb->left_fences) {
         if (bitboard_left(player_board) & opponent_board) {
-            if (bitboard_left(opponent_board) & ~bb.left_fences) {
+            if (bitboard_left(opponent_board) & ~bb->left_fences) {
                 pawnMoves |= WestWest;
             } else {
-                if (bitboard_down(opponent_board) & ~bb.down_fences) {
+                if (bitboard_down(opponent_board) & ~bb->down_fences) {
                     pawnMoves |= SouthWest;
                 }
-                if (bitboard_up(opponent_board) & ~bb.up_fences) {
+                if (bitboard_up(opponent_board) & ~bb->up_fences) {
                     pawnMoves |= NorthWest;
                 }
             }
@@ -104,15 +90,15 @@ PawnMoves generate_legal_pawn_moves(struct State state) {
         }
     }
 
-    if (bitboard_down(player_board) & ~bb.down_fences) {
+    if (bitboard_down(player_board) & ~bb->down_fences) {
         if (bitboard_down(player_board) & opponent_board) {
-            if (bitboard_down(opponent_board) & ~bb.down_fences) {
+            if (bitboard_down(opponent_board) & ~bb->down_fences) {
                 pawnMoves |= SouthSouth;
             } else {
-                if (bitboard_right(opponent_board) & ~bb.right_fences) {
+                if (bitboard_right(opponent_board) & ~bb->right_fences) {
                     pawnMoves |= SouthEast;
                 }
-                if (bitboard_left(opponent_board) & ~bb.left_fences) {
+                if (bitboard_left(opponent_board) & ~bb->left_fences) {
                     pawnMoves |= SouthWest;
                 }
             }
@@ -124,39 +110,218 @@ PawnMoves generate_legal_pawn_moves(struct State state) {
 }
 
 FenceMoves generate_fully_legal_vertical_fence_moves(struct State state) {
-    FenceMoves legal_moves = 0;
-    FenceMoves pseudo_legal_moves = generate_pseudo_legal_vertical_fence_moves(state);
+    FenceMoves vertical_fence_moves, horizontal_fence_moves;
+    generate_fully_legal_fence_moves(&state, &vertical_fence_moves, &horizontal_fence_moves);
+    return vertical_fence_moves;
+}
+
+FenceMoves generate_fully_legal_horizontal_fence_moves(struct State state) {
+    FenceMoves vertical_fence_moves, horizontal_fence_moves;
+    generate_fully_legal_fence_moves(&state, &vertical_fence_moves, &horizontal_fence_moves);
+    return horizontal_fence_moves;
+}
+
+void generate_move_list(PawnMoves pawn_moves, FenceMoves vertical_fence_moves, FenceMoves horizontal_fence_moves,
+                        struct MoveList *move_list) {
+    int count = 0;
+
+    for (; pawn_moves != 0; pawn_moves &= pawn_moves - 1) {
+        move_list->moves[count++] = (struct ScoredMove) {
+                .move = ENCODED_PAWN_MOVE_OFFSET + __builtin_ctz(pawn_moves) };
+    }
+
+    for (; horizontal_fence_moves != 0; horizontal_fence_moves &= horizontal_fence_moves - 1) {
+        move_list->moves[count++] = (struct ScoredMove) {
+                .move = ENCODED_HORIZONTAL_FENCE_OFFSET + __builtin_ctzll(horizontal_fence_moves) };
+    }
+
+    for (; vertical_fence_moves != 0; vertical_fence_moves &= vertical_fence_moves - 1) {
+        move_list->moves[count++] = (struct ScoredMove) {
+                .move = ENCODED_VERTICAL_FENCE_OFFSET + __builtin_ctzll(vertical_fence_moves) };
+    }
+
+    move_list->count = count;
+}
+
+/**
+ * @return Mask of the (up to two) fences of one orientation that share the fence row or column
+ * `line` and touch the board row or column `position`.
+ */
+static inline FenceMoves fence_pair(int line, int position, bool horizontal) {
+    const int low = position > 0 ? position - 1 : 0;
+    const int high = position < FENCE_BIT_BOARD_WIDTH ? position : FENCE_BIT_BOARD_WIDTH - 1;
+
+    return horizontal
+           ? create_fence_move(line, low) | create_fence_move(line, high)
+           : create_fence_move(low, line) | create_fence_move(high, line);
+}
+
+/**
+ * @return Mask of the fences (of either orientation) touching a side of the square.
+ */
+static inline FenceMoves fences_around_square(int row, int col) {
+    FenceMoves fences = 0;
+
+    if (row > 0) {
+        fences |= fence_pair(row - 1, col, true);
+    }
+    if (row < FENCE_BIT_BOARD_WIDTH) {
+        fences |= fence_pair(row, col, true);
+    }
+
+    return fences;
+}
 
-    while (pseudo_legal_moves != 0) {
-        FenceMove move = square64(__builtin_ctzll(pseudo_legal_moves));
-        pseudo_legal_moves &= pseudo_legal_moves - 1;
-        make_vertical_fence_move(&state, move);
+/**
+ * Adds the fences cutting a set of shortest path edges to the fence masks.
+ */
+static void add_fences_cutting_edges(const struct ShortestPathEdges *edges, FenceMoves *vertical_fences,
+                                     FenceMoves *horizontal_fences) {
+    // Entering square (row, col) upwards crosses fence row `row`, downwards crosses fence row
+    // `row - 1`, leftwards crosses fence column `col` and rightwards crosses fence column `col - 1`.
+    for (int half = 0; half < 2; half++) {
+        const uint64_t up = (uint64_t) (edges->up >> (64 * half));
+        const uint64_t down = (uint64_t) (edges->down >> (64 * half));
+        const uint64_t left = (uint64_t) (edges->left >> (64 * half));
+        const uint64_t right = (uint64_t) (edges->right >> (64 * half));
 
-        if (evaluate(state) != NO_PATH_FOUND) {
-            legal_moves |= move;
+        for (uint64_t bits = up; bits != 0; bits &= bits - 1) {
+            const int index = 64 * half + __builtin_ctzll(bits);
+            *horizontal_fences |= fence_pair(index / 11 - 1, index % 11 - 1, true);
+        }
+        for (uint64_t bits = down; bits != 0; bits &= bits - 1) {
+            const int index = 64 * half + __builtin_ctzll(bits);
+            *horizontal_fences |= fence_pair(index / 11 - 2, index % 11 - 1, true);
         }
+        for (uint64_t bits = left; bits != 0; bits &= bits - 1) {
+            const int index = 64 * half + __builtin_ctzll(bits);
+            *vertical_fences |= fence_pair(index % 11 - 1, index / 11 - 1, false);
+        }
+        for (uint64_t bits = right; bits != 0; bits &= bits - 1) {
+            const int index = 64 * half + __builtin_ctzll(bits);
+            *vertical_fences |= fence_pair(index % 11 - 2, index / 11 - 1, false);
+        }
+    }
+}
+
+void find_fences_cutting_shortest_paths(const struct State *state, int player, FenceMoves *vertical_fences,
+                                        FenceMoves *horizontal_fences) {
+    struct ShortestPathEdges edges;
+    *vertical_fences = 0;
+    *horizontal_fences = 0;
+
+    if (get_shortest_path_edges(state, player, &edges) != NO_PATH_FOUND) {
+        add_fences_cutting_edges(&edges, vertical_fences, horizontal_fences);
+    }
+}
 
-        unmake_vertical_fence_move(&state, move);
+void filter_relevant_fence_moves(const struct State *state, FenceMoves *vertical_fence_moves,
+                                 FenceMoves *horizontal_fence_moves) {
+    if ((*vertical_fence_moves | *horizontal_fence_moves) == 0) {
+        return;
     }
 
-    return legal_moves;
+    struct ShortestPathEdges edges;
+    FenceMoves relevant_vertical_fences = 0;
+    FenceMoves relevant_horizontal_fences = 0;
+
+    if (get_shortest_path_edges(state, 1, &edges) != NO_PATH_FOUND) {
+        add_fences_cutting_edges(&edges, &relevant_vertical_fences, &relevant_horizontal_fences);
+    }
+    if (get_shortest_path_edges(state, 2, &edges) != NO_PATH_FOUND) {
+        add_fences_cutting_edges(&edges, &relevant_vertical_fences, &relevant_horizontal_fences);
+    }
+
+    const FenceMoves pawn_fences = fences_around_square(state->player_1_row, state->player_1_col) |
+                                   fences_around_square(state->player_2_row, state->player_2_col);
+
+    *vertical_fence_moves &= relevant_vertical_fences | pawn_fences;
+    *horizontal_fence_moves &= relevant_horizontal_fences | pawn_fences;
 }
 
-FenceMoves generate_fully_legal_horizontal_fence_moves(struct State state) {
-    FenceMoves legal_moves = 0;
-    FenceMoves pseudo_legal_moves = generate_pseudo_legal_horizontal_fence_moves(state);
+int generate_fully_legal_fence_moves(const struct State *state, FenceMoves *vertical_fence_moves,
+                                     FenceMoves *horizontal_fence_moves) {
+    FenceMoves vertical_moves = generate_pseudo_legal_vertical_fence_moves(state);
+    FenceMoves horizontal_moves = generate_pseudo_legal_horizontal_fence_moves(state);
+    FenceMoves path_vertical_fences = 0;
+    FenceMoves path_horizontal_fences = 0;
+    struct ShortestPathEdges edges;
+    int path_searches = 0;
+
+    if ((vertical_moves | horizontal_moves) == 0) {
+        *vertical_fence_moves = 0;
+        *horizontal_fence_moves = 0;
+        return 0;
+    }
 
-    while (pseudo_legal_moves != 0) {
-        FenceMove move = square64(__builtin_ctzll(pseudo_legal_moves));
-        pseudo_legal_moves &= pseudo_legal_moves - 1;
-        make_horizontal_fence_move(&state, move);
+    // A fence can only leave a player without a path if it cuts all of their shortest paths, and
+    // if it closes a loop of walls. Only the fences doing both need their paths searched.
+    if (get_shortest_path_edges(state, 1, &edges) != NO_PATH_FOUND) {
+        add_fences_cutting_edges(&edges, &path_vertical_fences, &path_horizontal_fences);
+    }
+    if (get_shortest_path_edges(state, 2, &edges) != NO_PATH_FOUND) {
+        add_fences_cutting_edges(&edges, &path_vertical_fences, &path_horizontal_fences);
+    }
+
+    struct State child = *state;
+
+    for (FenceMoves candidates = vertical_moves & path_vertical_fences; candidates != 0; candidates &= candidates - 1) {
+        const int fence_index = __builtin_ctzll(candidates);
 
-        if (evaluate(state) != NO_PATH_FOUND) {
-            legal_moves |= move;
+        if (!fence_closes_wall_loop(&state->walls, fence_index, true)) {
+            continue;
         }
 
-        unmake_horizontal_fence_move(&state, move);
+        const FenceMove move = square64(fence_index);
+        make_vertical_fence_move(&child, move);
+        path_searches++;
+
+        if (evaluate(&child) == NO_PATH_FOUND) {
+            vertical_moves &= ~move;
+        }
+
+        unmake_vertical_fence_move(&child, move);
+    }
+
+    for (FenceMoves candidates = horizontal_moves & path_horizontal_fences; candidates != 0;
+         candidates &= candidates - 1) {
+        const int fence_index = __builtin_ctzll(candidates);
+
+        if (!fence_closes_wall_loop(&state->walls, fence_index, false)) {
+            continue;
+        }
+
+        const FenceMove move = square64(fence_index);
+        make_horizontal_fence_move(&child, move);
+        path_searches++;
+
+        if (evaluate(&child) == NO_PATH_FOUND) {
+            horizontal_moves &= ~move;
+        }
+
+        unmake_horizontal_fence_move(&child, move);
+    }
+
+    *vertical_fence_moves = vertical_moves;
+    *horizontal_fence_moves = horizontal_moves;
+    return path_searches;
+}
+
+int generate_all_legal_moves(const struct State *state, EncodedMove *moves) {
+    FenceMoves vertical_fence_moves, horizontal_fence_moves;
+    int count = 0;
+
+    generate_fully_legal_fence_moves(state, &vertical_fence_moves, &horizontal_fence_moves);
+
+    for (PawnMoves bits = generate_legal_pawn_moves(state); bits != 0; bits &= bits - 1) {
+        moves[count++] = ENCODED_PAWN_MOVE_OFFSET + __builtin_ctz(bits);
+    }
+    for (FenceMoves bits = horizontal_fence_moves; bits != 0; bits &= bits - 1) {
+        moves[count++] = ENCODED_HORIZONTAL_FENCE_OFFSET + __builtin_ctzll(bits);
+    }
+    for (FenceMoves bits = vertical_fence_moves; bits != 0; bits &= bits - 1) {
+        moves[count++] = ENCODED_VERTICAL_FENCE_OFFSET + __builtin_ctzll(bits);
     }
 
-    return legal_moves;
+    return count;
 }
@@ -11,7 +11,7 @@
  * @param state The game state.
  * @return A bitmask (`FenceMoves`) of valid vertical fence positions.
  */
-FenceMoves generate_pseudo_legal_vertical_fence_moves(struct State state);
+FenceMoves generate_pseudo_legal_vertical_fence_moves(const struct State *state);
 
 /**
  * Returns a bitmask of pseudo-legal horizontal fence moves for the current player.
@@ -21,13 +21,15 @@ FenceMoves generate_pseudo_legal_vertical_fence_moves(struct State state);
  * @param state The game state.
  * @return A bitmask (`FenceMoves`) of valid horizontal fence positions.
  */
-FenceMoves generate_pseudo_legal_horizontal_fence_moves(struct State state);
+FenceMoves generate_pseudo_legal_horizontal_fence_moves(const struct State *state);
 
 /**
+ * Fences are read from the bitboards cached in the state.
+ *
  * @param state The game state.
  * @return A bitmask (`PawnMoves`) of legal pawn moves (`PawnMove`).
  */
-PawnMoves generate_legal_pawn_moves(struct State state);
+PawnMoves generate_legal_pawn_moves(const struct State *state);
 
 /**
  * Returns a bitmask of legal vertical fence moves for the current player.
@@ -45,5 +47,111 @@ FenceMoves generate_fully_legal_vertical_fence_moves(struct State state);
  */
 FenceMoves generate_fully_legal_horizontal_fence_moves(struct State state);
 
+/**
+ * Generates the legal vertical and horizontal fence moves of the current player at once.
+ *
+ * Both players' shortest paths are found once and shared by all fences. A fence that cuts none
+ * of the shortest path edges, or that does not close a loop of walls in the state's wall graph
+ * (see `struct WallGraph`), leaves both players a path, so only the few fences doing both are
+ * checked with a full path search.
+ *
+ * @param state The game state.
+ * @param vertical_fence_moves Pointer to where the mask of legal vertical fences is stored.
+ * @param horizontal_fence_moves Pointer to where the mask of legal horizontal fences is stored.
+ * @return The number of fences that were checked with a path search.
+ */
+int generate_fully_legal_fence_moves(const struct State *state, FenceMoves *vertical_fence_moves,
+                                     FenceMoves *horizontal_fence_moves);
+
+/**
+ * Finds the fences that cut a shortest path edge of a player (see `get_shortest_path_edges`), the
+ * only fences that can lengthen their path. Whether the fences can be placed is not checked.
+ *
+ * @param state The game state.
+ * @param player The player (1 or 2) whose paths are cut.
+ * @param vertical_fences Pointer to where the mask of vertical fences is stored.
+ * @param horizontal_fences Pointer to where the mask of horizontal fences is stored.
+ */
+void find_fences_cutting_shortest_paths(const struct State *state, int player, FenceMoves *vertical_fences,
+                                        FenceMoves *horizontal_fences);
+
+/**
+ * Removes the fences that cannot change either player's shortest path length from fence move
+ * masks. The fences kept are those that cut a shortest path edge of either player (see
+ * `get_shortest_path_edges`) and those touching a side of either pawn, which can change the
+ * available jumps. Fences that only extend existing walls are not kept.
+ *
+ * @param state The game state.
+ * @param vertical_fence_moves Pointer to the vertical fence mask to filter.
+ * @param horizontal_fence_moves Pointer to the horizontal fence mask to filter.
+ */
+void filter_relevant_fence_moves(const struct State *state, FenceMoves *vertical_fence_moves,
+                                 FenceMoves *horizontal_fence_moves);
+
+#define MAX_MOVE_COUNT (12 + 2 * FENCE_BIT_BOARD_WIDTH * FENCE_BIT_BOARD_WIDTH)
+
+/**
+ * @struct ScoredMove
+ * @brief A move along with its ordering score, moves with higher scores are searched first.
+ */
+struct ScoredMove {
+    int32_t score;
+    EncodedMove move;
+};
+
+/**
+ * @struct MoveList
+ * @brief A list of moves to be scored and then picked in order of score.
+ */
+struct MoveList {
+    int count;
+    struct ScoredMove moves[MAX_MOVE_COUNT];
+};
+
+/**
+ * Fills a move list with the moves of the given masks, all with a score of 0. Pawn moves come
+ * first, then horizontal fences and then vertical fences, each by bit index.
+ *
+ * @param pawn_moves Bitmask of pawn moves.
+ * @param vertical_fence_moves Bitmask of vertical fence moves.
+ * @param horizontal_fence_moves Bitmask of horizontal fence moves.
+ * @param move_list Pointer to the move list to fill.
+ */
+void generate_move_list(PawnMoves pawn_moves, FenceMoves vertical_fence_moves, FenceMoves horizontal_fence_moves,
+                        struct MoveList *move_list);
+
+/**
+ * Writes every legal move of the current player to a buffer, encoded as by `encode_move`. Pawn
+ * moves come first, then horizontal fences and then vertical fences, each by bit index.
+ *
+ * @param state The game state.
+ * @param moves The buffer, with room for at least `MAX_MOVE_COUNT` moves.
+ * @return The number of moves written.
+ */
+int generate_all_legal_moves(const struct State *state, EncodedMove *moves);
+
+/**
+ * Moves the highest scored move from `index` onwards to `index` and returns it. Picking moves
+ * one at a time is cheaper than sorting the list, as most nodes are cut off after a few moves.
+ *
+ * @param move_list Pointer to the move list.
+ * @param index Index of the move to pick, all moves before it must have been picked already.
+ * @return The picked move.
+ */
+static inline struct ScoredMove pick_next_move(struct MoveList *move_list, int index) {
+    int best_index = index;
+
+    for (int i = index + 1; i < move_list->count; i++) {
+        if (move_list->moves[i].score > move_list->moves[best_index].score) {
+            best_index = i;
+        }
+    }
+
+    struct ScoredMove best_move = move_list->moves[best_index];
+    move_list->moves[best_index] = move_list->moves[index];
+    move_list->moves[index] = best_move;
+
+    return best_move;
+}
 
 #endif //QUORIDOR_MOVE_GENERATION_H
@@ -0,0 +1,163 @@
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "opening_book.h"
+
+_Static_assert(sizeof(struct OpeningBookHeader) == 24, "Opening book header layout is part of the file format.");
+_Static_assert(sizeof(struct OpeningBookEntry) == 16, "Opening book entry layout is part of the file format.");
+
+#ifdef __EMSCRIPTEN__
+// Generated by `quoridor_book export`, see opening_book_data.c.
+extern const unsigned char opening_book_data[];
+extern const size_t opening_book_data_size;
+
+static bool embedded_book_tried = false;
+#endif
+
+static const struct OpeningBookEntry *book_entries = NULL;
+static uint32_t book_entry_count = 0;
+
+// The mapping of a book loaded by `load_opening_book`, NULL for books used in place.
+static void *book_mapping = NULL;
+static size_t book_mapping_size = 0;
+
+static _Thread_local uint64_t book_random_state = 0x9E3779B97F4A7C15ULL;
+
+static uint64_t next_book_random() {
+    book_random_state ^= book_random_state << 13;
+    book_random_state ^= book_random_state >> 7;
+    book_random_state ^= book_random_state << 17;
+    return book_random_state;
+}
+
+/**
+ * @return The number of entries of a book, or -1 if the data is not a valid book for this engine.
+ */
+static int64_t validate_opening_book(const void *data, size_t size) {
+    const struct OpeningBookHeader *header = data;
+
+    if (size < sizeof(struct OpeningBookHeader) || ((uintptr_t) data & 7) != 0 ||
+        memcmp(header->magic, OPENING_BOOK_MAGIC, sizeof(header->magic)) != 0 ||
+        header->version != OPENING_BOOK_VERSION || header->start_key != new_state().hash ||
+        (size - sizeof(struct OpeningBookHeader)) / sizeof(struct OpeningBookEntry) < header->entry_count) {
+        return -1;
+    }
+
+    return header->entry_count;
+}
+
+bool use_opening_book(const void *data, size_t size) {
+    const int64_t entry_count = validate_opening_book(data, size);
+
+    if (entry_count < 0) {
+        return false;
+    }
+
+    close_opening_book();
+    book_entries = (const struct OpeningBookEntry *) ((const struct OpeningBookHeader *) data + 1);
+    book_entry_count = entry_count;
+    return true;
+}
+
+bool load_opening_book(const char *path) {
+    const int file = open(path, O_RDONLY);
+    struct stat file_stat;
+
+    if (file < 0) {
+        return false;
+    }
+    if (fstat(file, &file_stat) != 0 || file_stat.st_size == 0) {
+        close(file);
+        return false;
+    }
+
+    const size_t size = file_stat.st_size;
+    void *mapping = mmap(NULL, size, PROT_READ, MAP_PRIVATE, file, 0);
+    close(file);
+
+    if (mapping == MAP_FAILED) {
+        return false;
+    }
+    if (!use_opening_book(mapping, size)) {
+        munmap(mapping, size);
+        return false;
+    }
+
+    book_mapping = mapping;
+    book_mapping_size = size;
+    return true;
+}
+
+void close_opening_book() {
+    if (book_mapping != NULL) {
+        munmap(book_mapping, book_mapping_size);
+        book_mapping = NULL;
+        book_mapping_size = 0;
+    }
+
+    book_entries = NULL;
+    book_entry_count = 0;
+}
+
+bool probe_opening_book(const struct State *state, struct Move *move) {
+#ifdef __EMSCRIPTEN__
+    if (book_entries == NULL && !embedded_book_tried) {
+        embedded_book_tried = true;
+        use_opening_book(opening_book_data, opening_book_data_size);
+    }
+#endif
+
+    // Finds the first entry of the position.
+    uint32_t low = 0, high = book_entry_count;
+    while (low < high) {
+        const uint32_t middle = low + (high - low) / 2;
+
+        if (book_entries[middle].key < state->hash) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+
+    // Book moves are checked for legality, in case of a hash collision.
+    struct State scratch = *state;
+    struct Move legal_moves[OPENING_BOOK_MAX_MOVES];
+    uint32_t weights[OPENING_BOOK_MAX_MOVES];
+    uint32_t total_weight = 0;
+    int count = 0;
+
+    for (uint32_t i = low; i < book_entry_count && book_entries[i].key == state->hash && count < OPENING_BOOK_MAX_MOVES;
+         i++) {
+        const struct OpeningBookEntry *entry = &book_entries[i];
+
+        if (entry->move >= ENCODED_MOVE_COUNT || entry->weight == 0) {
+            continue;
+        }
+
+        const struct Move book_move = decode_move(entry->move);
+        if (book_move.moveType == None || !move_is_fully_legal(&scratch, book_move)) {
+            continue;
+        }
+
+        legal_moves[count] = book_move;
+        weights[count] = entry->weight;
+        total_weight += entry->weight;
+        count++;
+    }
+
+    if (count == 0) {
+        return false;
+    }
+
+    uint32_t pick = next_book_random() % total_weight;
+    int index = 0;
+    while (pick >= weights[index]) {
+        pick -= weights[index];
+        index++;
+    }
+
+    *move = legal_moves[index];
+    return true;
+}
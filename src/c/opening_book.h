@@ -0,0 +1,83 @@
+#ifndef QUORIDOR_OPENING_BOOK_H
+#define QUORIDOR_OPENING_BOOK_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "state.h"
+#include "move.h"
+
+#define OPENING_BOOK_MAGIC "QBOOK\r\n\032"
+#define OPENING_BOOK_VERSION 1
+
+// Moves of a position beyond this are ignored by the probe.
+#define OPENING_BOOK_MAX_MOVES 16
+
+/**
+ * @struct OpeningBookHeader
+ * @brief The start of an opening book file, followed by `entry_count` entries.
+ *
+ * Book files are read in place, so they use the byte order of the engine (little endian on
+ * x86-64 and in WASM). `start_key` is the hash of `new_state()`, a book built with different
+ * Zobrist keys is rejected rather than probed with keys that mean something else.
+ */
+struct OpeningBookHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t entry_count;
+    uint64_t start_key;
+};
+
+/**
+ * @struct OpeningBookEntry
+ * @brief A move of a book position.
+ *
+ * Entries are sorted by key, and the moves of a position by decreasing weight. The weight of a
+ * move is its share of the times the position is played from the book.
+ */
+struct OpeningBookEntry {
+    uint64_t key;  // Zobrist hash of the position.
+    uint16_t weight;
+    EncodedMove move;
+    uint8_t reserved[5];
+};
+
+/**
+ * @brief Maps an opening book file into memory and uses it for the following probes.
+ *
+ * The file is not copied, the entries are read straight from the mapping. A book that was
+ * already in use is closed.
+ *
+ * @param path Path of the book file.
+ * @return True if the book was loaded, false if the file cannot be mapped or is not a valid book.
+ */
+bool load_opening_book(const char *path);
+
+/**
+ * @brief Uses an opening book that is already in memory, e.g. embedded in the program.
+ *
+ * @param data The book, in the file format and aligned to 8 bytes. It must stay valid while the
+ *             book is in use.
+ * @param size Size of the book in bytes.
+ * @return True if the book is used, false if it is not a valid book.
+ */
+bool use_opening_book(const void *data, size_t size);
+
+/**
+ * @brief Stops using the current opening book, unmapping it if it was loaded from a file.
+ */
+void close_opening_book();
+
+/**
+ * @brief Looks up a position in the opening book.
+ *
+ * One of the legal book moves of the position is picked at random, in proportion to its weight.
+ * In WASM builds the embedded book is used if no other book has been loaded.
+ *
+ * @param state The game state, its hash must be up to date.
+ * @param move Pointer to where the book move is stored.
+ * @return True if the position is in the book, false otherwise.
+ */
+bool probe_opening_book(const struct State *state, struct Move *move);
+
+#endif //QUORIDOR_OPENING_BOOK_H
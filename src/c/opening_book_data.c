@@ -0,0 +1,129 @@
+// Generated by `quoridor_book export opening_book.bin`, do not edit.
+#include <stddef.h>
+
+_Alignas(8) const unsigned char opening_book_data[] = {
+        0x51, 0x42, 0x4f, 0x4f, 0x4b, 0x0d, 0x0a, 0x1a, 0x01, 0x00, 0x00, 0x00, 0x78, 0x00, 0x00, 0x00,
+        0xdf, 0x27, 0x24, 0xcf, 0xe4, 0x71, 0xbe, 0x83, 0xef, 0xec, 0xa6, 0x27, 0x1f, 0x49, 0xd9, 0x08,
+        0x03, 0x00, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0xef, 0xec, 0xa6, 0x27, 0x1f, 0x49, 0xd9, 0x08,
+        0x03, 0x00, 0x83, 0x00, 0x00, 0x00, 0x00, 0x00, 0xef, 0xec, 0xa6, 0x27, 0x1f, 0x49, 0xd9, 0x08,
+        0x03, 0x00, 0x8b, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1f, 0x61, 0x0b, 0x74, 0x2f, 0xf4, 0x60, 0x09,
+        0x03, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1f, 0x61, 0x0b, 0x74, 0x2f, 0xf4, 0x60, 0x09,
+        0x03, 0x00, 0x5c, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1f, 0x61, 0x0b, 0x74, 0x2f, 0xf4, 0x60, 0x09,
+        0x03, 0x00, 0x64, 0x00, 0x00, 0x00, 0x00, 0x00, 0xaf, 0x4b, 0xa8, 0xd6, 0x1c, 0xa5, 0x4f, 0x17,
+        0x03, 0x00, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0xaf, 0x4b, 0xa8, 0xd6, 0x1c, 0xa5, 0x4f, 0x17,
+        0x01, 0x00, 0x50, 0x00, 0x00, 0x00, 0x00, 0x00, 0xaf, 0x4b, 0xa8, 0xd6, 0x1c, 0xa5, 0x4f, 0x17,
+        0x01, 0x00, 0x51, 0x00, 0x00, 0x00, 0x00, 0x00, 0x3c, 0x31, 0x30, 0xfc, 0xab, 0x36, 0x68, 0x18,
+        0x03, 0x00, 0x57, 0x00, 0x00, 0x00, 0x00, 0x00, 0x3c, 0x31, 0x30, 0xfc, 0xab, 0x36, 0x68, 0x18,
+        0x01, 0x00, 0x50, 0x00, 0x00, 0x00, 0x00, 0x00, 0x3c, 0x31, 0x30, 0xfc, 0xab, 0x36, 0x68, 0x18,
+        0x01, 0x00, 0x5c, 0x00, 0x00, 0x00, 0x00, 0x00, 0x63, 0x3d, 0xe2, 0xe3, 0x51, 0x90, 0xed, 0x1a,
+        0x03, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x63, 0x3d, 0xe2, 0xe3, 0x51, 0x90, 0xed, 0x1a,
+        0x03, 0x00, 0x54, 0x00, 0x00, 0x00, 0x00, 0x00, 0x63, 0x3d, 0xe2, 0xe3, 0x51, 0x90, 0xed, 0x1a,
+        0x03, 0x00, 0x5c, 0x00, 0x00, 0x00, 0x00, 0x00, 0x13, 0xb2, 0xbd, 0x04, 0xf8, 0xca, 0x59, 0x1c,
+        0x03, 0x00, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x13, 0xb2, 0xbd, 0x04, 0xf8, 0xca, 0x59, 0x1c,
+        0x03, 0x00, 0x8d, 0x00, 0x00, 0x00, 0x00, 0x00, 0x13, 0xb2, 0xbd, 0x04, 0xf8, 0xca, 0x59, 0x1c,
+        0x01, 0x00, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x5d, 0xe6, 0x72, 0x9f, 0x6d, 0x0c, 0x2a, 0x35,
+        0x03, 0x00, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x5d, 0xe6, 0x72, 0x9f, 0x6d, 0x0c, 0x2a, 0x35,
+        0x03, 0x00, 0x52, 0x00, 0x00, 0x00, 0x00, 0x00, 0x5d, 0xe6, 0x72, 0x9f, 0x6d, 0x0c, 0x2a, 0x35,
+        0x03, 0x00, 0x53, 0x00, 0x00, 0x00, 0x00, 0x00, 0xa4, 0x5f, 0x0c, 0xd4, 0x75, 0x17, 0xad, 0x40,
+        0x03, 0x00, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0xa4, 0x5f, 0x0c, 0xd4, 0x75, 0x17, 0xad, 0x40,
+        0x03, 0x00, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0xa4, 0x5f, 0x0c, 0xd4, 0x75, 0x17, 0xad, 0x40,
+        0x03, 0x00, 0x51, 0x00, 0x00, 0x00, 0x00, 0x00, 0xe3, 0xfb, 0x22, 0xdc, 0x81, 0xdc, 0x08, 0x42,
+        0x03, 0x00, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0xe3, 0xfb, 0x22, 0xdc, 0x81, 0xdc, 0x08, 0x42,
+        0x03, 0x00, 0x54, 0x00, 0x00, 0x00, 0x00, 0x00, 0xe3, 0xfb, 0x22, 0xdc, 0x81, 0xdc, 0x08, 0x42,
+        0x03, 0x00, 0x55, 0x00, 0x00, 0x00, 0x00, 0x00, 0x98, 0xb8, 0x17, 0x0d, 0x0b, 0x94, 0xad, 0x42,
+        0x03, 0x00, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x98, 0xb8, 0x17, 0x0d, 0x0b, 0x94, 0xad, 0x42,
+        0x03, 0x00, 0x52, 0x00, 0x00, 0x00, 0x00, 0x00, 0x98, 0xb8, 0x17, 0x0d, 0x0b, 0x94, 0xad, 0x42,
+        0x03, 0x00, 0x53, 0x00, 0x00, 0x00, 0x00, 0x00, 0x51, 0xcb, 0xeb, 0x7d, 0x73, 0xfa, 0x83, 0x57,
+        0x03, 0x00, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x51, 0xcb, 0xeb, 0x7d, 0x73, 0xfa, 0x83, 0x57,
+        0x03, 0x00, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x51, 0xcb, 0xeb, 0x7d, 0x73, 0xfa, 0x83, 0x57,
+        0x03, 0x00, 0x50, 0x00, 0x00, 0x00, 0x00, 0x00, 0x56, 0x89, 0xba, 0xec, 0xe8, 0x50, 0x32, 0x5c,
+        0x03, 0x00, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x56, 0x89, 0xba, 0xec, 0xe8, 0x50, 0x32, 0x5c,
+        0x03, 0x00, 0x5b, 0x00, 0x00, 0x00, 0x00, 0x00, 0x56, 0x89, 0xba, 0xec, 0xe8, 0x50, 0x32, 0x5c,
+        0x03, 0x00, 0x5c, 0x00, 0x00, 0x00, 0x00, 0x00, 0x6c, 0x20, 0x0d, 0xfb, 0x55, 0x61, 0x85, 0x64,
+        0x03, 0x00, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x6c, 0x20, 0x0d, 0xfb, 0x55, 0x61, 0x85, 0x64,
+        0x01, 0x00, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x6c, 0x20, 0x0d, 0xfb, 0x55, 0x61, 0x85, 0x64,
+        0x01, 0x00, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0xd6, 0x80, 0x1c, 0xa1, 0x4b, 0x18, 0xad, 0x76,
+        0x03, 0x00, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0xd6, 0x80, 0x1c, 0xa1, 0x4b, 0x18, 0xad, 0x76,
+        0x03, 0x00, 0x5c, 0x00, 0x00, 0x00, 0x00, 0x00, 0xd6, 0x80, 0x1c, 0xa1, 0x4b, 0x18, 0xad, 0x76,
+        0x03, 0x00, 0x64, 0x00, 0x00, 0x00, 0x00, 0x00, 0x8b, 0x99, 0x85, 0x9d, 0xc0, 0x19, 0xe8, 0x7a,
+        0x03, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x8b, 0x99, 0x85, 0x9d, 0xc0, 0x19, 0xe8, 0x7a,
+        0x03, 0x00, 0x5b, 0x00, 0x00, 0x00, 0x00, 0x00, 0x8b, 0x99, 0x85, 0x9d, 0xc0, 0x19, 0xe8, 0x7a,
+        0x03, 0x00, 0x63, 0x00, 0x00, 0x00, 0x00, 0x00, 0x24, 0xea, 0x6e, 0x95, 0xb0, 0x4d, 0xe2, 0x7c,
+        0x03, 0x00, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x24, 0xea, 0x6e, 0x95, 0xb0, 0x4d, 0xe2, 0x7c,
+        0x01, 0x00, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x24, 0xea, 0x6e, 0x95, 0xb0, 0x4d, 0xe2, 0x7c,
+        0x01, 0x00, 0x50, 0x00, 0x00, 0x00, 0x00, 0x00, 0x71, 0xcf, 0x6e, 0xcc, 0x62, 0x30, 0xbd, 0x7d,
+        0x03, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x71, 0xcf, 0x6e, 0xcc, 0x62, 0x30, 0xbd, 0x7d,
+        0x03, 0x00, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x71, 0xcf, 0x6e, 0xcc, 0x62, 0x30, 0xbd, 0x7d,
+        0x03, 0x00, 0x53, 0x00, 0x00, 0x00, 0x00, 0x00, 0xa2, 0x5c, 0xa8, 0x5f, 0x0a, 0x12, 0xea, 0x7e,
+        0x03, 0x00, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0xa2, 0x5c, 0xa8, 0x5f, 0x0a, 0x12, 0xea, 0x7e,
+        0x03, 0x00, 0x5b, 0x00, 0x00, 0x00, 0x00, 0x00, 0xa2, 0x5c, 0xa8, 0x5f, 0x0a, 0x12, 0xea, 0x7e,
+        0x03, 0x00, 0x63, 0x00, 0x00, 0x00, 0x00, 0x00, 0x29, 0xb9, 0x67, 0xd8, 0xdf, 0xe0, 0x78, 0x81,
+        0x03, 0x00, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x29, 0xb9, 0x67, 0xd8, 0xdf, 0xe0, 0x78, 0x81,
+        0x03, 0x00, 0x52, 0x00, 0x00, 0x00, 0x00, 0x00, 0x29, 0xb9, 0x67, 0xd8, 0xdf, 0xe0, 0x78, 0x81,
+        0x03, 0x00, 0x53, 0x00, 0x00, 0x00, 0x00, 0x00, 0xdf, 0x27, 0x24, 0xcf, 0xe4, 0x71, 0xbe, 0x83,
+        0x03, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0xdf, 0x27, 0x24, 0xcf, 0xe4, 0x71, 0xbe, 0x83,
+        0x01, 0x00, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0xdf, 0x27, 0x24, 0xcf, 0xe4, 0x71, 0xbe, 0x83,
+        0x01, 0x00, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0xd5, 0xfc, 0x62, 0xcd, 0x76, 0xe5, 0x52, 0x85,
+        0x03, 0x00, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0xd5, 0xfc, 0x62, 0xcd, 0x76, 0xe5, 0x52, 0x85,
+        0x03, 0x00, 0x52, 0x00, 0x00, 0x00, 0x00, 0x00, 0xd5, 0xfc, 0x62, 0xcd, 0x76, 0xe5, 0x52, 0x85,
+        0x03, 0x00, 0x5a, 0x00, 0x00, 0x00, 0x00, 0x00, 0x26, 0xa7, 0x21, 0xcc, 0x73, 0x6b, 0x1a, 0x8d,
+        0x03, 0x00, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x26, 0xa7, 0x21, 0xcc, 0x73, 0x6b, 0x1a, 0x8d,
+        0x03, 0x00, 0x55, 0x00, 0x00, 0x00, 0x00, 0x00, 0x26, 0xa7, 0x21, 0xcc, 0x73, 0x6b, 0x1a, 0x8d,
+        0x03, 0x00, 0x57, 0x00, 0x00, 0x00, 0x00, 0x00, 0xf3, 0x72, 0x47, 0x65, 0x82, 0xbe, 0x7e, 0x8e,
+        0x03, 0x00, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0xf3, 0x72, 0x47, 0x65, 0x82, 0xbe, 0x7e, 0x8e,
+        0x03, 0x00, 0x50, 0x00, 0x00, 0x00, 0x00, 0x00, 0xf3, 0x72, 0x47, 0x65, 0x82, 0xbe, 0x7e, 0x8e,
+        0x03, 0x00, 0x51, 0x00, 0x00, 0x00, 0x00, 0x00, 0xd9, 0xad, 0x84, 0xd6, 0x01, 0xe0, 0xac, 0xa2,
+        0x03, 0x00, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0xd9, 0xad, 0x84, 0xd6, 0x01, 0xe0, 0xac, 0xa2,
+        0x03, 0x00, 0x84, 0x00, 0x00, 0x00, 0x00, 0x00, 0xd9, 0xad, 0x84, 0xd6, 0x01, 0xe0, 0xac, 0xa2,
+        0x03, 0x00, 0x8c, 0x00, 0x00, 0x00, 0x00, 0x00, 0xd3, 0x76, 0xc2, 0xd4, 0x93, 0x74, 0x40, 0xa4,
+        0x03, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0xd3, 0x76, 0xc2, 0xd4, 0x93, 0x74, 0x40, 0xa4,
+        0x03, 0x00, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0xd3, 0x76, 0xc2, 0xd4, 0x93, 0x74, 0x40, 0xa4,
+        0x03, 0x00, 0x53, 0x00, 0x00, 0x00, 0x00, 0x00, 0x86, 0xdb, 0x9b, 0xa2, 0x95, 0xad, 0xcc, 0xa4,
+        0x03, 0x00, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x86, 0xdb, 0x9b, 0xa2, 0x95, 0xad, 0xcc, 0xa4,
+        0x03, 0x00, 0x50, 0x00, 0x00, 0x00, 0x00, 0x00, 0x86, 0xdb, 0x9b, 0xa2, 0x95, 0xad, 0xcc, 0xa4,
+        0x03, 0x00, 0x51, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1f, 0x00, 0x88, 0xe1, 0xde, 0x41, 0xe2, 0xa9,
+        0x03, 0x00, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1f, 0x00, 0x88, 0xe1, 0xde, 0x41, 0xe2, 0xa9,
+        0x01, 0x00, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1f, 0x00, 0x88, 0xe1, 0xde, 0x41, 0xe2, 0xa9,
+        0x01, 0x00, 0x50, 0x00, 0x00, 0x00, 0x00, 0x00, 0x63, 0x5c, 0x61, 0x76, 0xa0, 0x25, 0x6f, 0xba,
+        0x03, 0x00, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x63, 0x5c, 0x61, 0x76, 0xa0, 0x25, 0x6f, 0xba,
+        0x03, 0x00, 0x51, 0x00, 0x00, 0x00, 0x00, 0x00, 0x63, 0x5c, 0x61, 0x76, 0xa0, 0x25, 0x6f, 0xba,
+        0x03, 0x00, 0x52, 0x00, 0x00, 0x00, 0x00, 0x00, 0x79, 0x50, 0xf6, 0x34, 0x42, 0xb8, 0x8d, 0xc0,
+        0x03, 0x00, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x79, 0x50, 0xf6, 0x34, 0x42, 0xb8, 0x8d, 0xc0,
+        0x03, 0x00, 0x50, 0x00, 0x00, 0x00, 0x00, 0x00, 0x79, 0x50, 0xf6, 0x34, 0x42, 0xb8, 0x8d, 0xc0,
+        0x03, 0x00, 0x52, 0x00, 0x00, 0x00, 0x00, 0x00, 0x05, 0x0c, 0x1f, 0xa3, 0x3c, 0xdc, 0x00, 0xd3,
+        0x03, 0x00, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x05, 0x0c, 0x1f, 0xa3, 0x3c, 0xdc, 0x00, 0xd3,
+        0x03, 0x00, 0x8a, 0x00, 0x00, 0x00, 0x00, 0x00, 0x05, 0x0c, 0x1f, 0xa3, 0x3c, 0xdc, 0x00, 0xd3,
+        0x01, 0x00, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x9c, 0x59, 0xdb, 0x10, 0x0d, 0xf6, 0xf0, 0xd4,
+        0x03, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x9c, 0x59, 0xdb, 0x10, 0x0d, 0xf6, 0xf0, 0xd4,
+        0x03, 0x00, 0x55, 0x00, 0x00, 0x00, 0x00, 0x00, 0x9c, 0x59, 0xdb, 0x10, 0x0d, 0xf6, 0xf0, 0xd4,
+        0x03, 0x00, 0x5d, 0x00, 0x00, 0x00, 0x00, 0x00, 0x6b, 0x1c, 0x7b, 0x4d, 0x5c, 0x9f, 0xbb, 0xd6,
+        0x03, 0x00, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x6b, 0x1c, 0x7b, 0x4d, 0x5c, 0x9f, 0xbb, 0xd6,
+        0x03, 0x00, 0x5a, 0x00, 0x00, 0x00, 0x00, 0x00, 0x6b, 0x1c, 0x7b, 0x4d, 0x5c, 0x9f, 0xbb, 0xd6,
+        0x03, 0x00, 0x5b, 0x00, 0x00, 0x00, 0x00, 0x00, 0xe8, 0x85, 0x6f, 0xee, 0x4c, 0xfc, 0xb7, 0xdc,
+        0x03, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0xe8, 0x85, 0x6f, 0xee, 0x4c, 0xfc, 0xb7, 0xdc,
+        0x03, 0x00, 0x52, 0x00, 0x00, 0x00, 0x00, 0x00, 0xe8, 0x85, 0x6f, 0xee, 0x4c, 0xfc, 0xb7, 0xdc,
+        0x03, 0x00, 0x5a, 0x00, 0x00, 0x00, 0x00, 0x00, 0xe6, 0xc2, 0x9a, 0xdb, 0x2a, 0xb4, 0x9f, 0xe2,
+        0x03, 0x00, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0xe6, 0xc2, 0x9a, 0xdb, 0x2a, 0xb4, 0x9f, 0xe2,
+        0x03, 0x00, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0xe6, 0xc2, 0x9a, 0xdb, 0x2a, 0xb4, 0x9f, 0xe2,
+        0x03, 0x00, 0x54, 0x00, 0x00, 0x00, 0x00, 0x00, 0xa6, 0xbd, 0x64, 0x42, 0x0c, 0x70, 0xb7, 0xe8,
+        0x03, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0xa6, 0xbd, 0x64, 0x42, 0x0c, 0x70, 0xb7, 0xe8,
+        0x03, 0x00, 0x8a, 0x00, 0x00, 0x00, 0x00, 0x00, 0xa6, 0xbd, 0x64, 0x42, 0x0c, 0x70, 0xb7, 0xe8,
+        0x03, 0x00, 0x8b, 0x00, 0x00, 0x00, 0x00, 0x00, 0xeb, 0xa9, 0x19, 0x0c, 0x99, 0xc5, 0xf4, 0xea,
+        0x03, 0x00, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0xeb, 0xa9, 0x19, 0x0c, 0x99, 0xc5, 0xf4, 0xea,
+        0x01, 0x00, 0x50, 0x00, 0x00, 0x00, 0x00, 0x00, 0xeb, 0xa9, 0x19, 0x0c, 0x99, 0xc5, 0xf4, 0xea,
+        0x01, 0x00, 0x51, 0x00, 0x00, 0x00, 0x00, 0x00, 0xbe, 0x8c, 0x19, 0x55, 0x4b, 0xb8, 0xab, 0xeb,
+        0x03, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0xbe, 0x8c, 0x19, 0x55, 0x4b, 0xb8, 0xab, 0xeb,
+        0x03, 0x00, 0x53, 0x00, 0x00, 0x00, 0x00, 0x00, 0xbe, 0x8c, 0x19, 0x55, 0x4b, 0xb8, 0xab, 0xeb,
+        0x03, 0x00, 0x5b, 0x00, 0x00, 0x00, 0x00, 0x00, 0x11, 0xff, 0xf2, 0x5d, 0x3b, 0xec, 0xa1, 0xed,
+        0x03, 0x00, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x11, 0xff, 0xf2, 0x5d, 0x3b, 0xec, 0xa1, 0xed,
+        0x03, 0x00, 0x53, 0x00, 0x00, 0x00, 0x00, 0x00, 0x11, 0xff, 0xf2, 0x5d, 0x3b, 0xec, 0xa1, 0xed,
+        0x03, 0x00, 0x54, 0x00, 0x00, 0x00, 0x00, 0x00, 0x41, 0x04, 0xec, 0x24, 0x99, 0x08, 0xda, 0xf6,
+        0x03, 0x00, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x41, 0x04, 0xec, 0x24, 0x99, 0x08, 0xda, 0xf6,
+        0x03, 0x00, 0x55, 0x00, 0x00, 0x00, 0x00, 0x00, 0x41, 0x04, 0xec, 0x24, 0x99, 0x08, 0xda, 0xf6,
+        0x03, 0x00, 0x5d, 0x00, 0x00, 0x00, 0x00, 0x00, 0xe5, 0x70, 0x48, 0x53, 0xe1, 0xe5, 0x81, 0xfd,
+        0x03, 0x00, 0x50, 0x00, 0x00, 0x00, 0x00, 0x00, 0xe5, 0x70, 0x48, 0x53, 0xe1, 0xe5, 0x81, 0xfd,
+        0x01, 0x00, 0x57, 0x00, 0x00, 0x00, 0x00, 0x00, 0xe5, 0x70, 0x48, 0x53, 0xe1, 0xe5, 0x81, 0xfd,
+        0x01, 0x00, 0x5b, 0x00, 0x00, 0x00, 0x00, 0x00,
+};
+
+const size_t opening_book_data_size = 1944;
@@ -1,22 +1,359 @@
 #include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <time.h>
+#include <math.h>
 
 #include "search.h"
 #include "move_generation.h"
 #include "evaluate.h"
+#include "transposition_table.h"
+#include "opening_book.h"
+#include "endgame.h"
 
 /**
- * @brief Initializes an array of moves to a default "no move" state.
+ * @struct SearchStack
+ * @brief Per ply data of a search, allocated once per search so that nodes keep no arrays in
+ * their own stack frames, the stack being small in WASM.
  *
- * This function sets each element of the provided move list to a
- * default state indicating that no valid move is stored there.
+ * The principal variation is kept in a triangular table: `pv[ply]` holds the line of
+ * `pv_length[ply]` moves found from the node at `ply`. A node that raises alpha stores its move
+ * followed by the line of that move's child, so lines are only copied when they improve.
+ */
+struct SearchStack {
+    struct MoveList move_lists[MAX_SEARCH_DEPTH + 1];
+    struct Move pv[MAX_SEARCH_DEPTH + 1][MAX_SEARCH_DEPTH + 1];
+    int pv_length[MAX_SEARCH_DEPTH + 1];
+    struct Move previous_pv[MAX_SEARCH_DEPTH + 1];  // Line of the last completed iteration, searched first.
+    int previous_pv_length;
+    bool null_move[MAX_SEARCH_DEPTH + 1];  // Whether the node at each ply was reached by a null move.
+};
+
+/**
+ * @struct SearchContext
+ * @brief State owned by a single search thread.
+ */
+struct SearchContext {
+    uint64_t nodes;
+    atomic_bool *stop;  // Shared by every thread of a search, set when the search should be abandoned.
+    struct SearchOptions options;
+    struct SearchStack *stack;
+
+    // Addresses of the frame the search was started from and of the deepest node's frame.
+    uintptr_t stack_base;
+    uintptr_t stack_low;
+
+    // Only the main thread checks the budget, the helpers are stopped through `stop`.
+    bool check_budget;
+    bool can_abort;     // False until the first iteration completes, so that a move is always found.
+    uint64_t node_limit;
+    double deadline_ms;
+
+    // Move ordering, kept for the whole search.
+    EncodedMove killer_moves[MAX_SEARCH_DEPTH + 1][2];
+    uint32_t history[2][ENCODED_MOVE_COUNT];  // Indexed by player - 1.
+
+    struct SearchDepthStats counters;  // Of the current iteration.
+    struct SearchStats *stats;         // Where the iterations are recorded, NULL for helpers.
+};
+
+#ifdef QUORIDOR_SEARCH_STATS
+#define add_search_stat(ctx, counter, value) ((ctx)->counters.counter += (value))
+#else
+#define add_search_stat(ctx, counter, value) ((void) (value))
+#endif
+
+// The layout of the statistics is read by WasmUtils.ts.
+_Static_assert(sizeof(struct SearchDepthStats) == 80, "SearchDepthStats layout must match WasmUtils.ts.");
+
+static _Thread_local struct SearchStats last_search_stats;
+
+// Search engines allocated and not freed yet, whose transposition table entries are kept.
+static _Atomic int live_search_engines = 0;
+
+// Options of the `get_best_move_*` searches. Selective search techniques are only enabled once a
+// match (`quoridor_match --sprt`) has shown that they make the engine stronger.
+static const struct SearchOptions default_search_options = {
+        .aspiration_window = DEFAULT_ASPIRATION_WINDOW,
+        .late_move_reductions = true,
+};
+
+// Move ordering scores, history scores are kept below `HISTORY_SCORE_MAX` so that they only order
+// moves within the static classes.
+#define KILLER_MOVE_SCORE (1 << 20)
+#define PATH_FENCE_SCORE (1 << 16)
+#define PAWN_ADVANCE_SCORE (1 << 15)
+#define HISTORY_SCORE_MAX (1 << 15)
+
+// Remaining depth from which a fenceless endgame is solved rather than searched. Solving new
+// fences costs as much as searching a few thousand nodes, while the last fence of a line is
+// placed at nodes all over the tree, each leaving different fences.
+#define ENDGAME_SOLVE_MIN_DEPTH 6
+
+// Late move reductions: quiet fences from this index of the move list on are searched to a
+// reduced depth, one ply less, or two in nodes off the principal variation from the deep index on.
+#define LMR_MIN_DEPTH 3
+#define LMR_MIN_MOVE_INDEX 3
+#define LMR_DEEP_MOVE_INDEX 12
+
+// Null move pruning: the null move is searched this many plies shallower than the other moves,
+// one more from `NULL_MOVE_DEEP_DEPTH` on.
+#define NULL_MOVE_MIN_DEPTH 3
+#define NULL_MOVE_REDUCTION 2
+#define NULL_MOVE_DEEP_DEPTH 7
+
+// Futility pruning: how much a quiet fence's score may still rise per ply of remaining depth
+// beyond the first, a path length difference of one changes the evaluation by 2.
+#define FUTILITY_MAX_DEPTH 2
+#define FUTILITY_MARGIN 4
+
+/**
+ * @brief Converts the exact outcome of an endgame into the score the search would give it, with
+ * the same depth adjustment as the wins it finds itself.
+ */
+static inline int endgame_score(int outcome, int depth) {
+    if (outcome == ENDGAME_DRAW) {
+        return 0;
+    }
+    return outcome > 0 ? WINNING_SCORE + depth - outcome : -(WINNING_SCORE + depth + outcome);
+}
+
+#define search_stopped(ctx) atomic_load_explicit((ctx)->stop, memory_order_relaxed)
+
+static double get_time_ms(void) {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (double) time.tv_sec * 1000.0 + (double) time.tv_nsec / 1e6;
+}
+
+/**
+ * @brief Counts a node and stops the search if it has run out of its budget.
+ *
+ * The node limit is checked at every node, the clock only every `SEARCH_BUDGET_CHECK_INTERVAL`
+ * nodes.
+ */
+static inline void count_node(struct SearchContext *ctx) {
+    ctx->nodes++;
+
+    if (!ctx->check_budget || !ctx->can_abort) {
+        return;
+    }
+
+    if (ctx->nodes >= ctx->node_limit ||
+        (ctx->nodes % SEARCH_BUDGET_CHECK_INTERVAL == 0 && get_time_ms() >= ctx->deadline_ms)) {
+        atomic_store_explicit(ctx->stop, true, memory_order_relaxed);
+    }
+}
+
+/**
+ * @brief Stops the search if it has run out of time, after work that takes as long as many nodes.
+ */
+static inline void check_deadline(struct SearchContext *ctx) {
+    if (ctx->check_budget && ctx->can_abort && get_time_ms() >= ctx->deadline_ms) {
+        atomic_store_explicit(ctx->stop, true, memory_order_relaxed);
+    }
+}
+
+/**
+ * @brief Allocates the stack of a search, exits if the allocation fails.
+ */
+static struct SearchStack *allocate_search_stack(void) {
+    struct SearchStack *stack = malloc(sizeof(struct SearchStack));
+
+    if (stack == NULL) {
+        exit(1);  // malloc failed, should probably log this somehow.
+    }
+
+    stack->previous_pv_length = 0;
+    return stack;
+}
+
+/**
+ * @brief Sets the principal variation of a node to a move followed by the line of its child.
+ *
+ * @param stack The stack of the search.
+ * @param ply Distance of the node from the root of the search.
+ * @param move The move leading to the child searched last.
+ */
+static inline void update_pv(struct SearchStack *stack, int ply, struct Move move) {
+    stack->pv[ply][0] = move;
+    memcpy(&stack->pv[ply][1], stack->pv[ply + 1], sizeof(struct Move) * stack->pv_length[ply + 1]);
+    stack->pv_length[ply] = stack->pv_length[ply + 1] + 1;
+}
+
+/**
+ * @brief Stores the result of a search in the transposition table.
+ *
+ * Nothing is stored if the search was stopped, as the result may be incomplete.
+ *
+ * @param ctx The search context of the calling thread.
+ * @param key The Zobrist hash of the searched game state.
+ * @param depth The remaining depth the state was searched to.
+ * @param alpha The alpha value the search of this state started with.
+ * @param beta The beta value of the search window.
+ * @param best_move The best move found along with its score.
+ */
+static inline void store_search_result(struct SearchContext *ctx, uint64_t key, int depth, int alpha, int beta,
+                                       const struct Move *best_move) {
+    if (best_move->moveType == None || search_stopped(ctx)) {
+        return;
+    }
+
+    enum Bound bound = BoundExact;
+    if (best_move->score <= alpha) {
+        bound = BoundUpper;
+    } else if (best_move->score >= beta) {
+        bound = BoundLower;
+    }
+
+    store_transposition_table_entry(key, depth, bound, best_move->score, *best_move);
+}
+
+/**
+ * @brief Checks whether a move is pseudo-legal given the move masks of a state.
+ */
+static inline bool move_in_masks(const struct Move *move, PawnMoves pawn_moves, FenceMoves vertical_fence_moves,
+                                 FenceMoves horizontal_fence_moves) {
+    return (move->moveType == Pawn && move->move.pawnMove & pawn_moves) ||
+           (move->moveType == VerticalFence && move->move.fenceMove & vertical_fence_moves) ||
+           (move->moveType == HorizontalFence && move->move.fenceMove & horizontal_fence_moves);
+}
+
+/**
+ * @brief Finds the fences that cut a shortest path of a player to their goal.
+ *
+ * The path is followed from the player's square down the distance field, taking the first
+ * neighbour that is one step closer to the goal.
+ *
+ * @param state The game state.
+ * @param distances Distances from every square to the player's goal row.
+ * @param row Row of the player.
+ * @param col Column of the player.
+ * @param vertical_fences Pointer to where the mask of vertical fences cutting the path is stored.
+ * @param horizontal_fences Pointer to where the mask of horizontal fences cutting the path is stored.
+ */
+static void find_shortest_path_fences(const struct State *state, const uint8_t *distances, int row, int col,
+                                      FenceMoves *vertical_fences, FenceMoves *horizontal_fences) {
+    *vertical_fences = 0;
+    *horizontal_fences = 0;
+
+    if (distances[row * BOARD_SIZE + col] == DISTANCE_UNREACHABLE) {
+        return;
+    }
+
+    for (int distance = distances[row * BOARD_SIZE + col]; distance > 0; distance--) {
+        const __uint128_t square = square128(12 + row * 11 + col);
+        const int fence_row_low = row > 0 ? row - 1 : 0;
+        const int fence_row_high = row < FENCE_BIT_BOARD_WIDTH ? row : FENCE_BIT_BOARD_WIDTH - 1;
+        const int fence_col_low = col > 0 ? col - 1 : 0;
+        const int fence_col_high = col < FENCE_BIT_BOARD_WIDTH ? col : FENCE_BIT_BOARD_WIDTH - 1;
+
+        // A step between rows is cut by the horizontal fences on either side of the column, a step
+        // between columns by the vertical fences on either side of the row.
+        if (row > 0 && distances[(row - 1) * BOARD_SIZE + col] == distance - 1 &&
+            !(bitboard_up(square) & state->bitboards.up_fences)) {
+            *horizontal_fences |= create_fence_move(row - 1, fence_col_low) | create_fence_move(row - 1, fence_col_high);
+            row--;
+        } else if (row < BOARD_SIZE - 1 && distances[(row + 1) * BOARD_SIZE + col] == distance - 1 &&
+                   !(bitboard_down(square) & state->bitboards.down_fences)) {
+            *horizontal_fences |= create_fence_move(row, fence_col_low) | create_fence_move(row, fence_col_high);
+            row++;
+        } else if (col > 0 && distances[row * BOARD_SIZE + col - 1] == distance - 1 &&
+                   !(bitboard_left(square) & state->bitboards.left_fences)) {
+            *vertical_fences |= create_fence_move(fence_row_low, col - 1) | create_fence_move(fence_row_high, col - 1);
+            col--;
+        } else {
+            *vertical_fences |= create_fence_move(fence_row_low, col) | create_fence_move(fence_row_high, col);
+            col++;
+        }
+    }
+}
+
+/**
+ * @brief Scores the moves of a node for move ordering.
+ *
+ * - Killer moves of the ply score highest.
+ * - Fences cutting a shortest path of the opponent get a static bonus.
+ * - Pawn moves that bring the player closer to their goal get a smaller static bonus.
+ * - All moves add their history score.
+ *
+ * @param ctx The search context of the calling thread.
+ * @param state The game state.
+ * @param ply Distance from the root of the search.
+ * @param move_list The moves to score.
+ */
+static void score_moves(const struct SearchContext *ctx, const struct State *state, int ply,
+                        struct MoveList *move_list) {
+    struct GoalDistances distances;
+    get_goal_distances(state, &distances);
+
+    const bool player_1_to_move = state->player_to_move == 1;
+    const uint8_t *own_distances = player_1_to_move ? distances.to_player_1_goal : distances.to_player_2_goal;
+    const int own_row = player_1_to_move ? state->player_1_row : state->player_2_row;
+    const int own_col = player_1_to_move ? state->player_1_col : state->player_2_col;
+    const uint32_t *history = ctx->history[state->player_to_move - 1];
+    const EncodedMove *killer_moves = ctx->killer_moves[ply];
+
+    FenceMoves path_vertical_fences, path_horizontal_fences;
+    if (player_1_to_move) {
+        find_shortest_path_fences(state, distances.to_player_2_goal, state->player_2_row, state->player_2_col,
+                                  &path_vertical_fences, &path_horizontal_fences);
+    } else {
+        find_shortest_path_fences(state, distances.to_player_1_goal, state->player_1_row, state->player_1_col,
+                                  &path_vertical_fences, &path_horizontal_fences);
+    }
+
+    for (int i = 0; i < move_list->count; i++) {
+        const EncodedMove move = move_list->moves[i].move;
+        int32_t score = (int32_t) history[move];
+
+        if (move == killer_moves[0]) {
+            score += KILLER_MOVE_SCORE;
+        } else if (move == killer_moves[1]) {
+            score += KILLER_MOVE_SCORE / 2;
+        } else if (move >= ENCODED_HORIZONTAL_FENCE_OFFSET) {
+            score += path_horizontal_fences & square64(move - ENCODED_HORIZONTAL_FENCE_OFFSET) ? PATH_FENCE_SCORE : 0;
+        } else if (move >= ENCODED_VERTICAL_FENCE_OFFSET) {
+            score += path_vertical_fences & square64(move - ENCODED_VERTICAL_FENCE_OFFSET) ? PATH_FENCE_SCORE : 0;
+        } else {
+            const int pawn_move_index = move - ENCODED_PAWN_MOVE_OFFSET;
+            const int row = own_row + pawn_move_row_offsets[pawn_move_index];
+            const int col = own_col + pawn_move_col_offsets[pawn_move_index];
+            score += own_distances[row * BOARD_SIZE + col] < own_distances[own_row * BOARD_SIZE + own_col]
+                     ? PAWN_ADVANCE_SCORE : 0;
+        }
+
+        move_list->moves[i].score = score;
+    }
+}
+
+/**
+ * @brief Updates the killer moves and history after a move caused a beta cutoff.
  *
- * @param move_list Pointer to an array of `struct Move` that will be initialized.
- * @param length The number of moves (array size) to initialize.
+ * @param ctx The search context of the calling thread.
+ * @param player The player who made the move.
+ * @param move The move that caused the cutoff.
+ * @param depth The remaining depth of the node, deeper cutoffs get a larger history bonus.
+ * @param ply Distance from the root of the search.
  */
-static inline void initialize_move_list(struct Move *move_list, int length) {
-    for (int i = 0; i < length; i++) {
-        move_list[i] = (struct Move) { .moveType = None, .score = INT32_MIN + 1 };
+static void update_move_ordering(struct SearchContext *ctx, int player, EncodedMove move, int depth, int ply) {
+    EncodedMove *killer_moves = ctx->killer_moves[ply];
+    uint32_t *history = ctx->history[player - 1];
+
+    if (killer_moves[0] != move) {
+        killer_moves[1] = killer_moves[0];
+        killer_moves[0] = move;
+    }
+
+    history[move] += depth * depth;
+
+    if (history[move] >= HISTORY_SCORE_MAX) {
+        for (int i = 0; i < ENCODED_MOVE_COUNT; i++) {
+            history[i] /= 2;
+        }
     }
 }
 
@@ -27,214 +364,538 @@ static inline void initialize_move_list(struct Move *move_list, int length) {
  * This function attempts to refine the search window on the first move and re-searches if a move
  * falls between alpha and beta, improving the accuracy of the evaluated move.
  *
+ * Positions are looked up in the transposition table before any moves are generated. A deep enough
+ * entry with a usable bound ends the search of the node immediately, otherwise the stored move is
+ * searched first when there is no principal variation move to follow. The remaining moves are
+ * searched in the order given by `score_moves`.
+ *
+ * @param ctx The search context of the calling thread.
  * @param state Pointer to the current game state.
  * @param move The move being evaluated.
  * @param depth The current search depth remaining.
+ * @param reduction Plies the null window search of the move is reduced by, 0 for none. A reduced
+ *                  search that beats alpha is repeated to the full depth.
+ * @param ply Distance from the root of the search.
  * @param alpha Pointer to the current alpha value for the search window (score lower bound).
- * @param beta Pointer to the current beta value for the search window (score upper bound).
+ * @param beta The beta value of the search window (score upper bound).
  * @param first_move Pointer to a boolean flag indicating if this is the first move considered at this node.
- *                   The first move uses a narrower search window, then a full re-search if necessary.
- * @param pv_move Pointer to the principal variation move array (the sequence of best moves found so far).
- * @param best_line Pointer to a move array that will store the best line (principal variation) found.
+ *                   The first move uses the full window, later moves a null window and then a full
+ *                   re-search if necessary.
+ * @param best_move Pointer to the best move found so far at this node, along with its score.
  *
  * @return True if the search should continue, or false if search has been pruned due to a beta cutoff.
  */
-bool search(struct State *state, struct Move move, int depth, int *alpha, const int *beta,
-            bool *first_move, struct Move *pv_move, struct Move best_line[]);
+static bool search(struct SearchContext *ctx, struct State *state, struct Move move, int depth, int reduction, int ply,
+                   int *alpha, int beta, bool *first_move, struct Move *best_move);
 
 /**
  * @brief Conducts a search to find the best moves from a given state.
  *
  * This function performs a recursive alpha-beta search (with principal variation search enhancements)
- * to find the best line of moves starting from the given `state`. It stores the best variation found
- * in `best_line`. The search stops at terminal states or at a depth of 0, at which point the position
- * is evaluated.
+ * to find the best line of moves starting from the given `state`. If the score is inside the
+ * window, the best line found is stored in the principal variation of the ply on the context's
+ * stack. The search stops at terminal states or at a depth of 0, at which point the position is
+ * evaluated. Positions where neither player has a fence left are not searched, their exact
+ * score is looked up with `probe_endgame`, unless their fences would have to be solved for a
+ * subtree too shallow to be worth it. If the search is stopped, it returns as soon as
+ * possible and the result must be discarded.
+ *
+ * The move of the previous iteration's principal variation at the same ply is searched first.
+ *
+ * Nodes off the principal variation may be cut short by the selective search of the context's
+ * options: null move pruning and futility pruning, and late move reductions in every node.
  *
+ * @param ctx The search context of the calling thread.
  * @param state The current game state.
  * @param depth The maximum search depth.
+ * @param ply Distance from the root of the search.
  * @param alpha The lower bound for the search window.
  * @param beta The upper bound for the search window.
- * @param pv_move A pointer to an array of moves representing the current principal variation.
- * @param best_line A pointer to an array of moves where the best sequence of moves will be stored.
+ *
+ * @return The score of the state for the player to move.
  */
- void principal_variation_search(struct State state, int depth, int alpha, int beta, // NOLINT(*-no-recursion)
-                                   struct Move *pv_move,
-                                   struct Move best_line[]) {
+static int principal_variation_search(struct SearchContext *ctx, // NOLINT(*-no-recursion)
+                                      struct State state, int depth, int ply, int alpha, int beta) {
+    struct SearchStack *stack = ctx->stack;
+
+    stack->pv_length[ply] = 0;
+    count_node(ctx);
 
-    initialize_move_list(best_line, depth + 1);
+    const uintptr_t frame = (uintptr_t) __builtin_frame_address(0);
+    if (frame < ctx->stack_low) {
+        ctx->stack_low = frame;
+    }
+
+    if (search_stopped(ctx)) {
+        return 0;
+    }
 
     //  Terminal States...
     if (player_1_win_check(state) || player_2_win_check(state)) {
-        best_line[0] = (struct Move) { .score = -(WINNING_SCORE + depth) };
-        return;
+        return -(WINNING_SCORE + depth);
+    }
+    if (is_fenceless_endgame(state)) {
+        const bool solved = is_endgame_solved(&state);
+
+        if (ply == 0 || depth >= ENDGAME_SOLVE_MIN_DEPTH || solved) {
+            stack->pv_length[ply] = 1;
+            const int outcome = probe_endgame(&state, &stack->pv[ply][0]);
+
+            // Solving takes as long as a thousand nodes, the clock would only be read long after.
+            if (!solved) {
+                check_deadline(ctx);
+            }
+            return endgame_score(outcome, depth);
+        }
     }
     if (depth == 0) {
-        int evaluation = evaluate(state);
-        best_line[0] = (struct Move) { .score = evaluation };
-        return;
+        return evaluate(&state);
     }
 
-    PawnMoves pawn_moves = generate_legal_pawn_moves(state);
-    FenceMoves vertical_fence_moves = generate_pseudo_legal_vertical_fence_moves(state);
-    FenceMoves horizontal_fence_moves = generate_pseudo_legal_horizontal_fence_moves(state);
+    const uint64_t key = state.hash;
+    const int original_alpha = alpha;
+    struct Move hash_move = { .moveType = None };
+    struct TranspositionEntry entry;
 
-    // first_move is used by principal variation search to determine if we do a
-    // narrow window search or a full re-search on the first move.
-    bool first_move = true;
+    if (probe_transposition_table(key, &entry)) {
+        add_search_stat(ctx, transposition_hits, 1);
+        hash_move = decode_move(entry.move);
+        const int score = score_from_transposition_table(entry.score, depth);
 
-    bool pv_move_is_legal =
-            (pv_move->moveType == Pawn && pv_move->move.pawnMove & pawn_moves) ||
-            (pv_move->moveType == VerticalFence && pv_move->move.fenceMove & vertical_fence_moves) ||
-            (pv_move->moveType == HorizontalFence && pv_move->move.fenceMove & horizontal_fence_moves);
+        if (entry.depth >= depth && hash_move.moveType != None &&
+            (entry.bound == BoundExact ||
+             (entry.bound == BoundLower && score >= beta) ||
+             (entry.bound == BoundUpper && score <= alpha))) {
+            add_search_stat(ctx, transposition_cutoffs, 1);
+            stack->pv[ply][0] = hash_move;
+            stack->pv_length[ply] = 1;
 
-    if (pv_move_is_legal) {
-        make_move(&state, pv_move);
+            // The root of a search kept from an earlier move is usually found in the table, its line
+            // is kept rather than cut down to the stored move.
+            if (ply == 0 && stack->previous_pv_length > 1 && encode_move(stack->previous_pv[0]) == entry.move) {
+                memcpy(stack->pv[0], stack->previous_pv, sizeof(struct Move) * stack->previous_pv_length);
+                stack->pv_length[0] = stack->previous_pv_length;
+            }
+            return score;
+        }
+    }
 
-        if (evaluate(state) != NO_PATH_FOUND) {
-            struct Move child_best_move_list[depth];
-            principal_variation_search(state, depth - 1, -beta, -alpha, pv_move + 1, child_best_move_list);
+    // Nodes searched with a null window are expected to fail, only they are pruned.
+    const bool pv_node = alpha + 1 < beta;
+    const bool try_null_move = ctx->options.null_move_pruning && !pv_node && depth >= NULL_MOVE_MIN_DEPTH &&
+                               !stack->null_move[ply] && !is_winning_score(beta);
+    // The fence count condition keeps the children of fences from being fenceless endgames, which
+    // are scored exactly rather than evaluated.
+    const bool try_futility = ctx->options.futility_pruning && !pv_node && depth <= FUTILITY_MAX_DEPTH &&
+                              !is_winning_score(alpha) && state.player_1_fence_count + state.player_2_fence_count > 1;
+    const int static_score = try_null_move || try_futility ? evaluate(&state) : 0;
 
-            int score = -child_best_move_list[0].score;
+    // Null move pruning: if the opponent cannot bring the score below beta even when the player
+    // passes, a real move would almost certainly fail high too. Passing is not a legal move, so
+    // positions where every move is worse than passing (pawn face-offs) are pruned wrongly. Passing
+    // twice in a row would only repeat the node shallower.
+    if (try_null_move && static_score >= beta) {
+        const int reduction = depth >= NULL_MOVE_DEEP_DEPTH ? NULL_MOVE_REDUCTION + 1 : NULL_MOVE_REDUCTION;
 
-            if (score != NO_PATH_FOUND) {
-                first_move = false;
-                best_line[0] = *pv_move;
-                best_line[0].score = score;
-                memcpy(best_line + 1, child_best_move_list, sizeof(struct Move) * (depth - 1));
-                if (score > alpha) {
-                    alpha = score;
-                }
-            }
-
-            if (score >= beta) {
-                return;
-            }
+        make_null_move(&state);
+        stack->null_move[ply + 1] = true;
+        const int score = -principal_variation_search(ctx, state, depth - 1 - reduction, ply + 1, -beta, -beta + 1);
+        stack->null_move[ply + 1] = false;
+        make_null_move(&state);
 
+        if (search_stopped(ctx)) {
+            return 0;
+        }
+        if (score >= beta) {
+            // A win found after passing is not proven, passing not being a move.
+            return is_winning_score(score) ? beta : score;
         }
-
-        unmake_move(&state, pv_move);
     }
 
-    pv_move++;
+    PawnMoves pawn_moves = generate_legal_pawn_moves(&state);
+    FenceMoves vertical_fence_moves, horizontal_fence_moves;
+    const int path_searches = generate_fully_legal_fence_moves(&state, &vertical_fence_moves, &horizontal_fence_moves);
+    add_search_stat(ctx, legality_checks, path_searches);
 
-    while (pawn_moves != 0) {
-        PawnMove pawn_move = 0b1 << __builtin_ctz(pawn_moves);
-        pawn_moves &= pawn_moves - 1;
-        make_pawn_move(&state, pawn_move);
+    if (ctx->options.relevant_fences_only) {
+        filter_relevant_fence_moves(&state, &vertical_fence_moves, &horizontal_fence_moves);
+    }
+
+    // Futility pruning: a fence cutting none of the opponent's shortest paths leaves their path
+    // length unchanged and can only lengthen the player's own, so one ply from the leaves it scores
+    // at most 2 below the static evaluation. Further up, `FUTILITY_MARGIN` per ply is allowed for
+    // the moves in between. These fences are skipped when the bound cannot raise alpha.
+    int futility_score = INT32_MIN + 1;
+    if (try_futility && static_score - 2 + FUTILITY_MARGIN * (depth - 1) <= alpha) {
+        FenceMoves cutting_vertical_fences, cutting_horizontal_fences;
+        find_fences_cutting_shortest_paths(&state, 3 - state.player_to_move, &cutting_vertical_fences,
+                                           &cutting_horizontal_fences);
 
-        if (!search(&state, (struct Move) { .moveType = Pawn, .move.pawnMove = pawn_move },
-                    depth, &alpha, &beta, &first_move, pv_move, best_line)) {
-            return;
+        if ((vertical_fence_moves & ~cutting_vertical_fences) | (horizontal_fence_moves & ~cutting_horizontal_fences)) {
+            futility_score = static_score - 2 + FUTILITY_MARGIN * (depth - 1);
+            vertical_fence_moves &= cutting_vertical_fences;
+            horizontal_fence_moves &= cutting_horizontal_fences;
         }
+    }
+
+    const int player = state.player_to_move;
+    struct Move best_move = { .moveType = None, .score = INT32_MIN + 1 };
+
+    // first_move is used by principal variation search to determine if we do a
+    // narrow window search or a full re-search on the first move.
+    bool first_move = true;
 
-        unmake_pawn_move(&state, pawn_move);
+    // The principal variation move is preferred, the hash move is used when we are off the principal variation.
+    struct Move *first_searched_move = NULL;
+    if (ply < stack->previous_pv_length &&
+        move_in_masks(&stack->previous_pv[ply], pawn_moves, vertical_fence_moves, horizontal_fence_moves)) {
+        first_searched_move = &stack->previous_pv[ply];
+    } else if (move_in_masks(&hash_move, pawn_moves, vertical_fence_moves, horizontal_fence_moves)) {
+        first_searched_move = &hash_move;
     }
 
-    while (horizontal_fence_moves != 0) {
-        FenceMove fence_move = square64(__builtin_ctzll(horizontal_fence_moves));
-        horizontal_fence_moves &= horizontal_fence_moves - 1;
-        make_horizontal_fence_move(&state, fence_move);
+    if (first_searched_move != NULL) {
+        // Remove the move from the masks so that it is not searched a second time below.
+        switch (first_searched_move->moveType) {
+            case Pawn:
+                pawn_moves &= ~first_searched_move->move.pawnMove;
+                break;
+            case VerticalFence:
+                vertical_fence_moves &= ~first_searched_move->move.fenceMove;
+                break;
+            case HorizontalFence:
+                horizontal_fence_moves &= ~first_searched_move->move.fenceMove;
+                break;
+            default:
+                break;
+        }
+
+        make_player_move(&state, first_searched_move, player);
+
+        const int score = -principal_variation_search(ctx, state, depth - 1, ply + 1, -beta, -alpha);
 
-        if (evaluate(state) == NO_PATH_FOUND) {
-            unmake_horizontal_fence_move(&state, fence_move);
-            continue;
+        if (search_stopped(ctx)) {
+            return 0;
         }
 
-        if (!search(&state, (struct Move) { .moveType = HorizontalFence, .move.fenceMove = fence_move },
-                    depth, &alpha, &beta, &first_move, pv_move, best_line)) {
-            return;
+        first_move = false;
+        best_move = *first_searched_move;
+        best_move.score = score;
+        if (score > alpha) {
+            alpha = score;
+            update_pv(stack, ply, best_move);
         }
 
-        unmake_horizontal_fence_move(&state, fence_move);
+        if (score >= beta) {
+            add_search_stat(ctx, beta_cutoffs, 1);
+            add_search_stat(ctx, first_move_beta_cutoffs, 1);
+            update_move_ordering(ctx, player, encode_move(*first_searched_move), depth, ply);
+            store_search_result(ctx, key, depth, original_alpha, beta, &best_move);
+            return score;
+        }
+
+        unmake_player_move(&state, first_searched_move, player);
     }
 
-    while (vertical_fence_moves != 0) {
-        FenceMove fence_move = square64(__builtin_ctzll(vertical_fence_moves));
-        vertical_fence_moves &= vertical_fence_moves - 1;
-        make_vertical_fence_move(&state, fence_move);
+    struct MoveList *move_list = &stack->move_lists[ply];
+    generate_move_list(pawn_moves, vertical_fence_moves, horizontal_fence_moves, move_list);
+    score_moves(ctx, &state, ply, move_list);
+
+    for (int i = 0; i < move_list->count; i++) {
+        const struct ScoredMove scored_move = pick_next_move(move_list, i);
+        const EncodedMove encoded_move = scored_move.move;
+        struct Move move = decode_move(encoded_move);
+        make_player_move(&state, &move, player);
 
-        if (evaluate(state) == NO_PATH_FOUND) {
-            unmake_vertical_fence_move(&state, fence_move);
-            continue;
+        // Late move reductions: fences ordered late that are neither killers nor on the opponent's
+        // shortest path, most of the fences of a node, almost never raise alpha.
+        int reduction = 0;
+        if (ctx->options.late_move_reductions && depth >= LMR_MIN_DEPTH && i >= LMR_MIN_MOVE_INDEX &&
+            encoded_move >= ENCODED_VERTICAL_FENCE_OFFSET && scored_move.score < PATH_FENCE_SCORE) {
+            reduction = !pv_node && depth > LMR_MIN_DEPTH && i >= LMR_DEEP_MOVE_INDEX ? 2 : 1;
         }
 
-        if (!search(&state, (struct Move) { .moveType = VerticalFence, .move.fenceMove = fence_move },
-                    depth, &alpha, &beta, &first_move, pv_move, best_line)) {
-            return;
+        const bool searched_first = first_move;
+        if (!search(ctx, &state, move, depth, reduction, ply, &alpha, beta, &first_move, &best_move)) {
+            if (search_stopped(ctx)) {
+                return 0;
+            }
+            add_search_stat(ctx, beta_cutoffs, 1);
+            add_search_stat(ctx, first_move_beta_cutoffs, searched_first);
+            update_move_ordering(ctx, player, encoded_move, depth, ply);
+            store_search_result(ctx, key, depth, original_alpha, beta, &best_move);
+            return best_move.score;
         }
 
-        unmake_vertical_fence_move(&state, fence_move);
+        unmake_player_move(&state, &move, player);
+    }
+
+    // The fences skipped by futility pruning score at most `futility_score`.
+    if (best_move.score < futility_score) {
+        best_move.score = futility_score;
     }
+
+    store_search_result(ctx, key, depth, original_alpha, beta, &best_move);
+    return best_move.score;
 }
 
 /**
  * @brief Principal Variation Search helper function.
  *
  * This function checks if a given move can improve the current principal variation
- * and, if so, updates the best line accordingly. It may perform a re-search if the
- * move’s score falls between alpha and beta, in order to refine the score.
+ * and, if so, updates the best move and principal variation accordingly. It may perform a
+ * re-search if the move’s score falls between alpha and beta, in order to refine the score.
  *
+ * @param ctx The search context of the calling thread.
  * @param state Pointer to the current game state.
  * @param move The current move being evaluated.
  * @param depth The current search depth remaining.
+ * @param reduction Plies the null window search of the move is reduced by, 0 for none. A reduced
+ *                  search that beats alpha is repeated to the full depth.
+ * @param ply Distance from the root of the search.
  * @param alpha Pointer to the current alpha value (score lower bound).
- * @param beta Pointer to the current beta value (score upper bound).
+ * @param beta The beta value (score upper bound).
  * @param first_move Pointer to a boolean that indicates if this is the first move
  *                   at this node (used for principal variation logic).
- * @param pv_move Pointer to the move array representing the principal variation after this move.
- * @param best_line Pointer to the move array where the best variation found so far is stored.
+ * @param best_move Pointer to the best move found so far at this node, along with its score.
  *
- * @return True if the search should continue, or false if a beta cutoff (pruning) occurred.
+ * @return True if the search should continue, or false if a beta cutoff (pruning) occurred or the
+ *         search was stopped.
  */
-bool search(struct State *state, const struct Move move, const int depth, int *alpha, // NOLINT(*-no-recursion)
-            const int *beta, bool *first_move, struct Move *pv_move, struct Move *best_line) {
-
-    struct Move child_line[depth];
+static bool search(struct SearchContext *ctx, struct State *state, const struct Move move, const int depth, // NOLINT(*-no-recursion)
+                   const int reduction, const int ply, int *alpha, const int beta, bool *first_move,
+                   struct Move *best_move) {
+    int score;
 
     if (*first_move) {
-        principal_variation_search(*state, depth - 1, -(*alpha) - 1, -(*alpha), pv_move, child_line);
+        // The first move is expected to be the best one, so it is searched with the full window.
+        score = -principal_variation_search(ctx, *state, depth - 1, ply + 1, -beta, -(*alpha));
         *first_move = false;
     } else {
-        principal_variation_search(*state, depth - 1, -(*beta), -(*alpha), pv_move, child_line);
+        // The other moves only need to be proven no better than alpha, which a null window does cheaply.
+        score = -principal_variation_search(ctx, *state, depth - 1 - reduction, ply + 1, -(*alpha) - 1, -(*alpha));
+
+        // A reduced move that beats alpha is searched again to the full depth before it is trusted.
+        if (reduction > 0 && score > *alpha && !search_stopped(ctx)) {
+            score = -principal_variation_search(ctx, *state, depth - 1, ply + 1, -(*alpha) - 1, -(*alpha));
+        }
+
+        // If we found a move that beats alpha but is still less than beta,
+        // we need a full re-search.
+        if (score > *alpha && score < beta && !search_stopped(ctx)) {
+            add_search_stat(ctx, re_searches, 1);
+            score = -principal_variation_search(ctx, *state, depth - 1, ply + 1, -beta, -(*alpha));
+        }
     }
-    int score = -child_line[0].score;
 
-    // If we found a move that beats alpha but is still less than beta,
-    // we need a full re-search.
-    if (score > *alpha && score < *beta) {
-        principal_variation_search(*state, depth - 1, -(*beta), -(*alpha), pv_move, child_line);
-        score = -child_line[0].score;
+    if (search_stopped(ctx)) {
+        return false;
     }
 
-    // If this move improves our best score or if no best move is chosen yet.
-    if (score > *alpha || best_line[0].moveType == None) {
+    // If this move improves our best score or if no best move is chosen yet. Alpha is never
+    // lowered, a fail-low move only sets the best score returned.
+    if (score > best_move->score || best_move->moveType == None) {
+        *best_move = move;
+        best_move->score = score;
+    }
+    if (score > *alpha) {
         *alpha = score;
-        best_line[0].score = score;
-        best_line[0].moveType = move.moveType;
-        best_line[0].move = move.move;
-        memcpy(best_line + 1, child_line, sizeof(struct Move) * depth);
+        update_pv(ctx->stack, ply, move);
     }
 
-    if (score >= *beta) {
+    return score < beta;
+}
+
+/**
+ * @brief Decides whether the next iteration can be completed within the budget.
+ *
+ * The cost of the next iteration is predicted by multiplying the cost of the last one by the
+ * effective branching factor, the ratio between the nodes of the last two iterations.
+ *
+ * @param ctx The search context of the main thread.
+ * @param iteration_nodes The nodes searched by the last iteration.
+ * @param previous_iteration_nodes The nodes searched by the iteration before it, 0 if there was none.
+ * @param iteration_time_ms The time taken by the last iteration.
+ *
+ * @return True if the next iteration is expected to finish before the budget runs out.
+ */
+static bool should_start_next_iteration(const struct SearchContext *ctx, uint64_t iteration_nodes,
+                                        uint64_t previous_iteration_nodes, double iteration_time_ms) {
+    double branching_factor = previous_iteration_nodes > 0
+                              ? (double) iteration_nodes / (double) previous_iteration_nodes
+                              : (double) iteration_nodes;
+
+    if (branching_factor < 1.0) {
+        branching_factor = 1.0;
+    }
+
+    if ((double) ctx->nodes + (double) iteration_nodes * branching_factor > (double) ctx->node_limit) {
         return false;
     }
 
-    return true;
+    return get_time_ms() + iteration_time_ms * branching_factor < ctx->deadline_ms;
 }
 
-struct Move get_best_move(struct State state, const int depth) {
-    assert(depth > 0);
+/**
+ * @brief Records the statistics of an iteration and adds them to the total.
+ */
+static void record_iteration_stats(struct SearchStats *stats, int depth, const struct SearchDepthStats *counters) {
+    stats->depths[depth] = *counters;
+    stats->depth_count = depth;
+
+    stats->total.nodes += counters->nodes;
+    stats->total.beta_cutoffs += counters->beta_cutoffs;
+    stats->total.first_move_beta_cutoffs += counters->first_move_beta_cutoffs;
+    stats->total.re_searches += counters->re_searches;
+    stats->total.legality_checks += counters->legality_checks;
+    stats->total.transposition_hits += counters->transposition_hits;
+    stats->total.transposition_cutoffs += counters->transposition_cutoffs;
+    stats->total.aspiration_fail_highs += counters->aspiration_fail_highs;
+    stats->total.aspiration_fail_lows += counters->aspiration_fail_lows;
+    stats->total.time_ms += counters->time_ms;
+}
+
+/**
+ * @brief Searches the root with an aspiration window around the score of the previous iteration.
+ *
+ * The window is widened exponentially on the side the score fell out of and the root is searched
+ * again, until the score falls inside it. Once the window is wider than the winning score that
+ * side is opened fully. Winning scores are always searched with the full window, as they change
+ * by more than any window between iterations.
+ *
+ * @param ctx The search context of the calling thread.
+ * @param state The game state to search.
+ * @param depth The depth of the iteration.
+ * @param previous_score The score of the previous iteration.
+ *
+ * @return The score of the iteration.
+ */
+static int aspiration_search(struct SearchContext *ctx, const struct State *state, int depth, int previous_score) {
+    int window = ctx->options.aspiration_window;
+    int alpha = INT32_MIN + 1;
+    int beta = INT32_MAX;
+
+    if (window > 0 && !is_winning_score(previous_score)) {
+        alpha = previous_score - window;
+        beta = previous_score + window;
+    }
+
+    for (;;) {
+        const int score = principal_variation_search(ctx, *state, depth, 0, alpha, beta);
+
+        if (search_stopped(ctx)) {
+            return score;
+        }
 
-    struct Move empty_move_list[depth];
-    struct Move best_move_list[depth + 1];
+        window *= 2;
+        if (score <= alpha && alpha != INT32_MIN + 1) {
+            ctx->counters.aspiration_fail_lows++;
+            alpha = window < WINNING_SCORE ? score - window : INT32_MIN + 1;
+        } else if (score >= beta && beta != INT32_MAX) {
+            ctx->counters.aspiration_fail_highs++;
+            beta = window < WINNING_SCORE ? score + window : INT32_MAX;
+        } else {
+            return score;
+        }
+    }
+}
+
+/**
+ * @brief Runs iterative deepening from `first_depth` to `last_depth` with the given context.
+ *
+ * The first iteration is searched with a full window, the following ones with the aspiration
+ * window of the context's options (see `aspiration_search`). If the context checks a budget, an
+ * iteration is only started if it is expected to finish within the budget. The principal
+ * variation of the stack's last completed iteration is searched first, the callers clear it to
+ * start a new search.
+ *
+ * @param ctx The search context of the calling thread.
+ * @param state The game state to search, its derived fields must be up to date.
+ * @param first_depth The depth of the first iteration.
+ * @param last_depth The depth of the last iteration.
+ * @param best_move Pointer to where the best move of the last completed iteration is stored.
+ *
+ * @return The depth of the last completed iteration, 0 if none completed before the search was stopped.
+ */
+static int run_iterative_deepening(struct SearchContext *ctx, struct State state, int first_depth, int last_depth,
+                                   struct Move *best_move) {
+    struct SearchStack *stack = ctx->stack;
+    uint64_t previous_iteration_nodes = 0;
+    int completed_depth = 0;
+    int score = 0;
+
+    *best_move = (struct Move) { .moveType = None, .score = INT32_MIN + 1 };
+    memset(stack->null_move, 0, sizeof(stack->null_move));
+    ctx->stack_base = (uintptr_t) __builtin_frame_address(0);
+    ctx->stack_low = ctx->stack_base;
+
+    for (int d = first_depth; d <= last_depth; d++) {
+        const uint64_t iteration_start_nodes = ctx->nodes;
+        const double iteration_start_time = get_time_ms();
+
+        ctx->counters = (struct SearchDepthStats) { 0 };
+        if (completed_depth > 0) {
+            score = aspiration_search(ctx, &state, d, score);
+        } else {
+            score = principal_variation_search(ctx, state, d, 0, INT32_MIN + 1, INT32_MAX);
+        }
+        ctx->counters.nodes = ctx->nodes - iteration_start_nodes;
+        ctx->counters.time_ms = get_time_ms() - iteration_start_time;
+
+        if (ctx->stats != NULL) {
+            record_iteration_stats(ctx->stats, d, &ctx->counters);
+        }
+
+        if (search_stopped(ctx)) {
+            break;
+        }
+
+        memcpy(stack->previous_pv, stack->pv[0], sizeof(struct Move) * stack->pv_length[0]);
+        stack->previous_pv_length = stack->pv_length[0];
+        *best_move = stack->pv[0][0];
+        best_move->score = score;
+        completed_depth = d;
+        ctx->can_abort = true;
+
+        if (ctx->check_budget && d < last_depth &&
+            !should_start_next_iteration(ctx, ctx->counters.nodes, previous_iteration_nodes, ctx->counters.time_ms)) {
+            break;
+        }
+        previous_iteration_nodes = ctx->counters.nodes;
+    }
+
+    return completed_depth;
+}
 
-    for (int i = 0; i < depth; i++) {
-        empty_move_list[i] = (struct Move) { .moveType = None, .score = INT32_MIN + 1 };
+/**
+ * @brief Prepares the transposition table for a search outside of a `SearchEngine`.
+ *
+ * The table is cleared, so that such searches do not depend on the ones before them, unless an
+ * engine is alive: the entries it keeps between its moves are then only aged.
+ */
+static void prepare_transposition_table() {
+    if (atomic_load(&live_search_engines) > 0) {
+        age_transposition_table();
+    } else {
+        clear_transposition_table();
     }
+}
+
+struct Move get_best_move(struct State state, const int depth) {
+    assert(depth > 0 && depth <= MAX_SEARCH_DEPTH);
+
+    recompute_derived_state(&state);
+    prepare_transposition_table();
+
+    atomic_bool stop = false;
+    struct SearchContext ctx = { .stop = &stop, .stack = allocate_search_stack() };
 
-    principal_variation_search(state, depth, INT32_MIN + 1, INT32_MAX, empty_move_list, best_move_list);
+    const int score = principal_variation_search(&ctx, state, depth, 0, INT32_MIN + 1, INT32_MAX);
+    struct Move best_move = ctx.stack->pv[0][0];
+    best_move.score = score;
 
-    return best_move_list[0];
+    free(ctx.stack);
+    return best_move;
 }
 
 /**
@@ -242,7 +903,9 @@ struct Move get_best_move(struct State state, const int depth) {
  *
  * This function uses iterative deepening: it searches at increasing depths up to the specified
  * `depth`. The best move line found at each iteration is stored and then used as a basis for
- * deeper searches, improving move ordering.
+ * deeper searches, improving move ordering. The transposition table is cleared before the first
+ * iteration and shared by all of them. Positions in the opening book are not searched, one of
+ * their book moves is played instead.
  *
  * @param state The current game state.
  * @param depth The maximum search depth to reach.
@@ -252,15 +915,471 @@ struct Move get_best_move(struct State state, const int depth) {
 struct Move get_best_move_iterative_deepening(struct State state, const int depth) {
     assert(depth > 0);
 
-    struct Move current_line[depth];
-    struct Move best_line[depth + 1]; // Initialized and populated by principal_variation_search
+    struct Move book_move;
+    recompute_derived_state(&state);
+    if (probe_opening_book(&state, &book_move)) {
+        return book_move;
+    }
+
+    return search_position(state, (struct SearchBudget) { .max_depth = depth }, default_search_options).best_move;
+}
+
+/**
+ * @brief Finds the opponent's expected reply to the best move of a search: the second move of the
+ * principal variation, or the move stored for the position after the best move when the line
+ * was cut short.
+ *
+ * @param state The searched game state.
+ * @param stack The stack of the search, its previous principal variation is the final one.
+ *
+ * @return The expected reply, `None` if there is none.
+ */
+static struct Move find_ponder_move(struct State state, const struct SearchStack *stack) {
+    if (stack->previous_pv_length >= 2) {
+        return stack->previous_pv[1];
+    }
+
+    struct TranspositionEntry entry;
+    if (stack->previous_pv_length == 1) {
+        struct Move best_move = stack->previous_pv[0];
+        make_move(&state, &best_move);
+
+        if (probe_transposition_table(state.hash, &entry)) {
+            return decode_move(entry.move);
+        }
+    }
+
+    return (struct Move) { .moveType = None };
+}
+
+/**
+ * @struct HelperThread
+ * @brief Arguments and result of a Lazy SMP helper thread.
+ */
+struct HelperThread {
+    pthread_t thread;
+    struct SearchContext ctx;
+    struct SearchStack stack;
+    struct State state;
+    int first_depth;
+    int last_depth;
+};
+
+static void *run_helper_thread(void *arg) {
+    struct HelperThread *helper = arg;
+    struct Move ignored_move;
+
+    run_iterative_deepening(&helper->ctx, helper->state, helper->first_depth, helper->last_depth, &ignored_move);
+
+    return NULL;
+}
+
+/**
+ * @brief Searches a position within a budget, along with the Lazy SMP helpers of the context's
+ * options.
+ *
+ * @param ctx The context of the main thread, with its stop flag, options, stack and move ordering
+ *            set up and no nodes counted yet.
+ * @param state The game state to search, its derived fields must be up to date.
+ * @param budget The depth, time and node limits of the search.
+ *
+ * @return The best move, along with the depth completed and search statistics.
+ */
+static struct SearchResult run_search(struct SearchContext *ctx, const struct State *state,
+                                      const struct SearchBudget budget) {
+    const int depth = budget.max_depth > 0 && budget.max_depth < MAX_SEARCH_DEPTH
+                      ? budget.max_depth
+                      : MAX_SEARCH_DEPTH;
+    const int thread_count = ctx->options.thread_count < 1 ? 1
+                             : ctx->options.thread_count > MAX_SEARCH_THREADS ? MAX_SEARCH_THREADS
+                             : ctx->options.thread_count;
+
+    ctx->check_budget = budget.time_limit_ms > 0 || budget.node_limit > 0;
+    ctx->can_abort = false;
+    ctx->node_limit = budget.node_limit > 0 ? budget.node_limit : UINT64_MAX;
+    ctx->deadline_ms = budget.time_limit_ms > 0 ? get_time_ms() + budget.time_limit_ms : INFINITY;
+
+    // Contexts are too large to keep a full set of helpers on the (small, in WASM) stack.
+    struct HelperThread *helpers = thread_count > 1 ? malloc(sizeof(struct HelperThread) * (thread_count - 1)) : NULL;
+    int helper_count = 0;
+
+    // Helpers alternate between starting one ply deeper than the main thread and finishing one ply
+    // deeper than it, so that the threads are spread over neighbouring depths rather than all
+    // searching the same tree in lock step.
+    for (int i = 0; helpers != NULL && i < thread_count - 1; i++) {
+        struct HelperThread *helper = &helpers[helper_count];
+        helper->ctx = (struct SearchContext) { .stop = ctx->stop, .options = ctx->options, .stack = &helper->stack };
+        helper->stack.previous_pv_length = 0;
+        helper->state = *state;
+        helper->first_depth = 1 + (i + 1) % 2;
+        helper->last_depth = depth < MAX_SEARCH_DEPTH ? depth + (i + 1) % 2 : MAX_SEARCH_DEPTH;
+
+        // Thread creation fails in builds without thread support (e.g. WASM), the main thread
+        // then searches alone.
+        if (pthread_create(&helper->thread, NULL, run_helper_thread, helper) != 0) {
+            break;
+        }
+        helper_count++;
+    }
+
+    struct SearchResult result = { 0 };
+    ctx->stats = &result.stats;
+    result.depth = run_iterative_deepening(ctx, *state, 1, depth, &result.best_move);
+    result.ponder_move = find_ponder_move(*state, ctx->stack);
+    result.nodes = ctx->nodes;
+    result.stats.stack_high_water = ctx->stack_base - ctx->stack_low;
+    ctx->stats = NULL;
+
+    atomic_store(ctx->stop, true);
+
+    for (int i = 0; i < helper_count; i++) {
+        pthread_join(helpers[i].thread, NULL);
+        result.nodes += helpers[i].ctx.nodes;
+    }
+
+    free(helpers);
+    last_search_stats = result.stats;
+    return result;
+}
+
+struct SearchResult search_position(struct State state, const struct SearchBudget budget,
+                                   const struct SearchOptions options) {
+    recompute_derived_state(&state);
+    prepare_transposition_table();
+
+    atomic_bool stop = false;
+    struct SearchContext ctx = { .stop = &stop, .options = options, .stack = allocate_search_stack() };
+
+    struct SearchResult result = run_search(&ctx, &state, budget);
+
+    free(ctx.stack);
+    return result;
+}
+
+struct SearchResult get_best_move_lazy_smp(struct State state, const int depth, int thread_count) {
+    assert(depth > 0 && depth <= MAX_SEARCH_DEPTH);
+    assert(thread_count > 0);
+
+    struct SearchOptions options = default_search_options;
+    options.thread_count = thread_count;
+
+    return search_position(state, (struct SearchBudget) { .max_depth = depth }, options);
+}
+
+struct SearchResult get_best_move_timed(struct State state, const struct SearchBudget budget) {
+    struct SearchResult result = { 0 };
+    recompute_derived_state(&state);
+    if (probe_opening_book(&state, &result.best_move)) {
+        last_search_stats = result.stats;
+        return result;
+    }
+
+    return search_position(state, budget, default_search_options);
+}
+
+/**
+ * @struct SearchEngine
+ * @brief A search kept for a whole game, along with its ponder search.
+ */
+struct SearchEngine {
+    struct SearchContext ctx;   // Its killer moves and history are kept from one search to the next.
+    struct SearchStack stack;   // Its previous principal variation is kept from one search to the next.
+    atomic_bool stop;           // Stop flag of `ctx`, also set when a ponder slice runs out of time.
+    struct State root;          // Position of the last search or ponder search.
+    bool has_root;
+
+    // The ponder search, of the position expected on the engine's next move. Its root is `root`.
+    atomic_bool pondering;      // Cleared by `stop_pondering`.
+    bool ponder_pending;        // Until the next `get_best_move_pondered`, which counts it as a hit or a miss.
+    struct Move ponder_best_move;  // Of the deepest completed iteration.
+    int ponder_depth;              // Depth of the deepest completed iteration.
+    double ponder_time_ms;
+    struct SearchStats ponder_search_stats;
+    struct PonderStats ponder_stats;
+};
+
+/**
+ * @brief Finds a position on the principal variation of the engine's last search.
+ *
+ * @return The number of moves of the line leading from the last search's root to `state`, -1 if
+ *         `state` is not on the line.
+ */
+static int find_on_previous_pv(const struct SearchEngine *engine, const struct State *state) {
+    if (!engine->has_root) {
+        return -1;
+    }
+
+    struct State position = engine->root;
+    for (int i = 0;; i++) {
+        if (position.hash == state->hash && equal_states(position, *state)) {
+            return i;
+        }
+        if (i == engine->stack.previous_pv_length) {
+            return -1;
+        }
+
+        struct Move move = engine->stack.previous_pv[i];
+        make_move(&position, &move);
+    }
+}
+
+/**
+ * @brief Prepares an engine to search a new root, keeping what its last search learnt.
+ *
+ * The transposition table is aged rather than cleared. If the new root is on the last principal
+ * variation, the rest of the line and the killer moves of the plies below the new root are moved
+ * up to the new root's plies, otherwise they are cleared. The history is halved, so that the
+ * cutoffs of the last search weigh less than those of the next one.
+ *
+ * @param engine The engine, not pondering.
+ * @param state The new root, its derived fields must be up to date.
+ */
+static void prepare_engine_search(struct SearchEngine *engine, const struct State *state) {
+    struct SearchContext *ctx = &engine->ctx;
+    struct SearchStack *stack = &engine->stack;
+    const int shift = find_on_previous_pv(engine, state);
+
+    age_transposition_table();
+
+    if (shift < 0) {
+        stack->previous_pv_length = 0;
+        memset(ctx->killer_moves, 0, sizeof(ctx->killer_moves));
+    } else if (shift > 0) {
+        stack->previous_pv_length -= shift;
+        memmove(stack->previous_pv, &stack->previous_pv[shift], sizeof(struct Move) * stack->previous_pv_length);
+        memmove(ctx->killer_moves, ctx->killer_moves[shift], sizeof(ctx->killer_moves[0]) * (MAX_SEARCH_DEPTH + 1 - shift));
+        memset(ctx->killer_moves[MAX_SEARCH_DEPTH + 1 - shift], 0, sizeof(ctx->killer_moves[0]) * shift);
+    }
+
+    for (int player = 0; player < 2; player++) {
+        for (int i = 0; i < ENCODED_MOVE_COUNT; i++) {
+            ctx->history[player][i] /= 2;
+        }
+    }
+
+    engine->root = *state;
+    engine->has_root = true;
+    engine->ponder_pending = false;
+    atomic_store(&engine->stop, false);
+    ctx->nodes = 0;
+    ctx->stats = NULL;
+}
+
+struct SearchEngine *new_search_engine() {
+    struct SearchEngine *engine = malloc(sizeof(struct SearchEngine));
+
+    if (engine == NULL) {
+        exit(1);  // malloc failed, should probably log this somehow.
+    }
+
+    reset_search_engine(engine);
+    atomic_fetch_add(&live_search_engines, 1);
+    return engine;
+}
+
+void reset_search_engine(struct SearchEngine *engine) {
+    // The engine is too large to be built on the (small, in WASM) stack.
+    memset(engine, 0, sizeof(struct SearchEngine));
+    engine->ctx.stop = &engine->stop;
+    engine->ctx.options = default_search_options;
+    engine->ctx.stack = &engine->stack;
+
+    clear_transposition_table();
+}
 
-    initialize_move_list(current_line, depth);
+void free_search_engine(struct SearchEngine *engine) {
+    atomic_fetch_sub(&live_search_engines, 1);
+    free(engine);
+}
+
+struct SearchResult search_with_engine(struct SearchEngine *engine, struct State state,
+                                       const struct SearchBudget budget) {
+    stop_pondering(engine);
+    engine->ponder_pending = false;
 
-    for (int d = 0; d < depth; d++) {
-        principal_variation_search(state, d + 1, INT32_MIN + 1, INT32_MAX, current_line, best_line);
-        memcpy(current_line, best_line, sizeof(struct Move) * (d + 1));
+    struct SearchResult result = { 0 };
+    recompute_derived_state(&state);
+    if (probe_opening_book(&state, &result.best_move)) {
+        last_search_stats = result.stats;
+        return result;
     }
 
-    return current_line[0];
-}
\ No newline at end of file
+    prepare_engine_search(engine, &state);
+    return run_search(&engine->ctx, &state, budget);
+}
+
+bool start_pondering(struct SearchEngine *engine, struct State state, struct Move move, struct Move predicted_reply) {
+    stop_pondering(engine);
+    engine->ponder_pending = false;
+    recompute_derived_state(&state);
+
+    if (move.moveType == None || predicted_reply.moveType == None) {
+        return false;
+    }
+
+    make_move(&state, &move);
+    if (player_1_win_check(state) || player_2_win_check(state) || !move_is_fully_legal(&state, predicted_reply)) {
+        return false;
+    }
+
+    make_move(&state, &predicted_reply);
+    if (player_1_win_check(state) || player_2_win_check(state)) {
+        return false;
+    }
+
+    prepare_engine_search(engine, &state);
+
+    struct SearchContext *ctx = &engine->ctx;
+    ctx->check_budget = true;
+    ctx->can_abort = true;
+    ctx->node_limit = UINT64_MAX;
+    ctx->deadline_ms = INFINITY;
+    ctx->stats = &engine->ponder_search_stats;
+
+    memset(&engine->ponder_search_stats, 0, sizeof(engine->ponder_search_stats));
+    engine->ponder_best_move = (struct Move) { .moveType = None };
+    engine->ponder_depth = 0;
+    engine->ponder_time_ms = 0;
+    engine->ponder_pending = true;
+    engine->ponder_stats.ponders++;
+
+    atomic_store(&engine->pondering, true);
+    return true;
+}
+
+bool ponder(struct SearchEngine *engine, uint32_t time_limit_ms) {
+    // The stop flag is cleared before checking `pondering`, so that a `stop_pondering` on another
+    // thread either is seen here or sets the flag again after it.
+    atomic_store(&engine->stop, false);
+    if (!atomic_load(&engine->pondering) || engine->ponder_depth >= MAX_SEARCH_DEPTH) {
+        return false;
+    }
+
+    struct SearchContext *ctx = &engine->ctx;
+    const double start = get_time_ms();
+    const uint64_t start_nodes = ctx->nodes;
+    ctx->deadline_ms = time_limit_ms > 0 ? start + time_limit_ms : INFINITY;
+
+    // Iterations are run one at a time, a slice too short for the next iteration would otherwise
+    // never start it.
+    while (engine->ponder_depth < MAX_SEARCH_DEPTH) {
+        struct Move best_move;
+        const int depth = engine->ponder_depth + 1;
+
+        if (run_iterative_deepening(ctx, engine->root, depth, depth, &best_move) == 0) {
+            break;
+        }
+        engine->ponder_best_move = best_move;
+        engine->ponder_depth = depth;
+    }
+
+    const double time = get_time_ms() - start;
+    engine->ponder_time_ms += time;
+    engine->ponder_stats.time_ms += time;
+    engine->ponder_stats.nodes += ctx->nodes - start_nodes;
+
+    return atomic_load(&engine->pondering) && engine->ponder_depth < MAX_SEARCH_DEPTH;
+}
+
+void stop_pondering(struct SearchEngine *engine) {
+    atomic_store(&engine->pondering, false);
+    atomic_store(&engine->stop, true);
+}
+
+struct SearchResult get_best_move_pondered(struct SearchEngine *engine, struct State state,
+                                           const struct SearchBudget budget) {
+    stop_pondering(engine);
+    recompute_derived_state(&state);
+
+    const bool hit = engine->ponder_pending && state.hash == engine->root.hash && equal_states(state, engine->root);
+    if (engine->ponder_pending) {
+        engine->ponder_pending = false;
+        engine->ponder_stats.hits += hit;
+        engine->ponder_stats.misses += !hit;
+    }
+    if (!hit) {
+        return search_with_engine(engine, state, budget);
+    }
+
+    struct SearchResult result = { 0 };
+    if (probe_opening_book(&state, &result.best_move)) {
+        last_search_stats = result.stats;
+        return result;
+    }
+
+    struct SearchContext *ctx = &engine->ctx;
+    const int depth = budget.max_depth > 0 && budget.max_depth < MAX_SEARCH_DEPTH
+                      ? budget.max_depth
+                      : MAX_SEARCH_DEPTH;
+    const bool out_of_time = budget.time_limit_ms > 0 && engine->ponder_time_ms >= budget.time_limit_ms;
+    const bool out_of_nodes = budget.node_limit > 0 && ctx->nodes >= budget.node_limit;
+
+    engine->ponder_stats.last_hit_depth = engine->ponder_depth;
+    result.best_move = engine->ponder_best_move;
+    result.depth = engine->ponder_depth;
+
+    if (result.depth < depth && (result.depth == 0 || (!out_of_time && !out_of_nodes))) {
+        struct Move best_move;
+
+        atomic_store(&engine->stop, false);
+        ctx->check_budget = budget.time_limit_ms > 0 || budget.node_limit > 0;
+        ctx->can_abort = result.depth > 0;
+        ctx->node_limit = budget.node_limit > 0 ? budget.node_limit : UINT64_MAX;
+        ctx->deadline_ms = budget.time_limit_ms > 0 ? get_time_ms() + budget.time_limit_ms - engine->ponder_time_ms
+                                                    : INFINITY;
+
+        const int completed_depth = run_iterative_deepening(ctx, state, result.depth + 1, depth, &best_move);
+        if (completed_depth > 0) {
+            result.best_move = best_move;
+            result.depth = completed_depth;
+        }
+    }
+
+    result.ponder_move = find_ponder_move(state, ctx->stack);
+    result.nodes = ctx->nodes;
+    result.stats = engine->ponder_search_stats;
+    result.stats.stack_high_water = ctx->stack_base - ctx->stack_low;
+    ctx->stats = NULL;
+    last_search_stats = result.stats;
+    return result;
+}
+
+const struct PonderStats *get_ponder_stats(const struct SearchEngine *engine) {
+    return &engine->ponder_stats;
+}
+
+const struct SearchStats *get_last_search_stats() {
+    return &last_search_stats;
+}
+
+/**
+ * @brief Prints a row of the search statistics table.
+ */
+static void print_search_depth_stats(const char *label, const struct SearchDepthStats *stats,
+                                     double branching_factor) {
+    printf("%6s %12llu %10.1f %6.2f %10llu %7.1f %10llu %10llu %10llu %10llu %8llu %8llu\n", label,
+           (unsigned long long) stats->nodes, stats->time_ms, branching_factor,
+           (unsigned long long) stats->beta_cutoffs,
+           stats->beta_cutoffs > 0 ? 100.0 * (double) stats->first_move_beta_cutoffs / (double) stats->beta_cutoffs : 0,
+           (unsigned long long) stats->re_searches, (unsigned long long) stats->legality_checks,
+           (unsigned long long) stats->transposition_hits, (unsigned long long) stats->transposition_cutoffs,
+           (unsigned long long) stats->aspiration_fail_highs, (unsigned long long) stats->aspiration_fail_lows);
+}
+
+void print_search_stats(const struct SearchStats *stats) {
+    printf("%6s %12s %10s %6s %10s %7s %10s %10s %10s %10s %8s %8s\n", "depth", "nodes", "time (ms)", "EBF",
+           "cutoffs", "first %", "re-search", "legality", "tt hits", "tt cuts", "asp high", "asp low");
+
+    for (int d = 1; d <= stats->depth_count; d++) {
+        char label[12];
+        snprintf(label, sizeof(label), "%d", d);
+
+        // The effective branching factor is the growth of the node count from one iteration to the next.
+        const double branching_factor = d > 1 && stats->depths[d - 1].nodes > 0
+                                        ? (double) stats->depths[d].nodes / (double) stats->depths[d - 1].nodes
+                                        : 0;
+        print_search_depth_stats(label, &stats->depths[d], branching_factor);
+    }
+
+    print_search_depth_stats("total", &stats->total, 0);
+}
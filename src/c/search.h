@@ -5,8 +5,263 @@
 #include "state.h"
 #include "move.h"
 
+#define MAX_SEARCH_THREADS 64
+#define MAX_SEARCH_DEPTH 64
+
+// Number of nodes between two checks of the clock in a budgeted search.
+#define SEARCH_BUDGET_CHECK_INTERVAL 1024
+
+// Half width of the aspiration window used by the `get_best_move_*` searches. A path length
+// difference of one changes the evaluation by 2.
+#define DEFAULT_ASPIRATION_WINDOW 4
+
+/**
+ * @struct SearchBudget
+ * @brief Limits of a search, a limit of 0 means no limit.
+ */
+struct SearchBudget {
+    int max_depth;           // At most `MAX_SEARCH_DEPTH`.
+    uint32_t time_limit_ms;  // Wall-clock time.
+    uint64_t node_limit;
+};
+
+/**
+ * @struct SearchOptions
+ * @brief Settings of a search, all zero gives a single threaded search without aspiration windows.
+ */
+struct SearchOptions {
+    int thread_count;           // Total number of Lazy SMP threads, at most `MAX_SEARCH_THREADS`.
+    bool relevant_fences_only;  // Only search the fences kept by `filter_relevant_fence_moves`.
+
+    // Half width of the window around the previous iteration's score that each iteration starts
+    // with, doubled on every fail-high or fail-low. 0 searches every iteration with a full window.
+    int aspiration_window;
+
+    // Selective search, see `principal_variation_search`. Only late move reductions are on in the
+    // `get_best_move_*` searches, `quoridor_bench selective` and `quoridor_match` compare them.
+    bool late_move_reductions;  // Search quiet fences ordered late to a reduced depth.
+    bool null_move_pruning;     // Cut nodes where passing the turn still fails high.
+    bool futility_pruning;      // Skip quiet fences near the leaves that cannot raise alpha.
+};
+
+/**
+ * @struct SearchDepthStats
+ * @brief Statistics of a single iteration of a search.
+ *
+ * `nodes`, `time_ms` and the aspiration counters are always collected. The other counters are
+ * only collected when the engine is built with `QUORIDOR_SEARCH_STATS` (off in release builds),
+ * otherwise they stay 0.
+ */
+struct SearchDepthStats {
+    uint64_t nodes;
+    uint64_t beta_cutoffs;
+    uint64_t first_move_beta_cutoffs;  // Beta cutoffs caused by the first move searched.
+    uint64_t re_searches;              // Null window searches repeated with the full window.
+    uint64_t legality_checks;          // Fences checked with a path search for leaving both players a path.
+    uint64_t transposition_hits;
+    uint64_t transposition_cutoffs;    // Nodes ended by a transposition table entry.
+    uint64_t aspiration_fail_highs;    // Root searches repeated because the score was above the window.
+    uint64_t aspiration_fail_lows;     // Root searches repeated because the score was below the window.
+    double time_ms;
+};
+
+/**
+ * @struct SearchStats
+ * @brief Statistics of the main thread of a search, per iteration and in total.
+ */
+struct SearchStats {
+    int depth_count;  // Number of iterations started, the last one may have been aborted.
+    struct SearchDepthStats depths[MAX_SEARCH_DEPTH + 1];  // Indexed by the depth of the iteration.
+    struct SearchDepthStats total;
+    uint64_t stack_high_water;  // Bytes of C stack used below the root by the deepest node of the search.
+};
+
+/**
+ * @struct SearchResult
+ * @brief The outcome of a search.
+ */
+struct SearchResult {
+    struct Move best_move;
+    struct Move ponder_move;  // Expected reply of the opponent, `None` if the search did not find one.
+    int depth;       // Depth of the last iteration completed by the main thread.
+    uint64_t nodes;  // Nodes searched by all threads.
+    struct SearchStats stats;
+};
+
 struct Move get_best_move(struct State state, int depth);
 
 struct Move get_best_move_iterative_deepening(struct State state, int depth);
 
+/**
+ * @brief Multi-threaded iterative deepening search using Lazy SMP.
+ *
+ * Helper threads run their own iterative deepening searches of the same position at staggered
+ * depths, sharing their results with the main thread only through the transposition table. Once
+ * the main thread has completed `depth` the helpers are stopped and the main thread's move is
+ * returned. Without thread support the main thread searches alone.
+ *
+ * @param state The current game state.
+ * @param depth The depth the main thread searches to.
+ * @param thread_count The total number of search threads, including the main thread
+ *                     (at most `MAX_SEARCH_THREADS`).
+ *
+ * @return The main thread's best move, along with the depth reached and the total nodes searched.
+ */
+struct SearchResult get_best_move_lazy_smp(struct State state, int depth, int thread_count);
+
+/**
+ * @brief Iterative deepening search limited by a time and/or node budget.
+ *
+ * The search is aborted as soon as the budget runs out, the aborted iteration is then discarded
+ * and the best move of the last completed iteration is returned. An iteration is not started if
+ * the branching factor of the previous ones predicts that it would not complete in time. The
+ * first iteration always completes, so that a move is returned even with a tiny budget.
+ *
+ * Positions in the opening book are not searched, a book move is returned with a depth of 0.
+ *
+ * @param state The current game state.
+ * @param budget The depth, time and node limits of the search.
+ *
+ * @return The best move, along with the depth completed and the nodes searched.
+ */
+struct SearchResult get_best_move_timed(struct State state, struct SearchBudget budget);
+
+/**
+ * @brief Searches a position within a budget, with the given options.
+ *
+ * This is the search behind `get_best_move_lazy_smp` and `get_best_move_timed`, see those for how
+ * the threads and the budget behave.
+ *
+ * @param state The current game state.
+ * @param budget The depth, time and node limits of the search.
+ * @param options The search settings.
+ *
+ * @return The best move, along with the depth completed and search statistics.
+ */
+struct SearchResult search_position(struct State state, struct SearchBudget budget, struct SearchOptions options);
+
+/**
+ * @struct SearchEngine
+ * @brief A search kept for a whole game, so that each move's search starts from what the previous
+ * ones learnt. See `new_search_engine`.
+ */
+struct SearchEngine;
+
+/**
+ * @struct PonderStats
+ * @brief Counters of the ponder searches of an engine since it was created or reset.
+ */
+struct PonderStats {
+    uint64_t ponders;     // Ponder searches started.
+    uint64_t hits;        // Searches that continued a ponder search, the opponent played the predicted reply.
+    uint64_t misses;      // Searches started afresh after pondering on another reply.
+    uint64_t nodes;       // Nodes searched while pondering.
+    double time_ms;       // Time spent pondering.
+    int last_hit_depth;   // Depth the ponder search had completed at the last hit.
+};
+
+/**
+ * @brief Allocates an engine for a new game, exits if the allocation fails.
+ *
+ * The engine keeps its killer moves, history and principal variation from one search to the next,
+ * and the transposition table is aged between its searches rather than cleared. When the engine
+ * plays the move it predicted for both players, its next search starts two plies down its last
+ * principal variation, and its first iterations are answered by the table. The transposition
+ * table is global: creating or resetting an engine clears it, the other searches only age it while
+ * an engine is alive, and engines must not search at the same time as each other or as the other
+ * searches.
+ */
+struct SearchEngine *new_search_engine();
+
+/**
+ * @brief Starts a new game with an engine, forgetting everything it learnt.
+ */
+void reset_search_engine(struct SearchEngine *engine);
+
+void free_search_engine(struct SearchEngine *engine);
+
+/**
+ * @brief Searches like `get_best_move_timed`, with the engine's kept state.
+ *
+ * @param engine The engine of the game, stops its ponder search if it is not running on another thread.
+ * @param state The current game state.
+ * @param budget The depth, time and node limits of the search.
+ *
+ * @return The best move, along with the depth completed and search statistics.
+ */
+struct SearchResult search_with_engine(struct SearchEngine *engine, struct State state, struct SearchBudget budget);
+
+/**
+ * @brief Starts pondering: searching, on the opponent's time, the position the engine expects to
+ * be in on its next move.
+ *
+ * The ponder search keeps the engine's state from the search that chose `move`, and its own across
+ * calls to `ponder`. Starting a ponder search stops the engine's previous one.
+ *
+ * @param engine The engine that chose `move`.
+ * @param state The position the engine searched.
+ * @param move The move the engine plays in `state`.
+ * @param predicted_reply The opponent's expected reply, usually the `ponder_move` of the search.
+ *
+ * @return True if pondering started, false if the reply is `None` or illegal, or either move ends
+ *         the game.
+ */
+bool start_pondering(struct SearchEngine *engine, struct State state, struct Move move, struct Move predicted_reply);
+
+/**
+ * @brief Runs the ponder search on the calling thread, deepening it until the time limit, until
+ * `stop_pondering` is called from another thread, or until it reaches `MAX_SEARCH_DEPTH`.
+ *
+ * Builds without threads (WASM) call this in slices between handling events. An iteration cut
+ * off by the end of a slice is repeated by the next one, mostly from the transposition table.
+ *
+ * @param engine The pondering engine.
+ * @param time_limit_ms The time to ponder for, 0 for no limit.
+ *
+ * @return True if pondering should go on, false once it has stopped or is complete.
+ */
+bool ponder(struct SearchEngine *engine, uint32_t time_limit_ms);
+
+/**
+ * @brief Stops pondering. Safe to call from any thread, a `ponder` call in progress returns soon
+ * after. The ponder search is kept for `get_best_move_pondered`.
+ */
+void stop_pondering(struct SearchEngine *engine);
+
+/**
+ * @brief Searches like `search_with_engine`, continuing the ponder search if `state` is the
+ * position it searched.
+ *
+ * On a hit the time and nodes spent pondering count against the budget: if the ponder search has
+ * already used the budget or reached its depth, its move is returned at once, otherwise it is
+ * deepened for what remains of the budget, keeping its transposition table, move ordering and
+ * principal variation. On a miss the position is searched with the engine as usual. Pondering
+ * must not be running on another thread.
+ *
+ * @param engine The engine of the game.
+ * @param state The current game state.
+ * @param budget The depth, time and node limits of the search.
+ *
+ * @return The best move, along with the depth completed and the search statistics, including the
+ *         ponder search's on a hit.
+ */
+struct SearchResult get_best_move_pondered(struct SearchEngine *engine, struct State state,
+                                           struct SearchBudget budget);
+
+/**
+ * @return The ponder counters of an engine, see `struct PonderStats`.
+ */
+const struct PonderStats *get_ponder_stats(const struct SearchEngine *engine);
+
+/**
+ * @return The statistics of the last search started on the calling thread, by any entry point
+ *         other than `get_best_move`.
+ */
+const struct SearchStats *get_last_search_stats();
+
+/**
+ * @brief Prints a table of search statistics, one row per iteration and the total.
+ */
+void print_search_stats(const struct SearchStats *stats);
+
 #endif //QUORIDOR_SEARCH_H
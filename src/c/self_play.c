@@ -0,0 +1,342 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <signal.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/wait.h>
+
+#include "state.h"
+#include "move.h"
+#include "engine_match.h"
+#include "game_record.h"
+
+#define SELF_PLAY_MAX_WORKERS 256
+
+// Random moves an opening may start with, the rest of a record is left for the engines' moves.
+#define SELF_PLAY_MAX_RANDOM_PLIES 255
+
+// Number of games between two progress reports.
+#define SELF_PLAY_REPORT_INTERVAL 1000
+
+_Static_assert(SELF_PLAY_MAX_RANDOM_PLIES + MATCH_MAX_PLIES <= GAME_RECORD_MAX_MOVES,
+               "A self-play game must fit in a record.");
+
+/**
+ * @struct SelfPlayWorker
+ * @brief A worker process and the pipe it sends its records through.
+ */
+struct SelfPlayWorker {
+    pid_t pid;
+    FILE *records;  // Unbuffered, so that every record waiting is seen by `poll`. NULL once read to the end.
+};
+
+/**
+ * @struct SelfPlaySummary
+ * @brief Counts of the records written or read.
+ */
+struct SelfPlaySummary {
+    uint64_t games;
+    uint64_t wins[3];  // Indexed by the winner, 0 for draws.
+    uint64_t moves;
+    uint64_t invalid;  // Records with an illegal move, only counted by `--summary`.
+};
+
+static void print_usage(const char *program) {
+    fprintf(stderr, "Usage: %s --engine1 <engine> [--engine2 <engine>] --output <file> [options]\n", program);
+    fprintf(stderr, "       %s --summary <file>\n", program);
+    print_engine_config_usage(stderr);
+    fprintf(stderr, "Options:\n");
+    fprintf(stderr, "  --games <n>                  Games to play (default 1000).\n");
+    fprintf(stderr, "  --concurrency <n>            Games played at once (default: one per core).\n");
+    fprintf(stderr, "  --random-plies <n>           Random moves each game starts with (default 8, at most %d).\n",
+            SELF_PLAY_MAX_RANDOM_PLIES);
+    fprintf(stderr, "  --seed <n>                   Seed of the random openings.\n");
+    fprintf(stderr, "Games are appended to the output file, the second engine is the first one by default.\n");
+    fprintf(stderr, "The engines swap sides from one game to the next.\n");
+    fprintf(stderr, "--summary reads a file back, checking that every move is legal.\n");
+}
+
+static double elapsed_seconds(const struct timespec *start) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double) (now.tv_sec - start->tv_sec) + (double) (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+static void count_record(struct SelfPlaySummary *summary, const struct GameRecord *record) {
+    summary->games++;
+    summary->wins[record->header.winner]++;
+    summary->moves += record->header.move_count;
+}
+
+static void print_summary(const struct SelfPlaySummary *summary, double seconds) {
+    printf("Games %llu: player 1 %llu, player 2 %llu, drawn %llu, %.1f moves per game, %.1f games/s",
+           (unsigned long long) summary->games, (unsigned long long) summary->wins[1],
+           (unsigned long long) summary->wins[2], (unsigned long long) summary->wins[0],
+           summary->games > 0 ? (double) summary->moves / (double) summary->games : 0.0,
+           seconds > 0 ? (double) summary->games / seconds : 0.0);
+    if (summary->invalid > 0) {
+        printf(", %llu invalid", (unsigned long long) summary->invalid);
+    }
+    printf("\n");
+    fflush(stdout);
+}
+
+/**
+ * @return The random state of a game's opening, which only depends on the seed and the game so
+ *         that the games do not depend on the concurrency.
+ */
+static uint64_t game_random_state(long seed, long game) {
+    uint64_t random_state = 0x9E3779B97F4A7C15ULL * (uint64_t) (seed + 1) + 0xBF58476D1CE4E5B9ULL * (uint64_t) game;
+
+    random_state = (random_state ^ (random_state >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    random_state = (random_state ^ (random_state >> 27)) * 0x94D049BB133111EBULL;
+    random_state ^= random_state >> 31;
+    return random_state != 0 ? random_state : 1;
+}
+
+/**
+ * @brief Plays every `stride`-th game from `first_game` on, writing each record to `output` as soon
+ * as it is played.
+ */
+static void run_worker(const struct EngineConfig *engines, long game_count, long first_game, long stride,
+                       int random_plies, long seed, FILE *output) {
+    struct GameRecord record;
+
+    for (long game = first_game; game < game_count; game += stride) {
+        // The first engine plays player 1 in even games.
+        const struct EngineConfig *player_1 = &engines[game % 2];
+        const struct EngineConfig *player_2 = &engines[1 - game % 2];
+        uint64_t random_state = game_random_state(seed, game);
+
+        record.header = (struct GameRecordHeader) {
+                .move_count = random_plies,
+                .opening_moves = random_plies,
+                .players = { engine_config_to_record_player(player_1), engine_config_to_record_player(player_2) },
+        };
+        const struct State opening = generate_opening(random_plies, &random_state, record.moves);
+        play_game(player_1, player_2, opening, &record);
+
+        if (!write_game_record(output, &record) || fflush(output) != 0) {
+            _exit(EXIT_FAILURE);
+        }
+    }
+}
+
+/**
+ * @brief Reads back a record file and prints its summary.
+ */
+static int summarize_records(const char *path) {
+    FILE *file = open_game_records(path, false);
+    if (file == NULL) {
+        fprintf(stderr, "%s is not a game record file.\n", path);
+        return EXIT_FAILURE;
+    }
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    struct GameRecord *record = malloc(sizeof(struct GameRecord));
+    if (record == NULL) {
+        exit(1);  // malloc failed, should probably log this somehow.
+    }
+
+    struct SelfPlaySummary summary = { 0 };
+    struct State state;
+    int result;
+
+    while ((result = read_game_record(file, record)) == 1) {
+        count_record(&summary, record);
+
+        if (!replay_game_record(record, &state) ||
+            (player_1_win_check(state) ? 1 : player_2_win_check(state) ? 2 : 0) != record->header.winner) {
+            summary.invalid++;
+        }
+    }
+
+    print_summary(&summary, elapsed_seconds(&start));
+    if (result < 0) {
+        fprintf(stderr, "Truncated or invalid record after %llu games.\n", (unsigned long long) summary.games);
+    }
+
+    free(record);
+    fclose(file);
+    return result < 0 || summary.invalid > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+int main(int argc, char **argv) {
+    struct EngineConfig engines[2];
+    bool engine_set[2] = { false, false };
+    const char *output_path = NULL;
+    long game_count = 1000, concurrency = sysconf(_SC_NPROCESSORS_ONLN), random_plies = 8, seed = 1;
+
+    if (argc == 3 && strcmp(argv[1], "--summary") == 0) {
+        return summarize_records(argv[2]);
+    }
+
+    for (int i = 1; i < argc; i++) {
+        const bool has_value = i + 1 < argc;
+
+        if ((strcmp(argv[i], "--engine1") == 0 || strcmp(argv[i], "--engine2") == 0) && has_value) {
+            const int engine = argv[i][8] - '1';
+            engine_set[engine] = parse_engine_config(argv[++i], &engines[engine]);
+            if (!engine_set[engine]) {
+                fprintf(stderr, "Invalid engine \"%s\".\n", argv[i]);
+                return EXIT_FAILURE;
+            }
+        } else if (strcmp(argv[i], "--output") == 0 && has_value) {
+            output_path = argv[++i];
+        } else if (strcmp(argv[i], "--games") == 0 && has_value) {
+            game_count = atol(argv[++i]);
+        } else if (strcmp(argv[i], "--concurrency") == 0 && has_value) {
+            concurrency = atol(argv[++i]);
+        } else if (strcmp(argv[i], "--random-plies") == 0 && has_value) {
+            random_plies = atol(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && has_value) {
+            seed = atol(argv[++i]);
+        } else {
+            print_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (!engine_set[0] || output_path == NULL || game_count <= 0 || concurrency <= 0 || random_plies < 0 ||
+        random_plies > SELF_PLAY_MAX_RANDOM_PLIES) {
+        print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    if (!engine_set[1]) {
+        engines[1] = engines[0];
+    }
+
+    concurrency = concurrency < game_count ? concurrency : game_count;
+    concurrency = concurrency < SELF_PLAY_MAX_WORKERS ? concurrency : SELF_PLAY_MAX_WORKERS;
+
+    FILE *output = open_game_records(output_path, true);
+    if (output == NULL) {
+        fprintf(stderr, "Cannot append games to %s.\n", output_path);
+        return EXIT_FAILURE;
+    }
+
+    printf("%s against %s, %ld games, %ld at once, appended to %s\n", engines[0].name, engines[1].name, game_count,
+           concurrency, output_path);
+    fflush(stdout);
+
+    // Games are played in worker processes rather than threads, as the transposition table and
+    // other engine state are global. Each worker has its own pipe, as records longer than PIPE_BUF
+    // written to a shared one could interleave.
+    struct SelfPlayWorker workers[SELF_PLAY_MAX_WORKERS];
+
+    // The workers must not inherit buffered output, which they would write again.
+    fflush(output);
+
+    for (int i = 0; i < concurrency; i++) {
+        int records[2];
+        if (pipe(records) != 0) {
+            perror("pipe");
+            return EXIT_FAILURE;
+        }
+
+        workers[i].pid = fork();
+
+        if (workers[i].pid < 0) {
+            perror("fork");
+            return EXIT_FAILURE;
+        }
+        if (workers[i].pid == 0) {
+            close(records[0]);
+            FILE *worker_output = fdopen(records[1], "wb");
+            if (worker_output == NULL) {
+                _exit(EXIT_FAILURE);
+            }
+            run_worker(engines, game_count, i, concurrency, (int) random_plies, seed, worker_output);
+            _exit(EXIT_SUCCESS);
+        }
+
+        close(records[1]);
+        workers[i].records = fdopen(records[0], "rb");
+        if (workers[i].records == NULL) {
+            perror("fdopen");
+            return EXIT_FAILURE;
+        }
+        setvbuf(workers[i].records, NULL, _IONBF, 0);
+    }
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    struct GameRecord *record = malloc(sizeof(struct GameRecord));
+    if (record == NULL) {
+        exit(1);  // malloc failed, should probably log this somehow.
+    }
+
+    struct SelfPlaySummary summary = { 0 };
+    struct pollfd polled[SELF_PLAY_MAX_WORKERS];
+    int polled_workers[SELF_PLAY_MAX_WORKERS];
+    bool written = true, worker_failed = false;
+
+    while (written && !worker_failed) {
+        int polled_count = 0;
+        for (int i = 0; i < concurrency; i++) {
+            if (workers[i].records != NULL) {
+                polled[polled_count] = (struct pollfd) { .fd = fileno(workers[i].records), .events = POLLIN };
+                polled_workers[polled_count++] = i;
+            }
+        }
+        if (polled_count == 0) {
+            break;
+        }
+        if (poll(polled, polled_count, -1) < 0) {
+            continue;  // Interrupted by a signal.
+        }
+
+        // Workers write each record at once, so reading one that has started does not wait for long.
+        for (int i = 0; i < polled_count && written && !worker_failed; i++) {
+            if (polled[i].revents == 0) {
+                continue;
+            }
+
+            struct SelfPlayWorker *worker = &workers[polled_workers[i]];
+            const int result = read_game_record(worker->records, record);
+
+            if (result == 1) {
+                written = write_game_record(output, record);
+                count_record(&summary, record);
+
+                if (summary.games % SELF_PLAY_REPORT_INTERVAL == 0) {
+                    print_summary(&summary, elapsed_seconds(&start));
+                }
+            } else {
+                worker_failed = result < 0;
+                fclose(worker->records);
+                worker->records = NULL;
+            }
+        }
+    }
+
+    if (!written || worker_failed) {
+        for (int i = 0; i < concurrency; i++) {
+            kill(workers[i].pid, SIGTERM);
+        }
+    }
+    for (int i = 0; i < concurrency; i++) {
+        waitpid(workers[i].pid, NULL, 0);
+        if (workers[i].records != NULL) {
+            fclose(workers[i].records);
+        }
+    }
+    free(record);
+
+    written = fclose(output) == 0 && written;
+    if (!written) {
+        fprintf(stderr, "Writing to %s failed.\n", output_path);
+    }
+    if (worker_failed) {
+        fprintf(stderr, "A worker sent an invalid record.\n");
+    }
+
+    printf("\nFinal: ");
+    print_summary(&summary, elapsed_seconds(&start));
+    return written && summary.games == (uint64_t) game_count ? EXIT_SUCCESS : EXIT_FAILURE;
+}
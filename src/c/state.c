@@ -2,14 +2,23 @@
 #include <assert.h>
 #include <locale.h>
 #include <stdio.h>
+#include <stddef.h>
 #include "state.h"
 #include "move_generation.h"
 #include "evaluate.h"
+#include "zobrist.h"
 
-#define switch_player(state) state->player_to_move ^= 0b11
+#define switch_player(state) do {                    \
+        state->player_to_move ^= 0b11;               \
+        state->hash ^= zobrist_player_2_to_move_key; \
+    } while (0)
+
+_Static_assert(offsetof(struct State, pawns[1].row) == offsetof(struct State, player_2_row) &&
+               offsetof(struct State, pawns[1].col) == offsetof(struct State, player_2_col),
+               "The pawns must alias the named pawn squares.");
 
 struct State new_state() {
-    return (struct State) {
+    struct State state = {
             .vertical_fences = 0,
             .horizontal_fences = 0,
             .player_1_row = BOARD_SIZE - 1,
@@ -20,6 +29,14 @@ struct State new_state() {
             .player_2_fence_count = 10,
             .player_to_move = 1,
     };
+    recompute_derived_state(&state);
+    return state;
+}
+
+void recompute_derived_state(struct State *state) {
+    state->hash = compute_zobrist_hash(state);
+    generate_bitboards(state, &state->bitboards);
+    build_wall_graph(state, &state->walls);
 }
 
 void print_state(struct State state) {
@@ -99,13 +116,20 @@ bool equal_states(struct State state1, struct State state2) {
 }
 
 void make_horizontal_fence_move(struct State *state, FenceMove move) {
-    assert(generate_pseudo_legal_horizontal_fence_moves(*state) & move && "Illegal fence move, fence in the way.");
+    assert(generate_pseudo_legal_horizontal_fence_moves(state) & move && "Illegal fence move, fence in the way.");
     state->horizontal_fences |= move;
+    state->hash ^= zobrist_horizontal_fence_key(__builtin_ctzll(move));
+    add_horizontal_fence_to_bitboards(&state->bitboards, __builtin_ctzll(move));
+    add_fence_to_wall_graph(&state->walls, __builtin_ctzll(move), false);
 
     if (state->player_to_move == 1) {
+        state->hash ^= zobrist_player_1_fence_count_key(state->player_1_fence_count);
         state->player_1_fence_count--;
+        state->hash ^= zobrist_player_1_fence_count_key(state->player_1_fence_count);
     } else {
+        state->hash ^= zobrist_player_2_fence_count_key(state->player_2_fence_count);
         state->player_2_fence_count--;
+        state->hash ^= zobrist_player_2_fence_count_key(state->player_2_fence_count);
     }
 
     switch_player(state);
@@ -114,24 +138,38 @@ void make_horizontal_fence_move(struct State *state, FenceMove move) {
 void unmake_horizontal_fence_move(struct State *state, FenceMove move) {
     assert(state->horizontal_fences & move && "No horizontal fence at this location.");
     state->horizontal_fences &= ~move;
+    state->hash ^= zobrist_horizontal_fence_key(__builtin_ctzll(move));
+    remove_horizontal_fence_from_bitboards(&state->bitboards, __builtin_ctzll(move));
+    remove_fence_from_wall_graph(state, __builtin_ctzll(move), false);
 
     if (state->player_to_move == 2) {
+        state->hash ^= zobrist_player_1_fence_count_key(state->player_1_fence_count);
         state->player_1_fence_count++;
+        state->hash ^= zobrist_player_1_fence_count_key(state->player_1_fence_count);
     } else {
+        state->hash ^= zobrist_player_2_fence_count_key(state->player_2_fence_count);
         state->player_2_fence_count++;
+        state->hash ^= zobrist_player_2_fence_count_key(state->player_2_fence_count);
     }
 
     switch_player(state);
 }
 
 void make_vertical_fence_move(struct State *state, FenceMove move) {
-    assert(generate_pseudo_legal_vertical_fence_moves(*state) & move && "Illegal fence move, fence in the way.");
+    assert(generate_pseudo_legal_vertical_fence_moves(state) & move && "Illegal fence move, fence in the way.");
     state->vertical_fences |= move;
+    state->hash ^= zobrist_vertical_fence_key(__builtin_ctzll(move));
+    add_vertical_fence_to_bitboards(&state->bitboards, __builtin_ctzll(move));
+    add_fence_to_wall_graph(&state->walls, __builtin_ctzll(move), true);
 
     if (state->player_to_move == 1) {
+        state->hash ^= zobrist_player_1_fence_count_key(state->player_1_fence_count);
         state->player_1_fence_count--;
+        state->hash ^= zobrist_player_1_fence_count_key(state->player_1_fence_count);
     } else {
+        state->hash ^= zobrist_player_2_fence_count_key(state->player_2_fence_count);
         state->player_2_fence_count--;
+        state->hash ^= zobrist_player_2_fence_count_key(state->player_2_fence_count);
     }
 
     switch_player(state);
@@ -140,215 +178,70 @@ void make_vertical_fence_move(struct State *state, FenceMove move) {
 void unmake_vertical_fence_move(struct State *state, FenceMove move) {
     assert(state->vertical_fences & move && "No vertical fence at this location.");
     state->vertical_fences &= ~move;
+    state->hash ^= zobrist_vertical_fence_key(__builtin_ctzll(move));
+    remove_vertical_fence_from_bitboards(&state->bitboards, __builtin_ctzll(move));
+    remove_fence_from_wall_graph(state, __builtin_ctzll(move), true);
 
     if (state->player_to_move == 2) {
+        state->hash ^= zobrist_player_1_fence_count_key(state->player_1_fence_count);
         state->player_1_fence_count++;
+        state->hash ^= zobrist_player_1_fence_count_key(state->player_1_fence_count);
     } else {
+        state->hash ^= zobrist_player_2_fence_count_key(state->player_2_fence_count);
         state->player_2_fence_count++;
+        state->hash ^= zobrist_player_2_fence_count_key(state->player_2_fence_count);
     }
 
     switch_player(state);
 }
 
+/**
+ * @brief Moves the pawn of `player` by the offsets of a pawn move, `direction` times (-1 to take
+ * the move back), updating the hash and passing the turn. The callers pass constants for `player`
+ * and `direction`, so that it is compiled into a branchless version for each side.
+ */
+static inline __attribute__((always_inline)) void move_pawn(struct State *state, const int player, PawnMove move,
+                                                             const int direction) {
+    const int index = __builtin_ctz(move);
+    struct PawnSquare *pawn = &state->pawns[player - 1];
+
+    assert(move != 0 && index < PAWN_MOVE_TYPE_COUNT && "move_pawn: Unrecognized pawn move.");
+
+    state->hash ^= zobrist_player_2_to_move_key ^ zobrist_player_square_key(player, pawn->row, pawn->col);
+    pawn->row += direction * pawn_move_row_offsets[index];
+    pawn->col += direction * pawn_move_col_offsets[index];
+    assert(pawn->row < BOARD_SIZE && pawn->col < BOARD_SIZE);
+    state->hash ^= zobrist_player_square_key(player, pawn->row, pawn->col);
+    state->player_to_move ^= 0b11;
+}
+
+void make_player_1_pawn_move(struct State *state, PawnMove move) {
+    assert(state->player_to_move == 1);
+    move_pawn(state, 1, move, 1);
+}
+
+void make_player_2_pawn_move(struct State *state, PawnMove move) {
+    assert(state->player_to_move == 2);
+    move_pawn(state, 2, move, 1);
+}
+
+void unmake_player_1_pawn_move(struct State *state, PawnMove move) {
+    assert(state->player_to_move == 2);
+    move_pawn(state, 1, move, -1);
+}
+
+void unmake_player_2_pawn_move(struct State *state, PawnMove move) {
+    assert(state->player_to_move == 1);
+    move_pawn(state, 2, move, -1);
+}
+
 void make_pawn_move(struct State *state, PawnMove move) {
-    assert(generate_legal_pawn_moves(*state) & move && "Illegal pawn move, fence in the way.");
-    if (state->player_to_move == 1) {
-        state->player_to_move = 2;
-        switch (move) {
-            case North:
-                state->player_1_row -= 1;
-                break;
-            case East:
-                state->player_1_col += 1;
-                break;
-            case South:
-                state->player_1_row += 1;
-                break;
-            case West:
-                state->player_1_col -= 1;
-                break;
-            case NorthNorth:
-                state->player_1_row -= 2;
-                break;
-            case EastEast:
-                state->player_1_col += 2;
-                break;
-            case SouthSouth:
-                state->player_1_row += 2;
-                break;
-            case WestWest:
-                state->player_1_col -= 2;
-                break;
-            case NorthEast:
-                state->player_1_col += 1;
-                state->player_1_row -= 1;
-                break;
-            case NorthWest:
-                state->player_1_col -= 1;
-                state->player_1_row -= 1;
-                break;
-            case SouthEast:
-                state->player_1_col += 1;
-                state->player_1_row += 1;
-                break;
-            case SouthWest:
-                state->player_1_col -= 1;
-                state->player_1_row += 1;
-                break;
-            default:
-                assert(false && "make_pawn_move: Unrecognized pawn move.");
-        }
-        assert(state->player_1_row >= 0);
-        assert(state->player_1_col <= BOARD_SIZE - 1);
-    } else {
-        state->player_to_move = 1;
-        switch (move) {
-            case North:
-                state->player_2_row -= 1;
-                break;
-            case East:
-                state->player_2_col += 1;
-                break;
-            case South:
-                state->player_2_row += 1;
-                break;
-            case West:
-                state->player_2_col -= 1;
-                break;
-            case NorthNorth:
-                state->player_2_row -= 2;
-                break;
-            case EastEast:
-                state->player_2_col += 2;
-                break;
-            case SouthSouth:
-                state->player_2_row += 2;
-                break;
-            case WestWest:
-                state->player_2_col -= 2;
-                break;
-            case NorthEast:
-                state->player_2_col += 1;
-                state->player_2_row -= 1;
-                break;
-            case NorthWest:
-                state->player_2_col -= 1;
-                state->player_2_row -= 1;
-                break;
-            case SouthEast:
-                state->player_2_col += 1;
-                state->player_2_row += 1;
-                break;
-            case SouthWest:
-                state->player_2_col -= 1;
-                state->player_2_row += 1;
-                break;
-            default:
-                assert(false && "make_pawn_move: Unrecognized pawn move.");
-        }
-        assert(state->player_2_row >= 0);
-        assert(state->player_2_col <= BOARD_SIZE - 1);
-    }
+    assert(generate_legal_pawn_moves(state) & move && "Illegal pawn move, fence in the way.");
+    move_pawn(state, state->player_to_move, move, 1);
 }
 
 void unmake_pawn_move(struct State *state, PawnMove move) {
-    if (state->player_to_move == 2) {
-        state->player_to_move = 1;
-        switch (move) {
-            case North:
-                state->player_1_row += 1;
-                break;
-            case East:
-                state->player_1_col -= 1;
-                break;
-            case South:
-                state->player_1_row -= 1;
-                break;
-            case West:
-                state->player_1_col += 1;
-                break;
-            case NorthNorth:
-                state->player_1_row += 2;
-                break;
-            case EastEast:
-                state->player_1_col -= 2;
-                break;
-            case SouthSouth:
-                state->player_1_row -= 2;
-                break;
-            case WestWest:
-                state->player_1_col += 2;
-                break;
-            case NorthEast:
-                state->player_1_col -= 1;
-                state->player_1_row += 1;
-                break;
-            case NorthWest:
-                state->player_1_col += 1;
-                state->player_1_row += 1;
-                break;
-            case SouthEast:
-                state->player_1_col -= 1;
-                state->player_1_row -= 1;
-                break;
-            case SouthWest:
-                state->player_1_col += 1;
-                state->player_1_row -= 1;
-                break;
-            default:
-                assert(false && "unmake_pawn_move: Unrecognized pawn move.");
-        }
-        assert(state->player_1_row >= 0);
-        assert(state->player_1_col <= BOARD_SIZE - 1);
-    } else {
-        state->player_to_move = 2;
-        switch (move) {
-            case North:
-                state->player_2_row += 1;
-                break;
-            case East:
-                state->player_2_col -= 1;
-                break;
-            case South:
-                state->player_2_row -= 1;
-                break;
-            case West:
-                state->player_2_col += 1;
-                break;
-            case NorthNorth:
-                state->player_2_row += 2;
-                break;
-            case EastEast:
-                state->player_2_col -= 2;
-                break;
-            case SouthSouth:
-                state->player_2_row -= 2;
-                break;
-            case WestWest:
-                state->player_2_col += 2;
-                break;
-            case NorthEast:
-                state->player_2_col -= 1;
-                state->player_2_row += 1;
-                break;
-            case NorthWest:
-                state->player_2_col += 1;
-                state->player_2_row += 1;
-                break;
-            case SouthEast:
-                state->player_2_col -= 1;
-                state->player_2_row -= 1;
-                break;
-            case SouthWest:
-                state->player_2_col += 1;
-                state->player_2_row -= 1;
-                break;
-            default:
-                assert(false && "unmake_pawn_move: Unrecognized pawn move.");
-        }
-        assert(state->player_2_row >= 0);
-        assert(state->player_2_col <= BOARD_SIZE - 1);
-    }
+    move_pawn(state, state->player_to_move ^ 0b11, move, -1);
 }
 
 void make_move(struct State *state, struct Move *move) {
@@ -389,34 +282,47 @@ void unmake_move(struct State *state, struct Move *move) {
     }
 }
 
+void make_null_move(struct State *state) {
+    switch_player(state);
+}
+
 bool move_is_fully_legal(struct State *state, struct Move move) {
     bool move_is_legal;
     FenceMoves legal_fence_moves;
     switch (move.moveType) {
         case VerticalFence:
-            legal_fence_moves = generate_pseudo_legal_vertical_fence_moves(*state);
+            legal_fence_moves = generate_pseudo_legal_vertical_fence_moves(state);
 
             if ((legal_fence_moves & move.move.fenceMove) == 0) {
                 return false;
             }
 
+            // A fence that closes no loop of walls cannot disconnect any square.
+            if (!fence_closes_wall_loop(&state->walls, __builtin_ctzll(move.move.fenceMove), true)) {
+                return true;
+            }
+
             make_vertical_fence_move(state, move.move.fenceMove);
-            move_is_legal = evaluate(*state) != NO_PATH_FOUND;
+            move_is_legal = evaluate(state) != NO_PATH_FOUND;
             unmake_vertical_fence_move(state, move.move.fenceMove);
             return move_is_legal;
         case HorizontalFence:
-            legal_fence_moves = generate_pseudo_legal_horizontal_fence_moves(*state);
+            legal_fence_moves = generate_pseudo_legal_horizontal_fence_moves(state);
 
             if ((legal_fence_moves & move.move.fenceMove) == 0) {
                 return false;
             }
 
+            if (!fence_closes_wall_loop(&state->walls, __builtin_ctzll(move.move.fenceMove), false)) {
+                return true;
+            }
+
             make_horizontal_fence_move(state, move.move.fenceMove);
-            move_is_legal = evaluate(*state) != NO_PATH_FOUND;
+            move_is_legal = evaluate(state) != NO_PATH_FOUND;
             unmake_horizontal_fence_move(state, move.move.fenceMove);
             return move_is_legal;
         case Pawn:
-            return generate_legal_pawn_moves(*state) && move.move.pawnMove;
+            return generate_legal_pawn_moves(state) & move.move.pawnMove;
         case None:
             assert(move.moveType != None);  // Return false instead?
             break;
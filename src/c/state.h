@@ -4,6 +4,8 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include "move.h"
+#include "bitboards.h"
+#include "wall_graph.h"
 
 #define BOARD_SIZE 9
 #define FENCE_BIT_BOARD_WIDTH (BOARD_SIZE - 1)
@@ -28,20 +30,47 @@
 #define player_1_win_check(state)  ((state).player_1_row == 0)
 #define player_2_win_check(state)  ((state).player_2_row == BOARD_SIZE - 1)
 
+/**
+ * @struct PawnSquare
+ * @brief The square of a pawn.
+ */
+struct PawnSquare {
+    uint8_t row;
+    uint8_t col;
+};
+
 struct State {
     uint64_t vertical_fences;
     uint64_t horizontal_fences;
-    uint8_t player_1_row;
-    uint8_t player_1_col;
-    uint8_t player_2_row;
-    uint8_t player_2_col;
+    union {
+        struct {
+            uint8_t player_1_row;
+            uint8_t player_1_col;
+            uint8_t player_2_row;
+            uint8_t player_2_col;
+        };
+        struct PawnSquare pawns[2];  // The same squares, indexed by player - 1.
+    };
     uint8_t player_1_fence_count;
     uint8_t player_2_fence_count;
     uint8_t player_to_move;
+    uint64_t hash;  // Zobrist hash, kept up to date by the make/unmake functions.
+    struct Bitboards bitboards;  // Fence bitboards, kept up to date by the fence make/unmake functions.
+    struct WallGraph walls;      // Wall connectivity, kept up to date by the fence make/unmake functions.
 };
 
 struct State new_state();
 
+/**
+ * @brief Recomputes the fields of a state that are derived from the rest of the struct.
+ *
+ * The make/unmake functions keep these fields up to date incrementally, so this only needs
+ * to be called when the fields of a state have been written directly (e.g. from JavaScript).
+ *
+ * @param state The game state to update.
+ */
+void recompute_derived_state(struct State *state);
+
 void print_state(struct State state);
 
 bool equal_states(struct State state1, struct State state2);
@@ -58,10 +87,63 @@ void make_pawn_move(struct State *state, PawnMove move);
 
 void unmake_pawn_move(struct State *state, PawnMove move);
 
+/**
+ * @brief Side specialised versions of `make_pawn_move` and `unmake_pawn_move`, for callers that
+ * know which player is moving. `make_player_1_pawn_move` must only be called with player 1 to
+ * move, and `unmake_player_1_pawn_move` with player 2 to move after player 1's move, and so on.
+ */
+void make_player_1_pawn_move(struct State *state, PawnMove move);
+
+void make_player_2_pawn_move(struct State *state, PawnMove move);
+
+void unmake_player_1_pawn_move(struct State *state, PawnMove move);
+
+void unmake_player_2_pawn_move(struct State *state, PawnMove move);
+
 void make_move(struct State *state, struct Move *move);
 
 void unmake_move(struct State *state, struct Move *move);
 
+/**
+ * @brief `make_move` for callers that know the player to move, pawn moves use the side
+ * specialised versions.
+ *
+ * @param state The game state to update.
+ * @param move The move to make.
+ * @param player The player to move, who makes the move.
+ */
+static inline void make_player_move(struct State *state, struct Move *move, const int player) {
+    if (move->moveType != Pawn) {
+        make_move(state, move);
+    } else if (player == 1) {
+        make_player_1_pawn_move(state, move->move.pawnMove);
+    } else {
+        make_player_2_pawn_move(state, move->move.pawnMove);
+    }
+}
+
+/**
+ * @brief `unmake_move` for callers that know the player who made the move, see `make_player_move`.
+ */
+static inline void unmake_player_move(struct State *state, struct Move *move, const int player) {
+    if (move->moveType != Pawn) {
+        unmake_move(state, move);
+    } else if (player == 1) {
+        unmake_player_1_pawn_move(state, move->move.pawnMove);
+    } else {
+        unmake_player_2_pawn_move(state, move->move.pawnMove);
+    }
+}
+
+/**
+ * @brief Passes the turn to the other player, for null move pruning in the search.
+ *
+ * Passing is not a legal move. Making a null move a second time undoes it.
+ *
+ * @param state The game state to update.
+ */
+void make_null_move(struct State *state);
+
 bool move_is_fully_legal(struct State *state, struct Move move);
 
 bool win_check(struct State *state);
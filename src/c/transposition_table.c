@@ -0,0 +1,144 @@
+#include <string.h>
+#include <stdatomic.h>
+#include "transposition_table.h"
+#include "evaluate.h"
+
+/**
+ * Bit layout of `TranspositionSlot.data`.
+ */
+#define DATA_SCORE_SHIFT 0
+#define DATA_DEPTH_SHIFT 16
+#define DATA_BOUND_SHIFT 24
+#define DATA_MOVE_SHIFT  32
+#define DATA_GENERATION_SHIFT 40
+
+struct TranspositionSlot {
+    _Atomic uint64_t checked_key;  // key ^ data
+    _Atomic uint64_t data;
+};
+
+struct TranspositionBucket {
+    struct TranspositionSlot slots[TRANSPOSITION_TABLE_BUCKET_SIZE];
+} __attribute__((aligned(64)));
+
+_Static_assert(sizeof(struct TranspositionSlot) == 16, "Transposition slots must be 16 bytes.");
+_Static_assert(sizeof(struct TranspositionBucket) == 64, "Transposition buckets must fill one cache line.");
+
+static struct TranspositionBucket table[TRANSPOSITION_TABLE_BUCKET_COUNT];
+
+// Generation of the entries being stored, wraps around.
+static uint8_t generation = 0;
+
+static inline struct TranspositionBucket *get_bucket(uint64_t key) {
+    return &table[key & (TRANSPOSITION_TABLE_BUCKET_COUNT - 1)];
+}
+
+static inline uint64_t pack_entry(const struct TranspositionEntry *entry) {
+    return (uint64_t) (uint16_t) entry->score << DATA_SCORE_SHIFT |
+           (uint64_t) entry->depth << DATA_DEPTH_SHIFT |
+           (uint64_t) entry->bound << DATA_BOUND_SHIFT |
+           (uint64_t) entry->move << DATA_MOVE_SHIFT |
+           (uint64_t) entry->generation << DATA_GENERATION_SHIFT;
+}
+
+static inline struct TranspositionEntry unpack_entry(uint64_t key, uint64_t data) {
+    return (struct TranspositionEntry) {
+            .key = key,
+            .score = (int16_t) (uint16_t) (data >> DATA_SCORE_SHIFT),
+            .depth = (uint8_t) (data >> DATA_DEPTH_SHIFT),
+            .bound = (uint8_t) (data >> DATA_BOUND_SHIFT),
+            .move = (EncodedMove) (data >> DATA_MOVE_SHIFT),
+            .generation = (uint8_t) (data >> DATA_GENERATION_SHIFT),
+    };
+}
+
+/**
+ * @brief Reads a slot, returning false if it is empty or does not belong to `key`.
+ */
+static inline bool read_slot(struct TranspositionSlot *slot, uint64_t key, struct TranspositionEntry *entry) {
+    const uint64_t data = atomic_load_explicit(&slot->data, memory_order_relaxed);
+    const uint64_t checked_key = atomic_load_explicit(&slot->checked_key, memory_order_relaxed);
+
+    if ((checked_key ^ data) != key) {
+        return false;
+    }
+
+    *entry = unpack_entry(key, data);
+    return entry->bound != BoundNone;
+}
+
+void clear_transposition_table() {
+    memset(table, 0, sizeof(table));
+    generation = 0;
+}
+
+void age_transposition_table() {
+    generation++;
+}
+
+bool probe_transposition_table(uint64_t key, struct TranspositionEntry *entry) {
+    struct TranspositionBucket *bucket = get_bucket(key);
+
+    for (int i = 0; i < TRANSPOSITION_TABLE_BUCKET_SIZE; i++) {
+        if (read_slot(&bucket->slots[i], key, entry)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void store_transposition_table_entry(uint64_t key, int depth, enum Bound bound, int score, struct Move move) {
+    struct TranspositionBucket *bucket = get_bucket(key);
+    struct TranspositionSlot *replace = NULL;
+    int replace_value = INT32_MAX;
+
+    for (int i = 0; i < TRANSPOSITION_TABLE_BUCKET_SIZE; i++) {
+        struct TranspositionSlot *slot = &bucket->slots[i];
+        const uint64_t data = atomic_load_explicit(&slot->data, memory_order_relaxed);
+        const uint64_t checked_key = atomic_load_explicit(&slot->checked_key, memory_order_relaxed);
+        const int slot_depth = (uint8_t) (data >> DATA_DEPTH_SHIFT);
+
+        if ((checked_key ^ data) == key) {
+            if (depth < slot_depth && bound != BoundExact) {
+                return;
+            }
+            replace = slot;
+            break;
+        }
+
+        const int age = (uint8_t) (generation - (uint8_t) (data >> DATA_GENERATION_SHIFT));
+        const int slot_value = slot_depth - TRANSPOSITION_TABLE_AGE_WEIGHT * age;
+        if (slot_value < replace_value) {
+            replace = slot;
+            replace_value = slot_value;
+        }
+    }
+
+    const struct TranspositionEntry entry = {
+            .key = key,
+            .score = (int16_t) score_to_transposition_table(score, depth),
+            .depth = (uint8_t) depth,
+            .bound = (uint8_t) bound,
+            .move = encode_move(move),
+            .generation = generation,
+    };
+    const uint64_t data = pack_entry(&entry);
+
+    atomic_store_explicit(&replace->data, data, memory_order_relaxed);
+    atomic_store_explicit(&replace->checked_key, key ^ data, memory_order_relaxed);
+}
+
+int score_to_transposition_table(int score, int depth) {
+    if (is_winning_score(score)) {
+        return score > 0 ? score - depth : score + depth;
+    }
+    return score;
+}
+
+int score_from_transposition_table(int score, int depth) {
+    if (is_winning_score(score)) {
+        return score > 0 ? score + depth : score - depth;
+    }
+    return score;
+}
@@ -0,0 +1,106 @@
+#ifndef QUORIDOR_TRANSPOSITION_TABLE_H
+#define QUORIDOR_TRANSPOSITION_TABLE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "move.h"
+
+#define TRANSPOSITION_TABLE_BUCKET_SIZE 4
+#define TRANSPOSITION_TABLE_BUCKET_COUNT (1 << 16)  // 4 MiB with 16 byte entries
+
+// Plies of depth an entry is worth less for each search it was not stored by, when choosing the
+// entry of a bucket to replace.
+#define TRANSPOSITION_TABLE_AGE_WEIGHT 2
+
+/**
+ * Describes how the stored score relates to the true score of the position.
+ *  - `BoundExact`: The score is exact (it fell inside the search window).
+ *  - `BoundLower`: The search failed high, the true score is at least the stored score.
+ *  - `BoundUpper`: The search failed low, the true score is at most the stored score.
+ */
+enum Bound {
+    BoundNone,
+    BoundUpper,
+    BoundLower,
+    BoundExact,
+};
+
+/**
+ * @struct TranspositionEntry
+ * @brief The data of a single transposition table entry.
+ *
+ * In the table each entry is packed into a 16 byte slot and four slots make up one 64 byte
+ * bucket, so a probe only ever touches a single cache line. Winning scores are stored relative
+ * to the node (see `score_to_transposition_table`) so that they can be reused at a different
+ * remaining depth.
+ *
+ * Entries also record the generation of the table they were stored in. Searches that keep the
+ * table from the previous move age it instead of clearing it, so that entries of earlier searches
+ * are replaced first while still being found by probes.
+ *
+ * The table is shared by all search threads without locking. A slot stores its key XORed with
+ * its data, so a slot that is torn by two threads writing it at once fails the key check on probe
+ * and is treated as a miss.
+ */
+struct TranspositionEntry {
+    uint64_t key;
+    int16_t score;
+    uint8_t depth;
+    uint8_t bound;
+    EncodedMove move;
+    uint8_t generation;
+};
+
+/**
+ * @brief Clears every entry of the transposition table.
+ *
+ * Must not be called while a search is running.
+ */
+void clear_transposition_table();
+
+/**
+ * @brief Starts a new generation of the transposition table, making every entry stored so far one
+ * search older.
+ *
+ * Must not be called while a search is running.
+ */
+void age_transposition_table();
+
+/**
+ * @brief Looks up a position in the transposition table.
+ *
+ * @param key The Zobrist hash of the position.
+ * @param entry Pointer to an entry that the stored data is copied into on a hit.
+ * @return True if the position was found.
+ */
+bool probe_transposition_table(uint64_t key, struct TranspositionEntry *entry);
+
+/**
+ * @brief Stores the result of searching a position.
+ *
+ * Entries for the same position are overwritten by searches that are at least as deep (or exact),
+ * otherwise the shallowest entry of the bucket is replaced, counting older generations as
+ * shallower by `TRANSPOSITION_TABLE_AGE_WEIGHT` plies per generation.
+ *
+ * @param key The Zobrist hash of the position.
+ * @param depth The remaining depth the position was searched to.
+ * @param bound How `score` relates to the true score of the position.
+ * @param score The score of the position, as returned by the search.
+ * @param move The best move found, `None` if there is no move to store.
+ */
+void store_transposition_table_entry(uint64_t key, int depth, enum Bound bound, int score, struct Move move);
+
+/**
+ * @brief Converts a search score into the form it is stored in.
+ *
+ * Winning scores are `WINNING_SCORE + remaining depth` at the terminal node, so they are stored
+ * relative to the remaining depth of the node they were found from.
+ */
+int score_to_transposition_table(int score, int depth);
+
+/**
+ * @brief Converts a stored score back into a search score at the given remaining depth.
+ */
+int score_from_transposition_table(int score, int depth);
+
+#endif //QUORIDOR_TRANSPOSITION_TABLE_H
@@ -0,0 +1,111 @@
+#include "wall_graph.h"
+#include "state.h"
+
+/**
+ * @brief Finds the vertices at the two ends of a fence, the centre vertex is the fence index.
+ */
+static inline void get_fence_ends(int fence_index, bool vertical, uint8_t *start, uint8_t *end) {
+    const int row = fence_index / FENCE_BIT_BOARD_WIDTH;
+    const int col = fence_index % FENCE_BIT_BOARD_WIDTH;
+
+    if (vertical) {
+        *start = row > 0 ? fence_index - FENCE_BIT_BOARD_WIDTH : WALL_GRAPH_BORDER;
+        *end = row < FENCE_BIT_BOARD_WIDTH - 1 ? fence_index + FENCE_BIT_BOARD_WIDTH : WALL_GRAPH_BORDER;
+    } else {
+        *start = col > 0 ? fence_index - 1 : WALL_GRAPH_BORDER;
+        *end = col < FENCE_BIT_BOARD_WIDTH - 1 ? fence_index + 1 : WALL_GRAPH_BORDER;
+    }
+}
+
+static inline uint8_t find_wall_component(const struct WallGraph *graph, uint8_t vertex) {
+    while (graph->parent[vertex] != vertex) {
+        vertex = graph->parent[vertex];
+    }
+    return vertex;
+}
+
+/**
+ * @brief Joins the components of two vertices.
+ *
+ * @return The root that was linked below the other one, or `WALL_GRAPH_NO_LINK` if the vertices
+ *         were already connected.
+ */
+static inline uint8_t join_wall_components(struct WallGraph *graph, uint8_t a, uint8_t b) {
+    const uint8_t root_a = find_wall_component(graph, a);
+    const uint8_t root_b = find_wall_component(graph, b);
+
+    if (root_a == root_b) {
+        return WALL_GRAPH_NO_LINK;
+    }
+
+    // Most fences end up connected to the border, keeping it a root keeps its trees shallow.
+    if (root_a == WALL_GRAPH_BORDER) {
+        graph->parent[root_b] = root_a;
+        return root_b;
+    }
+
+    graph->parent[root_a] = root_b;
+    return root_a;
+}
+
+void build_wall_graph(const struct State *state, struct WallGraph *graph) {
+    for (int vertex = 0; vertex < WALL_GRAPH_VERTEX_COUNT; vertex++) {
+        graph->parent[vertex] = vertex;
+    }
+    graph->undo_count = 0;
+
+    for (uint64_t fences = state->vertical_fences; fences != 0; fences &= fences - 1) {
+        add_fence_to_wall_graph(graph, __builtin_ctzll(fences), true);
+    }
+    for (uint64_t fences = state->horizontal_fences; fences != 0; fences &= fences - 1) {
+        add_fence_to_wall_graph(graph, __builtin_ctzll(fences), false);
+    }
+}
+
+void add_fence_to_wall_graph(struct WallGraph *graph, int fence_index, bool vertical) {
+    uint8_t start, end;
+    get_fence_ends(fence_index, vertical, &start, &end);
+
+    const uint8_t start_link = join_wall_components(graph, start, fence_index);
+    const uint8_t end_link = join_wall_components(graph, end, fence_index);
+
+    // Beyond the undo capacity the fence is still added, removing it rebuilds the graph.
+    if (graph->undo_count < WALL_GRAPH_UNDO_SIZE) {
+        graph->undo_fences[graph->undo_count] = fence_index + (vertical ? 0 : 64);
+        graph->undo_links[graph->undo_count][0] = start_link;
+        graph->undo_links[graph->undo_count][1] = end_link;
+    }
+    graph->undo_count++;
+}
+
+void remove_fence_from_wall_graph(struct State *state, int fence_index, bool vertical) {
+    struct WallGraph *graph = &state->walls;
+    const int last = graph->undo_count - 1;
+
+    if (last < 0 || last >= WALL_GRAPH_UNDO_SIZE || graph->undo_fences[last] != fence_index + (vertical ? 0 : 64)) {
+        build_wall_graph(state, graph);
+        return;
+    }
+
+    // Undone in the reverse order of the links, each linked root becomes a root again.
+    for (int i = 1; i >= 0; i--) {
+        const uint8_t link = graph->undo_links[last][i];
+
+        if (link != WALL_GRAPH_NO_LINK) {
+            graph->parent[link] = link;
+        }
+    }
+    graph->undo_count--;
+}
+
+bool fence_closes_wall_loop(const struct WallGraph *graph, int fence_index, bool vertical) {
+    uint8_t start, end;
+    get_fence_ends(fence_index, vertical, &start, &end);
+
+    const uint8_t start_component = find_wall_component(graph, start);
+    const uint8_t centre_component = find_wall_component(graph, fence_index);
+    const uint8_t end_component = find_wall_component(graph, end);
+
+    return start_component == centre_component || centre_component == end_component ||
+           start_component == end_component;
+}
@@ -0,0 +1,82 @@
+#ifndef QUORIDOR_WALL_GRAPH_H
+#define QUORIDOR_WALL_GRAPH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+struct State;
+
+// Fences run along the lines between squares, so their ends lie on the corners of the squares.
+// Each of the 8x8 inner corners is the centre of the fences with the same index, and the corners
+// on the edge of the board are all the same vertex, the border.
+#define WALL_GRAPH_BORDER 64
+#define WALL_GRAPH_VERTEX_COUNT (WALL_GRAPH_BORDER + 1)
+
+// Number of fence placements that can be undone without rebuilding the graph, one per fence of
+// both players.
+#define WALL_GRAPH_UNDO_SIZE 20
+
+#define WALL_GRAPH_NO_LINK UINT8_MAX
+
+/**
+ * @struct WallGraph
+ * @brief The connected components of the walls on the board, the placed fences and the border.
+ *
+ * Every fence joins the three corners along it. This is the planar dual of the graph of squares:
+ * a set of fences separates squares from each other if and only if it contains a closed loop of
+ * walls. A fence that does not join two corners of the same component therefore cannot
+ * disconnect any square, and only the fences that close a loop need a path search to check that
+ * both players can still reach their goal. As the border is a single vertex, fences joining two
+ * border-touching components are caught by the same test.
+ *
+ * Components are kept as a union-find forest without path compression, so that each fence
+ * placement can be undone by unlinking the roots it linked. A copy is kept in every `State` and
+ * updated by the fence make/unmake functions.
+ */
+struct WallGraph {
+    uint8_t parent[WALL_GRAPH_VERTEX_COUNT];  // The parent of a root is the vertex itself.
+    uint8_t undo_count;
+    uint8_t undo_fences[WALL_GRAPH_UNDO_SIZE];     // Fence index, plus 64 for horizontal fences.
+    uint8_t undo_links[WALL_GRAPH_UNDO_SIZE][2];   // Roots linked by the fence, or `WALL_GRAPH_NO_LINK`.
+};
+
+/**
+ * @brief Builds the wall graph of the fences placed in a state from scratch.
+ *
+ * @param state The game state.
+ * @param graph Pointer to the graph to build.
+ */
+void build_wall_graph(const struct State *state, struct WallGraph *graph);
+
+/**
+ * @brief Adds a fence to the wall graph, remembering how to undo it.
+ *
+ * @param graph Pointer to the graph to update.
+ * @param fence_index Index of the fence on the 8x8 fence board.
+ * @param vertical True for a vertical fence, false for a horizontal one.
+ */
+void add_fence_to_wall_graph(struct WallGraph *graph, int fence_index, bool vertical);
+
+/**
+ * @brief Removes a fence from the wall graph.
+ *
+ * Fences are removed in the reverse order they were added. If the fence is not the last one
+ * that can be undone, the graph is rebuilt from the fences of `state`.
+ *
+ * @param state The game state, with the fence already removed.
+ * @param fence_index Index of the fence on the 8x8 fence board.
+ * @param vertical True for a vertical fence, false for a horizontal one.
+ */
+void remove_fence_from_wall_graph(struct State *state, int fence_index, bool vertical);
+
+/**
+ * @brief Checks if placing a fence would close a loop of walls.
+ *
+ * @param graph The wall graph.
+ * @param fence_index Index of the fence on the 8x8 fence board.
+ * @param vertical True for a vertical fence, false for a horizontal one.
+ * @return True if two corners of the fence are already connected by walls.
+ */
+bool fence_closes_wall_loop(const struct WallGraph *graph, int fence_index, bool vertical);
+
+#endif //QUORIDOR_WALL_GRAPH_H
@@ -28,16 +28,27 @@ struct State *new_state_ptr() {
         exit(1);  // malloc failed, should probably log this somehow.
     }
 
-    *state_ptr = (struct State) {
-            .vertical_fences = 0,
-            .horizontal_fences = 0,
-            .player_1_row = BOARD_SIZE - 1,
-            .player_1_col = (BOARD_SIZE - 1) / 2,
-            .player_2_row = 0,
-            .player_2_col = (BOARD_SIZE - 1) / 2,
-            .player_1_fence_count = 10,
-            .player_2_fence_count = 10,
-            .player_to_move = 1,
-    };
+    *state_ptr = new_state();
     return state_ptr;
 }
+
+struct SearchBudget *get_search_budget_ptr() {
+    struct SearchBudget *budget_ptr = malloc(sizeof(struct SearchBudget));
+
+    if (budget_ptr == NULL) {
+        exit(1);  // malloc failed, should probably log this somehow.
+    }
+
+    *budget_ptr = (struct SearchBudget) { 0 };
+    return budget_ptr;
+}
+
+struct SearchResult *get_search_result_ptr() {
+    struct SearchResult *result_ptr = malloc(sizeof(struct SearchResult));
+
+    if (result_ptr == NULL) {
+        exit(1);  // malloc failed, should probably log this somehow.
+    }
+
+    return result_ptr;
+}
@@ -3,6 +3,7 @@
 
 #include "state.h"
 #include "move.h"
+#include "search.h"
 
 // rename to alloc?
 struct State *get_state_ptr();
@@ -11,4 +12,8 @@ struct Move *get_move_ptr();
 
 struct State *new_state_ptr();
 
+struct SearchBudget *get_search_budget_ptr();
+
+struct SearchResult *get_search_result_ptr();
+
 #endif //QUORIDOR_WASMUTIL_H
@@ -0,0 +1,132 @@
+#include "zobrist.h"
+
+// Generated with splitmix64, seeded with the bytes of "Quoridor".
+const uint64_t zobrist_keys[ZOBRIST_KEY_COUNT] = {
+        0x55a5dbe46005b7dfULL, 0xc14fa0ac458b5c97ULL, 0xcdfa746fa560d75dULL,
+        0x9700e05fcdb4793fULL, 0x7d2f6f6b2fbc596dULL, 0x68305f5b0da0ad32ULL,
+        0x20b7e1de4ed5b4f7ULL, 0x0928e886f0bf1139ULL, 0x74ae4d2a69b3feefULL,
+        0xeb26e2ebdd4928fbULL, 0x1430e54729e2dcffULL, 0xcfad78457c1bf1ebULL,
+        0x1fb8f79d6ec8ce76ULL, 0x4abe939677865058ULL, 0x3b23a9dc65fa11deULL,
+        0x44c74b975b36f004ULL, 0xb17f987a4dd36da0ULL, 0x9b860ca262c1ef60ULL,
+        0x57c0f48912e295ecULL, 0xbdeaf05dca947c29ULL, 0x8ce5035d0a889daeULL,
+        0x4dce8d40270ed188ULL, 0xf321cab931173422ULL, 0x0ca9b8f7cdc34f4fULL,
+        0x10e98c49fac79a37ULL, 0x2463b83c71237917ULL, 0x3fc0011693f68c89ULL,
+        0x247a0e52ae3ab95eULL, 0x11cdafaa10dc4797ULL, 0x52bad98dde7e285fULL,
+        0xdc5d964512db1776ULL, 0xb6f872e8d3b263ccULL, 0x0a049f166f65c516ULL,
+        0xe3f6495242b04c53ULL, 0x869b4d69e93b66f7ULL, 0x4f5ff53753f568a7ULL,
+        0xd31c1d61d145ebbaULL, 0x4cbd8485f0e7fb99ULL, 0xffd20c87ad784a1aULL,
+        0xf1448a81ed49e761ULL, 0xa34092f5fbff0ad6ULL, 0xc68c95c4c71f2c07ULL,
+        0x302c578484470752ULL, 0x84e8044213230e56ULL, 0xbbfa473de2047ae5ULL,
+        0x0f65ea133541ba3cULL, 0xcdd6c572b22eb523ULL, 0xf24b23f829186f37ULL,
+        0x26d659162467c31dULL, 0x544ee9814a4b2224ULL, 0x1b263bcad7ec5e96ULL,
+        0xd44eac5a6202e739ULL, 0x4644618d278da647ULL, 0xa3c1653dacd39071ULL,
+        0xc2c0481a7bd57581ULL, 0x6e13af275b3234f8ULL, 0x5d68d60b4f7e46e0ULL,
+        0xfa096668161f03fbULL, 0xdea6d2136d3c18f8ULL, 0x47b0c86e297d06a8ULL,
+        0xece44c883f0a193dULL, 0x88aee30b72895963ULL, 0x337910543cbd40a4ULL,
+        0x105ccc59c841cccbULL, 0x65c3e17cf67204a4ULL, 0x65da546202b5b7dbULL,
+        0xd481f34fcf79bc49ULL, 0xa7c7d10b64850d75ULL, 0xb3682a5b7d06fd71ULL,
+        0x564f36ba900cf500ULL, 0xa66ccaf7d78b5c29ULL, 0x64b14d0bf9c02db5ULL,
+        0x701c0c7b6c3e7b62ULL, 0x414fba73c99ee90cULL, 0x6a2c178df859f7f9ULL,
+        0xa3f62d589c088e5aULL, 0x9de913868d518191ULL, 0xc059be93097bb6cfULL,
+        0x54530470bdb8b0b5ULL, 0x6028ae1093818b0fULL, 0x917fd0f9c7514db5ULL,
+        0x1d7923829c8f3bd7ULL, 0xb8c925b020a82301ULL, 0x6ce49aaa8c0bd29fULL,
+        0xf9a806511b3c0a6eULL, 0x99be5a11011fe3d4ULL, 0x73f61f56dcc7cd3fULL,
+        0xfb9ec8532a1fa16dULL, 0x817f70185b932014ULL, 0x4a3733b6ed5d72efULL,
+        0x61cbfa2687de9977ULL, 0xddd3de4410f75b00ULL, 0xee1748a67e9ecba1ULL,
+        0x6c40b3f0a0b9f9eaULL, 0x5b0a7fd25020b509ULL, 0x238bb2629431a2c6ULL,
+        0xc1377c234a941b1cULL, 0x99fe03baa9fc0715ULL, 0x7f9d3c089a7cadbeULL,
+        0x8d9e4d3d9768a315ULL, 0x176991f45cce7ddbULL, 0x544a2bb27b33067bULL,
+        0xd30d5074755c9719ULL, 0x18dc218c5d74ef1bULL, 0xc77ba35e5df69968ULL,
+        0xf51866293c04c40fULL, 0xf1585eab63505b7bULL, 0x7c12a3637f2d35d2ULL,
+        0x951ce5b6be94b212ULL, 0x71935ff28363bd10ULL, 0x4bc3542e21a93470ULL,
+        0xa71355929b8584d1ULL, 0x1848cbb5281a7174ULL, 0x7ca5be8baf95c48aULL,
+        0xac3d4b654d85596dULL, 0x78c6a4dd9b4b5579ULL, 0x83a40dfef4ecccaaULL,
+        0x9de8cab457f52bc6ULL, 0xc34f7e7b3ca73347ULL, 0x86d1711503b90d37ULL,
+        0x2f98e44cbed09dc7ULL, 0x8acbdf9c1f274ad7ULL, 0x8999238a10baeb0cULL,
+        0x3dcbcf3857afb478ULL, 0x951da43d8c67e1eaULL, 0xdb261a9d04933493ULL,
+        0x8cf0791579d498b7ULL, 0x733a770264df8daaULL, 0x0af2aba3e39fc12bULL,
+        0xbcf8196da557b1acULL, 0xa8f99658358b946eULL, 0xa433b5d2509d026aULL,
+        0x6a120b95f13326fcULL, 0x9b2e71e6e23b0e4cULL, 0x288742428cd4eb12ULL,
+        0x1577db56657ce700ULL, 0x09d912002e847e40ULL, 0xb5f634c9ca3cfce1ULL,
+        0x7747cf2bd6b752a7ULL, 0xc3c04d93b6d250bdULL, 0x7ec16d1b0061eb52ULL,
+        0x452c7532e6286e40ULL, 0x03a3ac7eaffc733dULL, 0xbc38a28b2a0c4a0bULL,
+        0x8bfbf0af9ec3ed95ULL, 0xdc40b97ce2513d93ULL, 0xd621c0aa2ee77fb0ULL,
+        0x4d6d9b13264498c9ULL, 0x40ae47e668828df2ULL, 0x32988fca60e37545ULL,
+        0xb89729a693d52d73ULL, 0x73d340214269e538ULL, 0x37ccbefa7f5864fbULL,
+        0x494a28b1c97121acULL, 0x0b3a766e7cd1774eULL, 0x0ce19012bfb92ffaULL,
+        0x2cc78e245906bf41ULL, 0xb1b44f92df94ebd6ULL, 0x33247f7135a8e561ULL,
+        0x04cae03ee4f5b8e0ULL, 0xe80c4d3f6696b1c3ULL, 0x37d874742b1c1919ULL,
+        0x387aad49c2edf66dULL, 0x57e2942bd54f44f5ULL, 0x9ffb8e80776b38fdULL,
+        0x53bcfea3ff8ae0f2ULL, 0xb572f5462de6febeULL, 0xf3558da79fdd5ed3ULL,
+        0x0017c2147d2b6dd4ULL, 0x790be2f2ece11e73ULL, 0x2bbfb6a53bde100fULL,
+        0x7d27abdc3b7902d3ULL, 0xf56662fbf81833abULL, 0x06f73b8fb0b721dfULL,
+        0x770d1aa98ef777ebULL, 0x40504752c266e603ULL, 0xc7c9c069a795e14fULL,
+        0xd73a7cca8931fa53ULL, 0xd7fdc763eee84ec4ULL, 0x95dada7410ebcbb5ULL,
+        0x1db4797d650ea34aULL, 0xfc397955707a2f10ULL, 0x1ef30f7f09f9eee8ULL,
+        0xe79557bc668a5991ULL, 0x9b9c264fe3757582ULL, 0xc37af00f47f8e89cULL,
+        0x4e6e8ef48dc78c24ULL, 0xc77cde744abb23dcULL, 0xe04d46746cf365bfULL,
+        0xe844daa21307825bULL, 0xfbda13e3110b8ad1ULL, 0x5d248029b855e08dULL,
+        0x493c975ec4e413a4ULL, 0x3ea46c733cb801f9ULL, 0xb6ac3f5ff6b168dfULL,
+        0xcd4e927991c85196ULL, 0xe162f6c4dd22cbadULL, 0xd0ed830dd6bb056aULL,
+        0x7ffe9b35f6f34b9aULL, 0x96277e5361330865ULL, 0x03c0ddc194456fbdULL,
+        0x4f7bedd9d668d8dfULL, 0x6d24474b43537d5aULL, 0x2c99165aa7a78d2fULL,
+        0x034f7a42f69d8ea9ULL, 0x5f11fbb54e2975bbULL, 0xb26a429b16dbfbdfULL,
+        0x53a1814adb82c3d1ULL, 0x66d3436737efe23eULL, 0x3c15397a83365b8fULL,
+        0xb2a07094ca8b6583ULL, 0x4ffd43944a851a76ULL, 0xa04222521578a0a8ULL,
+        0x314a47c15366dda0ULL, 0xa8052813ebcc7cdcULL, 0x839abce0f9818c97ULL,
+        0x695919b4a2436011ULL, 0x6c8dd3a04a273522ULL, 0xbdf16f80e94529c9ULL,
+        0xe73e06d1e303d7beULL, 0x21fef677e61d123cULL, 0xe2445e06de3f19a8ULL,
+        0x9442ae12b97398e6ULL, 0x03999e7ff6b064cfULL, 0x213a793c7d5b7277ULL,
+        0x3810a52c8b016729ULL, 0x563c777c08d8b4a7ULL, 0x987f6913e6e5af3aULL,
+        0xb43da2c4540ae79cULL, 0xb3333b313d71e938ULL, 0xf8c012bbdb561a01ULL,
+        0x583480bc881d0e30ULL, 0x8751b08259289177ULL, 0x7ba10765f506fd4fULL,
+        0x652e740684500809ULL, 0xbedfb6fcd37deea7ULL, 0x3dc2d7b891b1e923ULL,
+        0x5e312df62174f650ULL, 0x66a3a05b383248f5ULL, 0x5b4d9f10bb20a2e5ULL,
+        0xc207af5c905630bfULL, 0x5ada94807dfad0d2ULL, 0x0ba629422ab533e1ULL,
+        0xaaba3069d6eaa66fULL, 0xea66cc6751f7b765ULL, 0x52564556887c973aULL,
+        0x45dcff95acc0e8ecULL, 0xae85050f6bf98ddbULL, 0x9201c2182899624fULL,
+        0xad7fd3c2a427ea3eULL, 0x574f2e2da89ce134ULL, 0x273ac66aea98db38ULL,
+        0x7c41a01cedc46bc1ULL, 0x5a190bffb3b68b18ULL, 0x5530e821171521feULL,
+        0xaed0c3497e8f69ffULL, 0x3649d87f56621ce8ULL, 0x4401dc2090182c65ULL,
+        0x328e175ed0edc883ULL, 0x2b58840a7c02ba88ULL, 0xc1f8f6aca703fac0ULL,
+        0xab0427fc3cd76ccaULL, 0xc94481739b9e7613ULL, 0x42890aa9965385abULL,
+        0xd9ab9a725dd8b279ULL, 0xd47913a7dc85af26ULL, 0x57a1a29b1a96d042ULL,
+        0x3a5344a254dacdb9ULL, 0xa77401fcde0a0b6bULL, 0xbf0014c42ab35dc2ULL,
+        0x70f5e2c65408bf93ULL, 0x9eeab896a13ccdbfULL, 0x75dbaed0a7f5da9cULL,
+        0xda4c712a726430c9ULL, 0x1225fa9adbad9256ULL, 0x180c2d2f4fc3c658ULL,
+        0x7957f175018253e6ULL, 0x48c7c0596e08fc22ULL, 0xb8fe91ac22b1dc34ULL,
+        0xe6a4f4b418039872ULL, 0x0a0f192dd3427708ULL, 0x586ce38432ac33afULL,
+        0x956a418b7b9f5e03ULL, 0x12e699e8c9fe29b2ULL, 0xc1c81acb4af4efb4ULL,
+        0x862977eb6f3272a1ULL, 0x919cf16842370bf7ULL, 0x8ce68ac4810a0152ULL,
+        0x6ad57336e5ac3d10ULL, 0x2cdc41026ea0b869ULL, 0x12406ecbcb468db0ULL,
+        0x11e8c828761245ccULL, 0x5066c6ccabe4c07bULL, 0xc897acbf691daaf4ULL,
+        0x64ddbdf04ea25aa8ULL, 0x297df435660ac2f5ULL, 0x37e40c8d9c2f15c2ULL,
+        0x103b028d5f1ddbceULL, 0x05c0a1820a291262ULL, 0x2e577efd07089f25ULL,
+        0x5369d99c99d8f75eULL, 0x1ab9d6f43f887108ULL, 0x1e647b92c1926203ULL,
+        0x002edf6793adfb8eULL, 0xe634a3aa9962bfafULL, 0x51e85f32fdc6b999ULL,
+        0x8401a885082bfc07ULL, 0x2f9a85b8fe01090eULL, 0x2203f384000236caULL,
+        0xc789ef963f8ae7acULL, 0x80d6eb19418226fbULL, 0xe2d295fbf3078388ULL,
+        0x293af88a537cd88cULL,
+};
+
+uint64_t compute_zobrist_hash(const struct State *state) {
+    uint64_t hash = 0;
+
+    for (uint64_t fences = state->vertical_fences; fences != 0; fences &= fences - 1) {
+        hash ^= zobrist_vertical_fence_key(__builtin_ctzll(fences));
+    }
+    for (uint64_t fences = state->horizontal_fences; fences != 0; fences &= fences - 1) {
+        hash ^= zobrist_horizontal_fence_key(__builtin_ctzll(fences));
+    }
+
+    hash ^= zobrist_player_1_square_key(state->player_1_row, state->player_1_col);
+    hash ^= zobrist_player_2_square_key(state->player_2_row, state->player_2_col);
+    hash ^= zobrist_player_1_fence_count_key(state->player_1_fence_count);
+    hash ^= zobrist_player_2_fence_count_key(state->player_2_fence_count);
+
+    if (state->player_to_move == 2) {
+        hash ^= zobrist_player_2_to_move_key;
+    }
+
+    return hash;
+}
@@ -0,0 +1,45 @@
+#ifndef QUORIDOR_ZOBRIST_H
+#define QUORIDOR_ZOBRIST_H
+
+#include <stdint.h>
+#include "state.h"
+
+/**
+ * Layout of `zobrist_keys`. Each feature of a `State` that can change with a move has its own
+ * random key, and the hash of a state is the XOR of the keys of all features present in it.
+ */
+#define ZOBRIST_VERTICAL_FENCE_OFFSET       0
+#define ZOBRIST_HORIZONTAL_FENCE_OFFSET     64
+#define ZOBRIST_PLAYER_1_SQUARE_OFFSET      128
+#define ZOBRIST_PLAYER_2_SQUARE_OFFSET      (ZOBRIST_PLAYER_1_SQUARE_OFFSET + BOARD_SIZE * BOARD_SIZE)
+#define ZOBRIST_PLAYER_1_FENCE_COUNT_OFFSET (ZOBRIST_PLAYER_2_SQUARE_OFFSET + BOARD_SIZE * BOARD_SIZE)
+#define ZOBRIST_PLAYER_2_FENCE_COUNT_OFFSET (ZOBRIST_PLAYER_1_FENCE_COUNT_OFFSET + 11)
+#define ZOBRIST_PLAYER_2_TO_MOVE_OFFSET     (ZOBRIST_PLAYER_2_FENCE_COUNT_OFFSET + 11)
+#define ZOBRIST_KEY_COUNT                   (ZOBRIST_PLAYER_2_TO_MOVE_OFFSET + 1)
+
+extern const uint64_t zobrist_keys[ZOBRIST_KEY_COUNT];
+
+#define zobrist_vertical_fence_key(index)   (zobrist_keys[ZOBRIST_VERTICAL_FENCE_OFFSET + (index)])
+#define zobrist_horizontal_fence_key(index) (zobrist_keys[ZOBRIST_HORIZONTAL_FENCE_OFFSET + (index)])
+#define zobrist_player_1_square_key(row, col) \
+    (zobrist_keys[ZOBRIST_PLAYER_1_SQUARE_OFFSET + (row) * BOARD_SIZE + (col)])
+#define zobrist_player_2_square_key(row, col) \
+    (zobrist_keys[ZOBRIST_PLAYER_2_SQUARE_OFFSET + (row) * BOARD_SIZE + (col)])
+#define zobrist_player_square_key(player, row, col) \
+    (zobrist_keys[ZOBRIST_PLAYER_1_SQUARE_OFFSET + ((player) - 1) * BOARD_SIZE * BOARD_SIZE + (row) * BOARD_SIZE + (col)])
+#define zobrist_player_1_fence_count_key(count) (zobrist_keys[ZOBRIST_PLAYER_1_FENCE_COUNT_OFFSET + (count)])
+#define zobrist_player_2_fence_count_key(count) (zobrist_keys[ZOBRIST_PLAYER_2_FENCE_COUNT_OFFSET + (count)])
+#define zobrist_player_2_to_move_key        (zobrist_keys[ZOBRIST_PLAYER_2_TO_MOVE_OFFSET])
+
+/**
+ * @brief Computes the Zobrist hash of a state from scratch.
+ *
+ * During play the hash is kept up to date incrementally by the make/unmake functions in `state.c`,
+ * this is only needed when a state has been built without them.
+ *
+ * @param state The game state.
+ * @return The 64 bit Zobrist hash of the state.
+ */
+uint64_t compute_zobrist_hash(const struct State *state);
+
+#endif //QUORIDOR_ZOBRIST_H
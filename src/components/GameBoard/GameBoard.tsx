@@ -1,4 +1,4 @@
-import React, {useEffect, useState} from "react";
+import React, {useEffect, useRef, useState} from "react";
 import {Move, moveToString, MoveType} from "../../logic/Move.ts";
 import Player from "../../logic/Player.ts";
 import {isFencePresent, State} from "../../logic/State.ts";
@@ -41,7 +41,7 @@ interface BoardGameProps {
 }
 
 const GameBoard: React.FC<BoardGameProps> = ({ player1, player2 }) => {
-    const [gameState, setGameState] = useState<State>(WasmUtils.newState());
+    const [gameState, setGameState] = useState<State>(() => WasmUtils.newGame());
     const [moveList, setMoveList] = useState<Array<Move>>([]);
     const [moveIndex, setMoveIndex] = useState<number>(-1);
     const [player1State, setPlayer1State] = useState<Player>(player1 ?? { type: "Human", difficulty: 3 });
@@ -50,47 +50,78 @@ const GameBoard: React.FC<BoardGameProps> = ({ player1, player2 }) => {
     const [winningPlayer, setWinningPlayer] = useState<number | undefined>(undefined);
     const [aiIsThinking, setAiIsThinking] = useState<boolean>(false);
 
+    // One worker per AI player, kept for the whole game so that its engine keeps what it learnt from
+    // one move to the next and ponders on the opponent's time.
+    const aiWorkers = useRef<Map<number, Promise<Worker>>>(new Map());
+
+    function getAiWorker(playerNumber: number): Promise<Worker> {
+        let worker = aiWorkers.current.get(playerNumber);
+        if (worker === undefined) {
+            worker = new Promise<Worker>(resolve => {
+                const newWorker = new Worker(new URL("../../workers/AiWorker.ts", import.meta.url), { type: "module" });
+                newWorker.onmessage = (event: MessageEvent<any>) => {
+                    if (event.data.type === "ready") {
+                        resolve(newWorker);
+                    }
+                };
+            });
+            aiWorkers.current.set(playerNumber, worker);
+        }
+        return worker;
+    }
+
+    function terminateAiWorkers() {
+        aiWorkers.current.forEach(worker => worker.then(w => w.terminate()));
+        aiWorkers.current.clear();
+    }
+
+    // A search cut off by the cleanup is started again if the board is mounted again.
+    useEffect(() => () => {
+        terminateAiWorkers();
+        setAiIsThinking(false);
+    }, []);
+
     // Win check and AI Move
     useEffect(() => {
         if (gameOver) {
             return;
         }
 
-        if (WasmUtils.winCheck(gameState)) {
+        const winner = WasmUtils.getWinner();
+        if (winner !== 0) {
             setGameOver(true);
-            setWinningPlayer(gameState.playerToMove === 1 ? 2 : 1);
+            setWinningPlayer(winner);
             return;
         }
 
         const currentPlayer = gameState.playerToMove === 1 ? player1State : player2State;
 
         if (currentPlayer.type === "AI" && !aiIsThinking && moveIndex === moveList.length - 1) {
-            const worker = new Worker(new URL("../../workers/AiWorker.ts", import.meta.url), { type: "module" });
             setAiIsThinking(true);
 
-            worker.postMessage({
-                gameState: gameState,
-                difficulty: currentPlayer.difficulty!,
-            });
+            getAiWorker(gameState.playerToMove).then(worker => {
+                worker.onmessage = (event: MessageEvent<any>) => {
+                    if (event.data.type === "result") {
+                        const move: Move = event.data.move;
+                        const newMoveList = [...moveList, move];
 
-            worker.onmessage = (event: MessageEvent<any>) => {
-                if (event.data.type === "ready") {
-                    worker.postMessage({
-                        type: "calculate",
-                        gameState: gameState,
-                        difficulty: currentPlayer.difficulty!,
-                    });
-                } else if (event.data.type === "result") {
-                    const move: Move = event.data.move;
-                    const newMoveList = [...moveList, move];
-
-                    setGameState(WasmUtils.makeMove(gameState, move));
-                    setMoveList(newMoveList);
-                    setMoveIndex(moveIndex + 1);
-                    setAiIsThinking(false);
-                    worker.terminate();
-                }
-            };
+                        // The session is moved back to the searched state in case the history was browsed meanwhile.
+                        WasmUtils.goToMove(moveIndex + 1);
+                        setGameState(WasmUtils.makeMove(move));
+                        setMoveList(newMoveList);
+                        setMoveIndex(moveIndex + 1);
+                        setAiIsThinking(false);
+                    }
+                };
+
+                // The worker goes on pondering after its result, until this next request.
+                worker.postMessage({
+                    type: "calculate",
+                    gameState: gameState,
+                    difficulty: currentPlayer.difficulty!,
+                    engine: currentPlayer.engine,
+                });
+            });
         }
     }, [gameState, aiIsThinking, gameOver, moveList, player1State, player2State, moveIndex]);
 
@@ -105,24 +136,15 @@ const GameBoard: React.FC<BoardGameProps> = ({ player1, player2 }) => {
             }
             newMoveList = [...newMoveList, move];
 
-            setGameState(WasmUtils.makeMove(gameState, move));
+            setGameState(WasmUtils.makeMove(move));
             setMoveList(newMoveList);
             setMoveIndex(moveIndex + 1);
         }
     }
 
     function goToMove(targetIndex: number) {
-        let newGameState = gameState;
-        if (targetIndex > moveIndex) {
-            for (let i = moveIndex + 1; i <= targetIndex; i++) {
-                newGameState = WasmUtils.makeMove(newGameState, moveList[i]);
-            }
-        } else {
-            for (let i = moveIndex; i > targetIndex; i--) {
-                newGameState = WasmUtils.unMakeMove(newGameState, moveList[i]);
-            }
-        }
-        setGameState(newGameState);
+        // `targetIndex` indexes the move list, while the session counts the moves made.
+        setGameState(WasmUtils.goToMove(targetIndex + 1));
         setMoveIndex(targetIndex);
     }
 
@@ -143,7 +165,8 @@ const GameBoard: React.FC<BoardGameProps> = ({ player1, player2 }) => {
     }
 
     function newGame(newPlayer1: Player, newPlayer2: Player) {
-        setGameState(WasmUtils.newState());
+        terminateAiWorkers();
+        setGameState(WasmUtils.newGame());
         setMoveList([]);
         setMoveIndex(-1);
         setPlayer1State(newPlayer1);
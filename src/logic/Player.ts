@@ -1,4 +1,5 @@
 export default interface Player {
     type: "Human" | "AI";
     difficulty: number | null;
+    engine?: "PVS" | "MCTS";  // PVS if not set.
 }
@@ -6,80 +6,335 @@ import {State} from "./State";
 
 const module = await createModule();
 
+// Must match search.h.
+const MAX_SEARCH_DEPTH = 64;
+const SEARCH_DEPTH_STATS_SIZE = 80;
+const MOVE_SIZE = 16;
+
+// Must match move.h and move_generation.h.
+const ENCODED_PAWN_MOVE_OFFSET = 1;
+const ENCODED_VERTICAL_FENCE_OFFSET = 16;
+const ENCODED_HORIZONTAL_FENCE_OFFSET = 80;
+const MAX_MOVE_COUNT = 12 + 2 * 8 * 8;
+
+export interface SearchDepthStats {
+    nodes: number;
+    betaCutoffs: number;
+    firstMoveBetaCutoffs: number;
+    reSearches: number;
+    legalityChecks: number;
+    transpositionHits: number;
+    transpositionCutoffs: number;
+    aspirationFailHighs: number;
+    aspirationFailLows: number;
+    timeMs: number;
+}
+
+export interface SearchStats {
+    depths: SearchDepthStats[];
+    total: SearchDepthStats;
+    stackHighWater: number;  // Bytes of stack used below the root of the search.
+}
+
+export interface PonderStats {
+    ponders: number;
+    hits: number;          // Searches that continued a ponder search.
+    misses: number;        // Searches started afresh, the opponent played another move.
+    nodes: number;
+    timeMs: number;
+    lastHitDepth: number;  // Depth the ponder search had completed at the last hit.
+}
+
 export default abstract class WasmUtils {
 
-    public static newState(): State {
-        const statePtr = module._new_state_ptr();
-        const state = this.readWasmState(statePtr);
-        module._free(statePtr);
-        return state;
+    // The game played on the board, see `struct GameSession`. Created on first use, so that
+    // workers that only search do not allocate one.
+    private static sessionPtr: number = 0;
+
+    // Buffer that `generate_all_legal_moves` writes to, allocated on first use.
+    private static legalMovesPtr: number = 0;
+
+    // The engine that `getAiMovePondered` searches with, see `struct SearchEngine`. Created on first
+    // use and kept for the lifetime of the module, so an AI worker is kept for a single game.
+    private static enginePtr: number = 0;
+
+    private static getEngine(): number {
+        if (this.enginePtr === 0) {
+            this.enginePtr = module._new_search_engine();
+        }
+        return this.enginePtr;
     }
 
-    public static makeMove(state: State, move: Move): State {
+    private static getSession(): number {
+        if (this.sessionPtr === 0) {
+            this.sessionPtr = module._new_game_session();
+        }
+        return this.sessionPtr;
+    }
+
+    /**
+     * Starts a new game in the session and returns its first state.
+     */
+    public static newGame(): State {
+        module._reset_game_session(this.getSession());
+        return this.readSessionState();
+    }
+
+    /**
+     * Makes a move in the session, replacing any moves after the current one, and returns the new state.
+     */
+    public static makeMove(move: Move): State {
+        if (!module._game_session_make_move(this.getSession(), this.encodeMove(move))) {
+            console.error(`Illegal move: ${JSON.stringify(move)}.`);
+        }
+        return this.readSessionState();
+    }
+
+    /**
+     * Moves the session to the state after the first `moveCount` moves of its history and returns it.
+     */
+    public static goToMove(moveCount: number): State {
+        if (!module._game_session_go_to_move(this.getSession(), moveCount)) {
+            console.error(`Move index out of range: ${moveCount}.`);
+        }
+        return this.readSessionState();
+    }
+
+    /**
+     * Returns the player who has won in the current state of the session, or 0 if the game is not over.
+     */
+    public static getWinner(): number {
+        return module.HEAPU8[module._get_game_session_view(this.getSession()) + 23];
+    }
+
+    public static getAiMove(state: State, depth: number): Move {
         const statePtr = this.stateToWasm(state);
-        const movePtr = this.moveToWasm(move);
+        const movePtr = module._get_move_ptr();
+        module._get_best_move_iterative_deepening(movePtr, statePtr, depth);
 
-        module._make_move(statePtr, movePtr);
-        state = this.readWasmState(statePtr);
+        const move: Move = this.readWasmMove(movePtr, state);
 
         module._free(statePtr);
         module._free(movePtr);
 
-        return state;
+        return move;
     }
 
-    public static unMakeMove(state: State, move: Move): State {
+    /**
+     * Searches up to `maxDepth`, but returns the best move found so far once `timeLimitMs` has passed.
+     */
+    public static getAiMoveTimed(state: State, maxDepth: number, timeLimitMs: number): Move {
         const statePtr = this.stateToWasm(state);
-        const movePtr = this.moveToWasm(move);
+        const budgetPtr = module._get_search_budget_ptr();
+        const resultPtr = module._get_search_result_ptr();
 
-        module._unmake_move(statePtr, movePtr);
-        state = this.readWasmState(statePtr);
+        // struct SearchBudget { int max_depth; uint32_t time_limit_ms; uint64_t node_limit; }
+        module.HEAP32[budgetPtr >> 2] = maxDepth;
+        module.HEAPU32[(budgetPtr + 4) >> 2] = timeLimitMs;
+
+        module._get_best_move_timed(resultPtr, statePtr, budgetPtr);
+
+        // The best move is the first field of struct SearchResult.
+        const move: Move = this.readWasmMove(resultPtr, state);
 
         module._free(statePtr);
-        module._free(movePtr);
+        module._free(budgetPtr);
+        module._free(resultPtr);
 
-        return state;
+        return move;
     }
 
-    public static getAiMove(state: State, depth: number): Move {
+    /**
+     * Searches like `getAiMoveTimed` with the module's engine, which keeps what it learnt from one
+     * move to the next. Continues the ponder search if it searched `state`, then starts pondering on
+     * the opponent's expected reply. The ponder search only runs in calls to `ponder`, as the WASM
+     * build is single threaded.
+     */
+    public static getAiMovePondered(state: State, maxDepth: number, timeLimitMs: number): Move {
         const statePtr = this.stateToWasm(state);
-        const movePtr = module._get_move_ptr();
-        module._get_best_move_iterative_deepening(movePtr, statePtr, depth);
+        const budgetPtr = module._get_search_budget_ptr();
+        const resultPtr = module._get_search_result_ptr();
 
-        const move: Move = this.readWasmMove(movePtr, state);
+        // struct SearchBudget { int max_depth; uint32_t time_limit_ms; uint64_t node_limit; }
+        module.HEAP32[budgetPtr >> 2] = maxDepth;
+        module.HEAPU32[(budgetPtr + 4) >> 2] = timeLimitMs;
+
+        module._get_best_move_pondered(resultPtr, this.getEngine(), statePtr, budgetPtr);
+
+        // struct SearchResult starts with the best move, followed by the opponent's expected reply.
+        const move: Move = this.readWasmMove(resultPtr, state);
+        module._start_pondering(this.getEngine(), statePtr, resultPtr, resultPtr + MOVE_SIZE);
 
         module._free(statePtr);
-        module._free(movePtr);
+        module._free(budgetPtr);
+        module._free(resultPtr);
 
         return move;
     }
 
-    public static winCheck(state: State): boolean {
+    /**
+     * Runs the ponder search for `timeLimitMs`, returns false once there is nothing left to ponder.
+     */
+    public static ponder(timeLimitMs: number): boolean {
+        return module._ponder(this.getEngine(), timeLimitMs) !== 0;
+    }
+
+    /**
+     * Stops pondering, keeping the ponder search for the next `getAiMovePondered`.
+     */
+    public static stopPondering(): void {
+        module._stop_pondering(this.getEngine());
+    }
+
+    /**
+     * Reads the ponder counters, see `struct PonderStats`.
+     */
+    public static getPonderStats(): PonderStats {
+        const ptr: number = module._get_ponder_stats(this.getEngine());
+        const readUint64 = (offset: number): number =>
+            module.HEAPU32[(ptr + offset + 4) >> 2] * 2 ** 32 + module.HEAPU32[(ptr + offset) >> 2];
+
+        return {
+            ponders: readUint64(0),
+            hits: readUint64(8),
+            misses: readUint64(16),
+            nodes: readUint64(24),
+            timeMs: module.HEAPF64[(ptr + 32) >> 3],
+            lastHitDepth: module.HEAP32[(ptr + 40) >> 2],
+        };
+    }
+
+    /**
+     * Chooses a move with Monte Carlo tree search, running `playouts` playouts unless `timeLimitMs`
+     * passes first.
+     */
+    public static getAiMoveMcts(state: State, playouts: number, timeLimitMs: number): Move {
         const statePtr = this.stateToWasm(state);
-        const gameIsOver = module._win_check(statePtr);
+        const budgetPtr = module._get_search_budget_ptr();
+        const resultPtr = module._get_search_result_ptr();
+
+        // struct SearchBudget { int max_depth; uint32_t time_limit_ms; uint64_t node_limit; }
+        module.HEAPU32[(budgetPtr + 4) >> 2] = timeLimitMs;
+        module.HEAPU32[(budgetPtr + 8) >> 2] = playouts;
+
+        // The WASM build is single threaded.
+        module._get_best_move_mcts(resultPtr, statePtr, budgetPtr, 1);
+
+        const move: Move = this.readWasmMove(resultPtr, state);
+
         module._free(statePtr);
-        return gameIsOver;
+        module._free(budgetPtr);
+        module._free(resultPtr);
+
+        return move;
     }
 
-    private static getLegalMoves(state: State, statePtr: number): MoveSet {
-        const pawnMask: number = module._generate_legal_pawn_moves(statePtr);
-        const verticalFenceMask: bigint = module._generate_fully_legal_vertical_fence_moves(statePtr);
-        const horizontalFenceMask: bigint = module._generate_fully_legal_horizontal_fence_moves(statePtr);
+    /**
+     * Reads the statistics of the last search, see `struct SearchStats`. Counters other than nodes
+     * and time are only collected in debug builds of the engine.
+     */
+    public static getLastSearchStats(): SearchStats {
+        const statsPtr: number = module._get_last_search_stats();
+        const depthCount: number = module.HEAP32[statsPtr >> 2];
+
+        const depths = new Array<SearchDepthStats>();
+        for (let depth = 1; depth <= depthCount; depth++) {
+            depths.push(this.readSearchDepthStats(statsPtr + 8 + depth * SEARCH_DEPTH_STATS_SIZE));
+        }
 
-        const pawnRow: number = state.playerToMove == 1 ? state.playerOneRow : state.playerTwoRow;
-        const pawnCol: number = state.playerToMove == 1 ? state.playerOneCol : state.playerTwoCol;
+        const totalPtr = statsPtr + 8 + (MAX_SEARCH_DEPTH + 1) * SEARCH_DEPTH_STATS_SIZE;
+        const stackHighWaterPtr = totalPtr + SEARCH_DEPTH_STATS_SIZE;
 
-        const pawnMoves = this.pawnMovesFromWasm(pawnMask, pawnRow, pawnCol);
-        const fenceMoves = this.fenceMovesFromWasm(verticalFenceMask, horizontalFenceMask);
+        return {
+            depths,
+            total: this.readSearchDepthStats(totalPtr),
+            stackHighWater: module.HEAPU32[(stackHighWaterPtr + 4) >> 2] * 2 ** 32 +
+                module.HEAPU32[stackHighWaterPtr >> 2],
+        };
+    }
 
-        const moveSet = new MoveSet();
+    private static readSearchDepthStats(ptr: number): SearchDepthStats {
+        const readUint64 = (offset: number): number =>
+            module.HEAPU32[(ptr + offset + 4) >> 2] * 2 ** 32 + module.HEAPU32[(ptr + offset) >> 2];
+
+        return {
+            nodes: readUint64(0),
+            betaCutoffs: readUint64(8),
+            firstMoveBetaCutoffs: readUint64(16),
+            reSearches: readUint64(24),
+            legalityChecks: readUint64(32),
+            transpositionHits: readUint64(40),
+            transpositionCutoffs: readUint64(48),
+            aspirationFailHighs: readUint64(56),
+            aspirationFailLows: readUint64(64),
+            timeMs: module.HEAPF64[(ptr + 72) >> 3],
+        };
+    }
+
+    /**
+     * Reads the current state of the session from the session view, see `struct GameSessionView`.
+     *
+     * The legal moves are only generated when `legalMoves` is first read, from the session's state
+     * at that time. They must therefore be read before the session changes, as the board does by
+     * replacing its state on every change. The property is not enumerable, so states posted to the
+     * AI worker do not generate them.
+     */
+    private static readSessionState(): State {
+        const ptr: number = module._get_game_session_view(this.getSession());
+        const readUint64 = (offset: number): bigint =>
+            (BigInt(module.HEAPU32[(ptr + offset + 4) >> 2]) << 32n) | BigInt(module.HEAPU32[(ptr + offset) >> 2]);
+
+        const state = {
+            verticalFences: readUint64(0),
+            horizontalFences: readUint64(8),
+            playerOneRow: module.HEAPU8[ptr + 16],
+            playerOneCol: module.HEAPU8[ptr + 17],
+            playerTwoRow: module.HEAPU8[ptr + 18],
+            playerTwoCol: module.HEAPU8[ptr + 19],
+            playerOneFenceCount: module.HEAPU8[ptr + 20],
+            playerTwoFenceCount: module.HEAPU8[ptr + 21],
+            playerToMove: module.HEAPU8[ptr + 22],
+        } as State;
+
+        let legalMoves: MoveSet | undefined;
+        Object.defineProperty(state, "legalMoves", {
+            get: (): MoveSet => {
+                legalMoves ??= this.generateLegalMoves(state);
+                return legalMoves;
+            },
+            enumerable: false,
+        });
 
-        for (const move of pawnMoves) {
-            moveSet.add(move);
+        return state;
+    }
+
+    /**
+     * Generates the legal moves of the session's current state, which must be `state`.
+     */
+    private static generateLegalMoves(state: State): MoveSet {
+        if (this.legalMovesPtr === 0) {
+            this.legalMovesPtr = module._malloc(MAX_MOVE_COUNT);
         }
 
-        for (const move of fenceMoves) {
-            moveSet.add(move);
+        const statePtr: number = module._get_game_session_state(this.getSession());
+        const count: number = module._generate_all_legal_moves(statePtr, this.legalMovesPtr);
+        const pawnRow: number = state.playerToMove == 1 ? state.playerOneRow : state.playerTwoRow;
+        const pawnCol: number = state.playerToMove == 1 ? state.playerOneCol : state.playerTwoCol;
+        const moveSet = new MoveSet();
+
+        for (let i = 0; i < count; i++) {
+            const encodedMove: number = module.HEAPU8[this.legalMovesPtr + i];
+
+            if (encodedMove >= ENCODED_HORIZONTAL_FENCE_OFFSET) {
+                const index = encodedMove - ENCODED_HORIZONTAL_FENCE_OFFSET;
+                moveSet.add({ moveType: MoveType.HorizontalFence, row: Math.floor(index / 8), col: index % 8 });
+            } else if (encodedMove >= ENCODED_VERTICAL_FENCE_OFFSET) {
+                const index = encodedMove - ENCODED_VERTICAL_FENCE_OFFSET;
+                moveSet.add({ moveType: MoveType.VerticalFence, row: Math.floor(index / 8), col: index % 8 });
+            } else {
+                const [rowDif, colDif] = PawnMoveBiMap.getDif(1 << (encodedMove - ENCODED_PAWN_MOVE_OFFSET))!;
+                moveSet.add({ moveType: MoveType.Pawn, row: pawnRow + rowDif, col: pawnCol + colDif });
+            }
         }
 
         return moveSet;
@@ -105,87 +360,35 @@ export default abstract class WasmUtils {
         module.HEAPU8[statePtr + offset++] = state.playerTwoFenceCount;
         module.HEAPU8[statePtr + offset++] = state.playerToMove;
 
-        return statePtr;
-    }
-
-    private static readWasmState(ptr: number): State {
-
-        let offset = 0;
+        // The Zobrist hash is not mirrored on the JS side, rebuild it from the fields written above.
+        module._recompute_derived_state(statePtr);
 
-        let lo = module.HEAPU32[(ptr + offset) >> 2];
-        let hi = module.HEAPU32[(ptr + offset + 4) >> 2];
-        const verticalFences = (BigInt(hi) << 32n) | BigInt(lo);
-        offset += 8;
-
-        lo = module.HEAPU32[(ptr + offset) >> 2];
-        hi = module.HEAPU32[(ptr + offset + 4) >> 2];
-        const horizontalFences = (BigInt(hi) << 32n) | BigInt(lo);
-        offset += 8;
-
-        const playerOneRow = module.HEAPU8[ptr + offset++];
-        const playerOneCol = module.HEAPU8[ptr + offset++];
-        const playerTwoRow = module.HEAPU8[ptr + offset++];
-        const playerTwoCol = module.HEAPU8[ptr + offset++];
-        const playerOneFenceCount = module.HEAPU8[ptr + offset++];
-        const playerTwoFenceCount = module.HEAPU8[ptr + offset++];
-        const playerToMove = module.HEAPU8[ptr + offset++];
-        const legalMoves = new MoveSet();
-
-        const state: State = {
-            verticalFences,
-            horizontalFences,
-            playerOneRow,
-            playerOneCol,
-            playerTwoRow,
-            playerTwoCol,
-            playerOneFenceCount,
-            playerTwoFenceCount,
-            playerToMove,
-            legalMoves: legalMoves
-        };
-
-        state.legalMoves = this.getLegalMoves(state, ptr);
-
-        return state;
+        return statePtr;
     }
 
-    private static moveToWasm(move: Move): number {
-        const ptr = module._get_move_ptr();
-        let offset = 0;
-
-        if (move.moveType === MoveType.Pawn) {
-            const rowDif = move.row - move.fromRow!;
-            const colDif = move.col - move.fromCol!;
+    /**
+     * Encodes a move as the engine does in `encode_move`.
+     */
+    private static encodeMove(move: Move): number {
+        switch (move.moveType) {
+            case MoveType.Pawn: {
+                const pawnMove: PawnMoveTypes | undefined =
+                    PawnMoveBiMap.getMove(move.row - move.fromRow!, move.col - move.fromCol!);
 
-            const pawnMove: PawnMoveTypes | undefined = PawnMoveBiMap.getMove(rowDif, colDif);
+                if (pawnMove === undefined) {
+                    console.error(`Invalid pawn move: (${move.row - move.fromRow!}, ${move.col - move.fromCol!}).`);
+                    return 0;
+                }
 
-            if (pawnMove === undefined) {
-                console.error(`Invalid pawn move: (${rowDif}, ${colDif}).`);
+                return ENCODED_PAWN_MOVE_OFFSET + 31 - Math.clz32(pawnMove);
             }
-
-            module.HEAPU32[((ptr + offset) >> 2)] = pawnMove;
-
-
-        } else if (move.moveType === MoveType.VerticalFence || move.moveType === MoveType.HorizontalFence) {
-            const fenceMove: bigint = 1n << BigInt(move.row * 8 + move.col);
-
-            module.HEAPU32[(ptr + offset) >> 2] = Number(fenceMove & 0xffffffffn);
-            module.HEAPU32[((ptr + offset) >> 2) + 1] = Number(fenceMove >> 32n);
-        } else if (move.moveType === MoveType.None) {
-            module.HEAPU32[(ptr + offset) >> 2] = 0;
-            module.HEAPU32[((ptr + offset) >> 2) + 1] = 0;
-        } else {
-            console.error(`Invalid move type: ${move.moveType}.`);
+            case MoveType.VerticalFence:
+                return ENCODED_VERTICAL_FENCE_OFFSET + move.row * 8 + move.col;
+            case MoveType.HorizontalFence:
+                return ENCODED_HORIZONTAL_FENCE_OFFSET + move.row * 8 + move.col;
+            default:
+                return 0;
         }
-        offset += 8;
-
-        module.HEAPU32[(ptr + offset) >> 2] = move.moveType;
-        offset += 4;
-
-        // Score
-        module.HEAP32[(ptr + offset) >> 2] = 0;
-
-        return ptr;
     }
 
     private static readWasmMove(ptr: number, state: State): Move {
@@ -236,135 +439,6 @@ export default abstract class WasmUtils {
             }
         }
     }
-
-    private static pawnMovesFromWasm(pawnMask: number, row: number, col: number): Move[] {
-
-        const moves = new Array<Move>();
-
-        if (PawnMoveTypes.North & pawnMask) {
-            moves.push({
-                moveType: MoveType.Pawn,
-                row: row - 1,
-                col: col,
-            });
-        }
-
-        if (PawnMoveTypes.East & pawnMask) {
-            moves.push({
-                moveType: MoveType.Pawn,
-                row: row,
-                col: col + 1,
-            });
-        }
-
-        if (PawnMoveTypes.South & pawnMask) {
-            moves.push({
-                moveType: MoveType.Pawn,
-                row: row + 1,
-                col: col,
-            });
-        }
-
-        if (PawnMoveTypes.West & pawnMask) {
-            moves.push({
-                moveType: MoveType.Pawn,
-                row: row,
-                col: col - 1,
-            });
-        }
-
-        if (PawnMoveTypes.NorthNorth & pawnMask) {
-            moves.push({
-                moveType: MoveType.Pawn,
-                row: row - 2,
-                col: col,
-            });
-        }
-
-        if (PawnMoveTypes.EastEast & pawnMask) {
-            moves.push({
-                moveType: MoveType.Pawn,
-                row: row,
-                col: col + 2,
-            });
-        }
-
-        if (PawnMoveTypes.SouthSouth & pawnMask) {
-            moves.push({
-                moveType: MoveType.Pawn,
-                row: row + 2,
-                col: col,
-            });
-        }
-
-        if (PawnMoveTypes.WestWest & pawnMask) {
-            moves.push({
-                moveType: MoveType.Pawn,
-                row: row,
-                col: col - 2,
-            });
-        }
-
-        if (PawnMoveTypes.NorthEast & pawnMask) {
-            moves.push({
-                moveType: MoveType.Pawn,
-                row: row - 1,
-                col: col + 1,
-            });
-        }
-
-        if (PawnMoveTypes.NorthWest & pawnMask) {
-            moves.push({
-                moveType: MoveType.Pawn,
-                row: row - 1,
-                col: col - 1,
-            });
-        }
-
-        if (PawnMoveTypes.SouthEast & pawnMask) {
-            moves.push({
-                moveType: MoveType.Pawn,
-                row: row + 1,
-                col: col + 1,
-            });
-        }
-
-        if (PawnMoveTypes.SouthWest & pawnMask) {
-            moves.push({
-                moveType: MoveType.Pawn,
-                row: row + 1,
-                col: col - 1,
-            });
-        }
-
-        return moves;
-    }
-
-    private static fenceMovesFromWasm(verticalFenceMask: bigint, horizontalFenceMask: bigint): Move[] {
-        const moves = new Array<Move>();
-
-        for (let index: bigint = 0n; index < 64n; index++) {
-            const mask: bigint = 1n << index;
-
-            if ((mask & verticalFenceMask) != 0n) {
-                moves.push({
-                    moveType: MoveType.VerticalFence,
-                    row: Math.floor(Number(index / 8n)),
-                    col: Number(index % 8n),
-                });
-            }
-
-            if ((mask & horizontalFenceMask) != 0n) {
-                moves.push({
-                    moveType: MoveType.HorizontalFence,
-                    row: Math.floor(Number(index / 8n)),
-                    col: Number(index % 8n),
-                });
-            }
-        }
-
-        return moves;
-    }
 }
 
 enum PawnMoveTypes {
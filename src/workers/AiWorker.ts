@@ -4,15 +4,57 @@ import {Move} from "../logic/Move";
 import {State} from "../logic/State";
 import WasmUtils from "../logic/WasmUtils.ts";
 
+// The AI stops deepening its search after this long, whatever its difficulty.
+const AI_TIME_LIMIT_MS = 5000;
+
+// Playouts of the MCTS engine per difficulty level.
+const MCTS_PLAYOUTS_PER_DIFFICULTY = 10000;
+
+// The PVS engine ponders in slices of this length, handling messages in between.
+const PONDER_SLICE_MS = 50;
+
 interface AiWorkerData {
+    type?: "calculate";
     gameState: State;
     difficulty: number;
+    engine?: "PVS" | "MCTS";
+    timeLimitMs?: number;
+}
+
+// Set while the worker ponders on the opponent's time, which lasts until the next message.
+let pondering = false;
+
+function ponderSlice() {
+    if (pondering) {
+        pondering = WasmUtils.ponder(PONDER_SLICE_MS);
+        if (pondering) {
+            setTimeout(ponderSlice, 0);
+        }
+    }
 }
 
 addEventListener("message", (event: MessageEvent<AiWorkerData>) => {
-    const { gameState, difficulty } = event.data;
-    const move: Move = WasmUtils.getAiMove(gameState, difficulty);
-    postMessage({ type: "result", move });
+    pondering = false;
+
+    const { gameState, difficulty, engine, timeLimitMs } = event.data;
+
+    if (engine === "MCTS") {
+        const move: Move = WasmUtils.getAiMoveMcts(gameState, difficulty * MCTS_PLAYOUTS_PER_DIFFICULTY,
+            timeLimitMs ?? AI_TIME_LIMIT_MS);
+        postMessage({ type: "result", move });
+        return;
+    }
+
+    const move: Move = WasmUtils.getAiMovePondered(gameState, difficulty, timeLimitMs ?? AI_TIME_LIMIT_MS);
+    postMessage({
+        type: "result",
+        move,
+        stats: WasmUtils.getLastSearchStats(),
+        ponderStats: WasmUtils.getPonderStats(),
+    });
+
+    pondering = true;
+    setTimeout(ponderSlice, 0);
 });
 
 postMessage({ type: "ready" });